@@ -44,6 +44,10 @@ namespace Swift {
                 return NO_RESULT;
             }
 
+            virtual boost::optional<std::string> getType() const override {
+                return type;
+            }
+
         protected:
             virtual std::shared_ptr<T> doConvertFromLua(lua_State*) = 0;
             virtual void doConvertToLua(lua_State*, std::shared_ptr<T>) = 0;
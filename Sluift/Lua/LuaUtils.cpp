@@ -24,6 +24,20 @@ static const std::string INDENT = "  ";
 
 void Swift::Lua::registerTableToString(lua_State* L, int index) {
     index = Lua::absoluteOffset(L, index);
+
+    // Most tables come from the element convertors and don't have a
+    // metatable yet. Set it up directly, instead of calling into core.lua.
+    if (Sluift::globals.tableToStringIndex != -1 && lua_istable(L, index)) {
+        if (!lua_getmetatable(L, index)) {
+            lua_createtable(L, 0, 1);
+            lua_rawgeti(L, LUA_REGISTRYINDEX, Sluift::globals.tableToStringIndex);
+            lua_setfield(L, -2, "__tostring");
+            lua_setmetatable(L, index);
+            return;
+        }
+        lua_pop(L, 1);
+    }
+
     lua_rawgeti(L, LUA_REGISTRYINDEX, Sluift::globals.coreLibIndex);
     lua_getfield(L, -1, "register_table_tostring");
     lua_pushvalue(L, index);
@@ -35,5 +35,15 @@ namespace Swift {
             virtual boost::optional<Documentation> getDocumentation() const {
                 return boost::optional<Documentation>();
             }
+
+            /**
+             * Returns the type name of the elements this convertor handles,
+             * if convertFromLua() only accepts this type name, and whether
+             * convertToLua() succeeds only depends on the dynamic type of
+             * the element.
+             */
+            virtual boost::optional<std::string> getType() const {
+                return boost::optional<std::string>();
+            }
     };
 }
@@ -6,7 +6,9 @@
 
 #include <Sluift/LuaElementConvertors.h>
 
+#include <algorithm>
 #include <memory>
+#include <typeinfo>
 
 #include <Sluift/ElementConvertors/BodyConvertor.h>
 #include <Sluift/ElementConvertors/CarbonsReceivedConvertor.h>
@@ -68,6 +70,7 @@ LuaElementConvertors::LuaElementConvertors() {
     convertors.push_back(std::make_shared<DOMElementConvertor>());
     convertors.push_back(std::make_shared<RawXMLElementConvertor>());
     convertors.push_back(std::make_shared<DefaultElementConvertor>());
+    indexConvertors();
 }
 
 LuaElementConvertors::~LuaElementConvertors() {
@@ -75,6 +78,23 @@ LuaElementConvertors::~LuaElementConvertors() {
 
 #include <Sluift/ElementConvertors/ElementConvertors.ipp>
 
+void LuaElementConvertors::indexConvertors() {
+    convertorTypes.clear();
+    convertorIndexByType.clear();
+    toLuaConvertorIndexByElementType.clear();
+    firstUntypedConvertorIndex = convertors.size();
+    for (size_t i = 0; i < convertors.size(); ++i) {
+        boost::optional<std::string> type = convertors[i]->getType();
+        convertorTypes.push_back(type);
+        if (type) {
+            convertorIndexByType.insert(std::make_pair(*type, i));
+        }
+        else if (firstUntypedConvertorIndex == convertors.size()) {
+            firstUntypedConvertorIndex = i;
+        }
+    }
+}
+
 std::shared_ptr<Element> LuaElementConvertors::convertFromLua(lua_State* L, int index) {
     if (lua_isstring(L, index)) {
         return convertFromLuaUntyped(L, index, "xml");
@@ -93,8 +113,19 @@ std::shared_ptr<Element> LuaElementConvertors::convertFromLua(lua_State* L, int
 
 std::shared_ptr<Element> LuaElementConvertors::convertFromLuaUntyped(lua_State* L, int index, const std::string& type) {
     index = Lua::absoluteOffset(L, index);
-    for (auto&& convertor : convertors) {
-        if (std::shared_ptr<Element> result = convertor->convertFromLua(L, index, type)) {
+
+    // Convertors before the first untyped one only accept their own type,
+    // so start from the first convertor with this type if it comes earlier.
+    size_t start = firstUntypedConvertorIndex;
+    auto i = convertorIndexByType.find(type);
+    if (i != convertorIndexByType.end()) {
+        start = std::min(start, i->second);
+    }
+    for (size_t j = start; j < convertors.size(); ++j) {
+        if (convertorTypes[j] && *convertorTypes[j] != type) {
+            continue;
+        }
+        if (std::shared_ptr<Element> result = convertors[j]->convertFromLua(L, index, type)) {
             return result;
         }
     }
@@ -129,11 +160,33 @@ boost::optional<std::string> LuaElementConvertors::doConvertToLuaUntyped(
     if (!payload) {
         return LuaElementConvertor::NO_RESULT;
     }
-    for (auto&& convertor : convertors) {
-        if (boost::optional<std::string> type = convertor->convertToLua(L, payload)) {
-            return *type;
+
+    std::type_index elementType(typeid(*payload));
+    auto cachedIndex = toLuaConvertorIndexByElementType.find(elementType);
+    if (cachedIndex != toLuaConvertorIndexByElementType.end()) {
+        for (size_t i = cachedIndex->second; i < convertors.size(); ++i) {
+            if (boost::optional<std::string> type = convertors[i]->convertToLua(L, payload)) {
+                return *type;
+            }
+        }
+        return LuaElementConvertor::NO_RESULT;
+    }
+
+    // Whether a typed convertor converts an element only depends on the
+    // element's dynamic type, so the next elements of the same type can
+    // skip the typed convertors that failed, up to the first untyped one.
+    size_t startIndex = convertors.size();
+    boost::optional<std::string> result;
+    for (size_t i = 0; i < convertors.size(); ++i) {
+        if (!convertorTypes[i]) {
+            startIndex = std::min(startIndex, i);
+        }
+        if ((result = convertors[i]->convertToLua(L, payload))) {
+            startIndex = std::min(startIndex, i);
+            break;
         }
     }
-    return LuaElementConvertor::NO_RESULT;
+    toLuaConvertorIndexByElementType[elementType] = startIndex;
+    return result;
 }
 
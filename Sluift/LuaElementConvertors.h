@@ -7,6 +7,9 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
 #include <vector>
 
 #include <boost/optional.hpp>
@@ -43,8 +46,19 @@ namespace Swift {
         private:
             boost::optional<std::string> doConvertToLuaUntyped(lua_State*, std::shared_ptr<Element>);
             void registerConvertors();
+            void indexConvertors();
 
         private:
             std::vector< std::shared_ptr<LuaElementConvertor> > convertors;
+            std::vector< boost::optional<std::string> > convertorTypes;
+
+            // Index of the first convertor with the given type, and of the
+            // first convertor that doesn't have a fixed type
+            std::unordered_map<std::string, size_t> convertorIndexByType;
+            size_t firstUntypedConvertorIndex = 0;
+
+            // Index of the first convertor to try for elements with the
+            // given dynamic type
+            std::unordered_map<std::type_index, size_t> toLuaConvertorIndexByElementType;
     };
 }
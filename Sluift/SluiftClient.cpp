@@ -6,6 +6,8 @@
 
 #include <Sluift/SluiftClient.h>
 
+#include <algorithm>
+
 #include <boost/numeric/conversion/cast.hpp>
 
 #include <Swiften/Client/Client.h>
@@ -95,23 +97,37 @@ void SluiftClient::setSoftwareVersion(const std::string& name, const std::string
 
 boost::optional<SluiftClient::Event> SluiftClient::getNextEvent(
         int timeout, boost::function<bool (const Event&)> condition) {
+    return doGetNextEvent(timeout, boost::optional<Event::Type>(), condition);
+}
+
+boost::optional<SluiftClient::Event> SluiftClient::getNextEvent(
+        int timeout, Event::Type type, boost::function<bool (const Event&)> condition) {
+    return doGetNextEvent(timeout, type, condition);
+}
+
+boost::optional<SluiftClient::Event> SluiftClient::doGetNextEvent(
+        int timeout, const boost::optional<Event::Type>& type, boost::function<bool (const Event&)> condition) {
     Watchdog watchdog(timeout, networkFactories->getTimerFactory());
-    size_t currentIndex = 0;
+    std::fill(scannedEvents, scannedEvents + Event::TypeCount, 0);
     while (true) {
-        // Look for pending events in the queue
-        while (currentIndex < pendingEvents.size()) {
-            Event event = pendingEvents[currentIndex];
+        // Look for pending events in the queues, in the order they arrived
+        while (boost::optional<Event::Type> eventType = getOldestUnscannedEventType(type)) {
+            // Copy the event, as the condition can cause the queues to change
+            Event event = pendingEvents[*eventType][scannedEvents[*eventType]];
             if (!condition || condition(event)) {
-                pendingEvents.erase(
-                        pendingEvents.begin()
-                        + boost::numeric_cast<int>(currentIndex));
+                std::deque<Event>& queue = pendingEvents[*eventType];
+                size_t index = scannedEvents[*eventType];
+                if (index < queue.size() && queue[index].sequenceNumber == event.sequenceNumber) {
+                    queue.erase(queue.begin() + boost::numeric_cast<std::ptrdiff_t>(index));
+                    --pendingEventsCount;
+                }
                 return event;
             }
-            ++currentIndex;
+            ++scannedEvents[*eventType];
         }
 
-        // Wait for new events
-        while (!watchdog.getTimedOut() && currentIndex >= pendingEvents.size() && client->isActive()) {
+        // Wait for new events of the requested type
+        while (!watchdog.getTimedOut() && !hasUnscannedEvents(type) && client->isActive()) {
             eventLoop->runUntilEvents();
         }
 
@@ -122,6 +138,68 @@ boost::optional<SluiftClient::Event> SluiftClient::getNextEvent(
     }
 }
 
+boost::optional<SluiftClient::Event::Type> SluiftClient::getOldestUnscannedEventType(const boost::optional<Event::Type>& type) const {
+    if (type) {
+        if (scannedEvents[*type] < pendingEvents[*type].size()) {
+            return type;
+        }
+        return boost::optional<Event::Type>();
+    }
+    boost::optional<Event::Type> result;
+    for (size_t i = 0; i < Event::TypeCount; ++i) {
+        if (scannedEvents[i] < pendingEvents[i].size()) {
+            if (!result || pendingEvents[i][scannedEvents[i]].sequenceNumber < pendingEvents[*result][scannedEvents[*result]].sequenceNumber) {
+                result = static_cast<Event::Type>(i);
+            }
+        }
+    }
+    return result;
+}
+
+bool SluiftClient::hasUnscannedEvents(const boost::optional<Event::Type>& type) const {
+    return !!getOldestUnscannedEventType(type);
+}
+
+void SluiftClient::setMaxPendingEvents(size_t maxEvents, OverflowPolicy policy) {
+    maxPendingEvents = maxEvents;
+    overflowPolicy = policy;
+    while (maxPendingEvents > 0 && pendingEventsCount > maxPendingEvents) {
+        dropOldestPendingEvent();
+    }
+}
+
+void SluiftClient::addPendingEvent(const Event& event) {
+    if (maxPendingEvents > 0 && pendingEventsCount >= maxPendingEvents) {
+        if (overflowPolicy == DropNewestEvent) {
+            ++droppedEventsCount;
+            return;
+        }
+        dropOldestPendingEvent();
+    }
+    std::deque<Event>& queue = pendingEvents[event.type];
+    queue.push_back(event);
+    queue.back().sequenceNumber = nextEventSequenceNumber++;
+    ++pendingEventsCount;
+}
+
+void SluiftClient::dropOldestPendingEvent() {
+    boost::optional<size_t> oldest;
+    for (size_t i = 0; i < Event::TypeCount; ++i) {
+        if (!pendingEvents[i].empty() && (!oldest || pendingEvents[i].front().sequenceNumber < pendingEvents[*oldest].front().sequenceNumber)) {
+            oldest = i;
+        }
+    }
+    if (!oldest) {
+        return;
+    }
+    pendingEvents[*oldest].pop_front();
+    if (scannedEvents[*oldest] > 0) {
+        --scannedEvents[*oldest];
+    }
+    --pendingEventsCount;
+    ++droppedEventsCount;
+}
+
 std::vector<JID> SluiftClient::getBlockList(int timeout) {
     Watchdog watchdog(timeout, networkFactories->getTimerFactory());
     if (!blockListReceived) {
@@ -166,23 +244,23 @@ void SluiftClient::handleIncomingMessage(std::shared_ptr<Message> stanza) {
         // Already handled by pubsub manager
         return;
     }
-    pendingEvents.push_back(Event(stanza));
+    addPendingEvent(Event(stanza));
 }
 
 void SluiftClient::handleIncomingPresence(std::shared_ptr<Presence> stanza) {
-    pendingEvents.push_back(Event(stanza));
+    addPendingEvent(Event(stanza));
 }
 
 void SluiftClient::handleIncomingPubSubEvent(const JID& from, std::shared_ptr<PubSubEventPayload> event) {
-    pendingEvents.push_back(Event(from, event));
+    addPendingEvent(Event(from, event));
 }
 
 void SluiftClient::handleIncomingBlockEvent(const JID& item) {
-    pendingEvents.push_back(Event(item, Event::BlockEventType));
+    addPendingEvent(Event(item, Event::BlockEventType));
 }
 
 void SluiftClient::handleIncomingUnblockEvent(const JID& item) {
-    pendingEvents.push_back(Event(item, Event::UnblockEventType));
+    addPendingEvent(Event(item, Event::UnblockEventType));
 }
 
 void SluiftClient::handleInitialRosterPopulated() {
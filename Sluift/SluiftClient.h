@@ -47,6 +47,7 @@ namespace Swift {
                     BlockEventType,
                     UnblockEventType
                 };
+                static const size_t TypeCount = UnblockEventType + 1;
 
                 Event(std::shared_ptr<Message> stanza) : type(MessageType), stanza(stanza) {}
                 Event(std::shared_ptr<Presence> stanza) : type(PresenceType), stanza(stanza) {}
@@ -63,6 +64,18 @@ namespace Swift {
 
                 // Blocklist
                 JID item;
+
+                // Arrival order across all event types
+                unsigned long long sequenceNumber = 0;
+            };
+
+            /**
+             * What to do with an incoming event when the maximum number
+             * of pending events is reached.
+             */
+            enum OverflowPolicy {
+                DropOldestEvent,
+                DropNewestEvent
             };
 
             SluiftClient(
@@ -111,11 +124,38 @@ namespace Swift {
             void setSoftwareVersion(const std::string& name, const std::string& version, const std::string& os);
             boost::optional<SluiftClient::Event> getNextEvent(int timeout,
                     boost::function<bool (const Event&)> condition = 0);
+
+            /**
+             * Returns the next event of the given type. Only events of this
+             * type are passed to the condition.
+             */
+            boost::optional<SluiftClient::Event> getNextEvent(int timeout, Event::Type type,
+                    boost::function<bool (const Event&)> condition = 0);
+
+            /**
+             * Limits the number of pending events. A limit of 0 means no limit.
+             */
+            void setMaxPendingEvents(size_t maxEvents, OverflowPolicy policy = DropOldestEvent);
+            size_t getMaxPendingEvents() const {
+                return maxPendingEvents;
+            }
+            OverflowPolicy getOverflowPolicy() const {
+                return overflowPolicy;
+            }
+            size_t getDroppedEventsCount() const {
+                return droppedEventsCount;
+            }
             std::vector<XMPPRosterItem> getRoster(int timeout);
             std::vector<JID> getBlockList(int timeout);
 
         private:
             Sluift::Response doSendRequest(std::shared_ptr<Request> request, int timeout);
+            boost::optional<Event> doGetNextEvent(int timeout, const boost::optional<Event::Type>& type,
+                    boost::function<bool (const Event&)> condition);
+            boost::optional<Event::Type> getOldestUnscannedEventType(const boost::optional<Event::Type>& type) const;
+            bool hasUnscannedEvents(const boost::optional<Event::Type>& type) const;
+            void addPendingEvent(const Event& event);
+            void dropOldestPendingEvent();
 
             void handleIncomingMessage(std::shared_ptr<Message> stanza);
             void handleIncomingPresence(std::shared_ptr<Presence> stanza);
@@ -134,7 +174,16 @@ namespace Swift {
             ClientXMLTracer* tracer;
             bool rosterReceived = false;
             bool blockListReceived = false;
-            std::deque<Event> pendingEvents;
+            // Pending events, indexed by event type
+            std::deque<Event> pendingEvents[Event::TypeCount];
+            // Number of events at the front of each queue that were already
+            // rejected by the condition of the current getNextEvent() call
+            size_t scannedEvents[Event::TypeCount] = {};
+            size_t pendingEventsCount = 0;
+            unsigned long long nextEventSequenceNumber = 0;
+            size_t maxPendingEvents = 100000;
+            OverflowPolicy overflowPolicy = DropOldestEvent;
+            size_t droppedEventsCount = 0;
             boost::optional<ClientError> disconnectedError;
             bool requestResponseReceived = false;
             std::shared_ptr<Payload> requestResponse;
@@ -20,6 +20,7 @@ namespace Swift {
         SluiftGlobals() :
             networkFactories(&eventLoop),
             coreLibIndex(-1),
+            tableToStringIndex(-1),
             moduleLibIndex(-1),
             interruptRequested(0) {}
 
@@ -28,6 +29,7 @@ namespace Swift {
         BoostNetworkFactories networkFactories;
         PlatformTLSFactories tlsFactories;
         int coreLibIndex;
+        int tableToStringIndex;
         int moduleLibIndex;
         sig_atomic_t interruptRequested;
 #ifdef HAVE_ITUNES
@@ -5,8 +5,6 @@
  */
 
 #include <boost/assign/list_of.hpp>
-#include <boost/lambda/bind.hpp>
-#include <boost/lambda/lambda.hpp>
 
 #include <Swiften/Base/IDGenerator.h>
 #include <Swiften/Disco/ClientDiscoManager.h>
@@ -42,7 +40,6 @@
 #include <Sluift/globals.h>
 
 using namespace Swift;
-namespace lambda = boost::lambda;
 
 static inline SluiftClient* getClient(lua_State* L) {
     return *Lua::checkUserData<SluiftClient>(L, 1);
@@ -127,6 +124,26 @@ static void setOptions(lua_State* L, SluiftClient* client) {
     if (!lua_isnil(L, -1)) {
         client->getOptions().allowPLAINWithoutTLS = lua_toboolean(L, -1);
     }
+    size_t maxPendingEvents = client->getMaxPendingEvents();
+    SluiftClient::OverflowPolicy overflowPolicy = client->getOverflowPolicy();
+    lua_getfield(L, 2, "max_pending_events");
+    if (!lua_isnil(L, -1)) {
+        maxPendingEvents = boost::numeric_cast<size_t>(lua_tointeger(L, -1));
+    }
+    lua_getfield(L, 2, "pending_events_overflow");
+    if (!lua_isnil(L, -1)) {
+        std::string policy = Lua::checkString(L, -1);
+        if (policy == "drop_oldest") {
+            overflowPolicy = SluiftClient::DropOldestEvent;
+        }
+        else if (policy == "drop_newest") {
+            overflowPolicy = SluiftClient::DropNewestEvent;
+        }
+        else {
+            throw Lua::Exception("Unknown overflow policy: " + policy);
+        }
+    }
+    client->setMaxPendingEvents(maxPendingEvents, overflowPolicy);
     lua_pushvalue(L, 1);
 }
 
@@ -516,6 +533,8 @@ SLUIFT_LUA_FUNCTION_WITH_HELP(
         "tls  Use TLS when available\n"
         "bosh_url  Connect using the specified BOSH URL\n"
         "allow_plain_without_tls  Allow PLAIN authentication without a TLS encrypted connection\n"
+        "max_pending_events  The maximum number of events kept until they are retrieved (0 for no limit)\n"
+        "pending_events_overflow  What to do when `max_pending_events` is reached (`drop_oldest` or `drop_newest`)\n"
 ) {
     SluiftClient* client = getClient(L);
     setOptions(L, client);
@@ -538,7 +557,10 @@ SLUIFT_LUA_FUNCTION_WITH_HELP(
         ("compress", std::make_shared<Lua::Value>(client->getOptions().useStreamCompression))
         ("tls", std::make_shared<Lua::Value>(client->getOptions().useTLS == ClientOptions::NeverUseTLS ? false : true))
         ("bosh_url", std::make_shared<Lua::Value>(client->getOptions().boshURL.toString()))
-        ("allow_plain_without_tls", std::make_shared<Lua::Value>(client->getOptions().allowPLAINWithoutTLS));
+        ("allow_plain_without_tls", std::make_shared<Lua::Value>(client->getOptions().allowPLAINWithoutTLS))
+        ("max_pending_events", std::make_shared<Lua::Value>(boost::numeric_cast<int>(client->getMaxPendingEvents())))
+        ("pending_events_overflow", std::make_shared<Lua::Value>(std::string(client->getOverflowPolicy() == SluiftClient::DropNewestEvent ? "drop_newest" : "drop_oldest")))
+        ("dropped_events", std::make_shared<Lua::Value>(boost::numeric_cast<int>(client->getDroppedEventsCount())));
     pushValue(L, optionsTable);
     Lua::registerTableToString(L, -1);
     return 1;
@@ -643,6 +665,12 @@ SLUIFT_LUA_FUNCTION(Client, get_next_event) {
             else if (*typeString == "pubsub") {
                 type = SluiftClient::Event::PubSubEventType;
             }
+            else if (*typeString == "block") {
+                type = SluiftClient::Event::BlockEventType;
+            }
+            else if (*typeString == "unblock") {
+                type = SluiftClient::Event::UnblockEventType;
+            }
         }
         if (boost::optional<int> timeoutInt = Lua::getIntField(L, 2, "timeout")) {
             timeout = *timeoutInt;
@@ -653,16 +681,17 @@ SLUIFT_LUA_FUNCTION(Client, get_next_event) {
         }
     }
 
-    boost::optional<SluiftClient::Event> event;
+    boost::function<bool (const SluiftClient::Event&)> predicate;
     if (condition) {
-        event = client->getNextEvent(timeout, CallUnaryLuaPredicateOnEvent(L, condition));
+        predicate = CallUnaryLuaPredicateOnEvent(L, condition);
     }
-    else if (type) {
-        event = client->getNextEvent(
-                timeout, lambda::bind(&SluiftClient::Event::type, lambda::_1) == *type);
+
+    boost::optional<SluiftClient::Event> event;
+    if (type) {
+        event = client->getNextEvent(timeout, *type, predicate);
     }
     else {
-        event = client->getNextEvent(timeout);
+        event = client->getNextEvent(timeout, predicate);
     }
 
     if (event) {
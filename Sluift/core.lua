@@ -600,9 +600,9 @@ extra_help = {
 		[[ Returns the next event. ]],
 		parameters = { "self" },
 		options = {
-			type = "The type of event to return (`message`, `presence`, `pubsub`). When omitted, all event types are returned.",
+			type = "The type of event to return (`message`, `presence`, `pubsub`, `block`, `unblock`). When omitted, all event types are returned.",
 			timeout = "The amount of time to wait for events.",
-			["if"] = "A function to filter events. When this function, called with the event as a parameter, returns true, the event will be returned"
+			["if"] = "A function to filter events. When this function, called with the event as a parameter, returns true, the event will be returned. When `type` is given, only events of that type are passed to the function."
 		}
 	},
 	["Client.get"] = {
@@ -1228,6 +1228,7 @@ return {
 	register_help = register_help,
 	register_class_help = register_class_help,
 	register_table_tostring = register_table_tostring,
+	table_tostring = table_tostring,
 	register_table_equals = register_table_equals,
 	register_get_by_type_index = register_get_by_type_index,
 	process_pubsub_event = process_pubsub_event,
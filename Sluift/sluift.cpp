@@ -438,6 +438,10 @@ SLUIFT_API int luaopen_sluift(lua_State* L) {
     lua_pushvalue(L, -2);
     lua_call(L, 1, 1);
     Sluift::globals.coreLibIndex = luaL_ref(L, LUA_REGISTRYINDEX);
+    lua_rawgeti(L, LUA_REGISTRYINDEX, Sluift::globals.coreLibIndex);
+    lua_getfield(L, -1, "table_tostring");
+    Sluift::globals.tableToStringIndex = luaL_ref(L, LUA_REGISTRYINDEX);
+    lua_pop(L, 1);
 
     // Register functions
     Lua::FunctionRegistry::getInstance().addFunctionsToTable(L, "Sluift");
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <SwifTools/MultiStringMatcher.h>
+
+#include <algorithm>
+#include <cctype>
+#include <deque>
+
+namespace Swift {
+
+namespace {
+    struct TransitionLess {
+        bool operator()(const std::pair<char, size_t>& transition, char c) const {
+            return transition.first < c;
+        }
+    };
+
+    struct MatchLess {
+        bool operator()(const MultiStringMatcher::Match& a, const MultiStringMatcher::Match& b) const {
+            return a.position < b.position || (a.position == b.position && a.pattern < b.pattern);
+        }
+    };
+}
+
+MultiStringMatcher::MultiStringMatcher(const std::vector<std::string>& patterns, bool caseSensitive) : patterns_(patterns), caseSensitive_(caseSensitive) {
+    // Build the trie. Node 0 is the root.
+    nodes_.push_back(Node());
+    for (size_t i = 0; i < patterns_.size(); ++i) {
+        if (patterns_[i].empty()) {
+            continue;
+        }
+        size_t node = 0;
+        for (char c : patterns_[i]) {
+            c = normalize(c);
+            std::vector<std::pair<char, size_t> >& transitions = nodes_[node].transitions;
+            std::vector<std::pair<char, size_t> >::iterator transition = std::lower_bound(transitions.begin(), transitions.end(), c, TransitionLess());
+            if (transition != transitions.end() && transition->first == c) {
+                node = transition->second;
+            }
+            else {
+                size_t next = nodes_.size();
+                transitions.insert(transition, std::make_pair(c, next));
+                nodes_.push_back(Node());
+                node = next;
+            }
+        }
+        nodes_[node].patterns.push_back(i);
+    }
+
+    // Compute the failure and output links breadth first
+    std::deque<size_t> queue;
+    for (const auto& transition : nodes_[0].transitions) {
+        queue.push_back(transition.second);
+    }
+    while (!queue.empty()) {
+        size_t node = queue.front();
+        queue.pop_front();
+        nodes_[node].output = nodes_[node].patterns.empty() ? nodes_[nodes_[node].failure].output : node;
+        for (const auto& transition : nodes_[node].transitions) {
+            size_t failure = nodes_[node].failure;
+            size_t next;
+            while ((next = findTransition(failure, transition.first)) == 0 && failure != 0) {
+                failure = nodes_[failure].failure;
+            }
+            nodes_[transition.second].failure = next;
+            queue.push_back(transition.second);
+        }
+    }
+}
+
+char MultiStringMatcher::normalize(char c) const {
+    return caseSensitive_ ? c : static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+size_t MultiStringMatcher::findTransition(size_t node, char c) const {
+    const std::vector<std::pair<char, size_t> >& transitions = nodes_[node].transitions;
+    std::vector<std::pair<char, size_t> >::const_iterator transition = std::lower_bound(transitions.begin(), transitions.end(), c, TransitionLess());
+    if (transition != transitions.end() && transition->first == c) {
+        return transition->second;
+    }
+    return 0;
+}
+
+std::vector<MultiStringMatcher::Match> MultiStringMatcher::findAll(const std::string& text) const {
+    std::vector<Match> matches;
+    if (nodes_.size() == 1) {
+        return matches;
+    }
+    size_t node = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        char c = normalize(text[i]);
+        size_t next;
+        while ((next = findTransition(node, c)) == 0 && node != 0) {
+            node = nodes_[node].failure;
+        }
+        node = next;
+        for (size_t output = nodes_[node].output; output != 0; output = nodes_[nodes_[output].failure].output) {
+            for (size_t pattern : nodes_[output].patterns) {
+                matches.push_back(Match(i + 1 - patterns_[pattern].size(), pattern));
+            }
+        }
+    }
+    std::sort(matches.begin(), matches.end(), MatchLess());
+    return matches;
+}
+
+}
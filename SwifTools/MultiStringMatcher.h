@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Swift {
+    /**
+     * Finds all occurrences of a fixed set of strings in a text in a single
+     * pass, using an Aho-Corasick automaton built when the matcher is
+     * constructed.
+     */
+    class MultiStringMatcher {
+        public:
+            struct Match {
+                Match(size_t position, size_t pattern) : position(position), pattern(pattern) {
+                }
+
+                size_t position;
+                /** Index of the matched string in the patterns passed to the constructor. */
+                size_t pattern;
+            };
+
+        public:
+            /**
+             * Empty patterns never match. If caseSensitive is false, ASCII
+             * letters match regardless of their case.
+             */
+            MultiStringMatcher(const std::vector<std::string>& patterns = std::vector<std::string>(), bool caseSensitive = true);
+
+            const std::vector<std::string>& getPatterns() const {
+                return patterns_;
+            }
+
+            /**
+             * Returns all (possibly overlapping) occurrences of the patterns
+             * in text, ordered by position and pattern index.
+             */
+            std::vector<Match> findAll(const std::string& text) const;
+
+        private:
+            struct Node {
+                Node() : failure(0), output(0) {}
+
+                // Sorted by character
+                std::vector<std::pair<char, size_t> > transitions;
+                size_t failure;
+                // Nearest node on the failure chain (including this one)
+                // where a pattern ends, or 0 if there is none.
+                size_t output;
+                std::vector<size_t> patterns;
+            };
+
+            char normalize(char c) const;
+            size_t findTransition(size_t node, char c) const;
+
+        private:
+            std::vector<std::string> patterns_;
+            bool caseSensitive_;
+            std::vector<Node> nodes_;
+    };
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <string>
+#include <vector>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <SwifTools/MultiStringMatcher.h>
+
+using namespace Swift;
+
+class MultiStringMatcherTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(MultiStringMatcherTest);
+        CPPUNIT_TEST(testFindAll);
+        CPPUNIT_TEST(testFindAll_OverlappingPatterns);
+        CPPUNIT_TEST(testFindAll_CaseInsensitive);
+        CPPUNIT_TEST(testFindAll_EmptyPattern);
+        CPPUNIT_TEST(testFindAll_NoPatterns);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void testFindAll() {
+            MultiStringMatcher testling(std::vector<std::string>{":)", ":(", "<3"});
+
+            std::vector<MultiStringMatcher::Match> matches = testling.findAll("a :) b <3:(");
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), matches.size());
+            assertMatch(2, 0, matches[0]);
+            assertMatch(7, 2, matches[1]);
+            assertMatch(9, 1, matches[2]);
+        }
+
+        void testFindAll_OverlappingPatterns() {
+            MultiStringMatcher testling(std::vector<std::string>{"she", "he", "hers", "his", "he"});
+
+            std::vector<MultiStringMatcher::Match> matches = testling.findAll("ushers");
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(4), matches.size());
+            assertMatch(1, 0, matches[0]);
+            assertMatch(2, 1, matches[1]);
+            assertMatch(2, 2, matches[2]);
+            assertMatch(2, 4, matches[3]);
+        }
+
+        void testFindAll_CaseInsensitive() {
+            MultiStringMatcher testling(std::vector<std::string>{"Alice", "bob"}, false);
+
+            std::vector<MultiStringMatcher::Match> matches = testling.findAll("BOB and aLiCe");
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), matches.size());
+            assertMatch(0, 1, matches[0]);
+            assertMatch(8, 0, matches[1]);
+            CPPUNIT_ASSERT(MultiStringMatcher(std::vector<std::string>{"Alice"}).findAll("aLiCe").empty());
+        }
+
+        void testFindAll_EmptyPattern() {
+            MultiStringMatcher testling(std::vector<std::string>{"", "a"});
+
+            std::vector<MultiStringMatcher::Match> matches = testling.findAll("aa");
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), matches.size());
+            assertMatch(0, 1, matches[0]);
+            assertMatch(1, 1, matches[1]);
+        }
+
+        void testFindAll_NoPatterns() {
+            MultiStringMatcher testling;
+
+            CPPUNIT_ASSERT(testling.findAll("text").empty());
+        }
+
+    private:
+        void assertMatch(size_t position, size_t pattern, const MultiStringMatcher::Match& match) {
+            CPPUNIT_ASSERT_EQUAL(position, match.position);
+            CPPUNIT_ASSERT_EQUAL(pattern, match.pattern);
+        }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MultiStringMatcherTest);
@@ -7,24 +7,68 @@
 #include <Swift/Controllers/Chat/ChatMessageParser.h>
 
 #include <algorithm>
+#include <cctype>
 #include <memory>
 #include <utility>
 #include <vector>
 
 #include <boost/algorithm/string.hpp>
-#include <boost/regex.hpp>
 
-#include <Swiften/Base/Regex.h>
 #include <Swiften/Base/String.h>
 
 #include <SwifTools/Linkify.h>
 
 namespace Swift {
 
-    ChatMessageParser::ChatMessageParser(const std::map<std::string, std::string>& emoticons, std::shared_ptr<HighlightConfiguration> highlightConfiguration, Mode mode) : emoticons_(emoticons), highlightConfiguration_(highlightConfiguration), mode_(mode) {
+    namespace {
+        typedef std::pair<std::string, std::string> StringPair;
+
+        std::vector<std::string> getKeys(const std::map<std::string, std::string>& map) {
+            std::vector<std::string> keys;
+            for (const auto& item : map) {
+                keys.push_back(item.first);
+            }
+            return keys;
+        }
+
+        /* Same characters as \s and \w in the regular expressions used before */
+        bool isSpace(char c) {
+            return std::isspace(static_cast<unsigned char>(c)) != 0;
+        }
+
+        bool isWordCharacter(char c) {
+            return std::isalnum(static_cast<unsigned char>(c)) != 0 || c == '_';
+        }
+
+        /* Whether there is a word boundary at position in text[begin, end) */
+        bool isWordBoundary(const std::string& text, size_t position, size_t begin, size_t end) {
+            bool wordBefore = position > begin && isWordCharacter(text[position - 1]);
+            bool wordAfter = position < end && isWordCharacter(text[position]);
+            return wordBefore != wordAfter;
+        }
+
+        struct KeywordRule {
+            KeywordRule(size_t pattern, bool matchCaseSensitive, const HighlightAction& action) : pattern(pattern), matchCaseSensitive(matchCaseSensitive), action(action) {
+            }
+
+            size_t pattern;
+            bool matchCaseSensitive;
+            HighlightAction action;
+        };
+
+        struct Segment {
+            Segment(size_t begin, size_t end, const KeywordRule* rule) : begin(begin), end(end), rule(rule) {
+            }
+
+            size_t begin;
+            size_t end;
+            // The rule highlighting this segment, or nullptr for plain text
+            const KeywordRule* rule;
+        };
     }
 
-    typedef std::pair<std::string, std::string> StringPair;
+    ChatMessageParser::ChatMessageParser(const std::map<std::string, std::string>& emoticons, std::shared_ptr<HighlightConfiguration> highlightConfiguration, Mode mode) : emoticons_(emoticons), emoticonMatcher_(getKeys(emoticons)), highlightConfiguration_(highlightConfiguration), mode_(mode) {
+    }
 
     ChatWindow::ChatMessage ChatMessageParser::parseMessageBody(const std::string& body, const std::string& senderNickname, bool senderIsSelf) {
         ChatWindow::ChatMessage parsedMessage;
@@ -74,159 +118,205 @@ namespace Swift {
     }
 
     ChatWindow::ChatMessage ChatMessageParser::emoticonHighlight(const ChatWindow::ChatMessage& message) {
-        ChatWindow::ChatMessage parsedMessage = message;
-
-        std::string regexString;
-        /* Parse two, emoticons */
-        for (StringPair emoticon : emoticons_) {
-            /* Construct a regexp that finds an instance of any of the emoticons inside a group
-             * at the start or end of the line, or beside whitespace.
-             */
-            regexString += regexString.empty() ? "" : "|";
-            std::string escaped = "(" + Regex::escape(emoticon.first) + ")";
-            regexString += "^" + escaped + "|";
-            regexString += escaped + "$|";
-            regexString += "\\s" + escaped + "|";
-            regexString += escaped + "\\s";
-
+        if (emoticons_.empty()) {
+            return message;
         }
-        if (!regexString.empty()) {
-            regexString += "";
-            boost::regex emoticonRegex(regexString);
-
-            ChatWindow::ChatMessage newMessage;
-            for (const auto& part : parsedMessage.getParts()) {
-                std::shared_ptr<ChatWindow::ChatTextMessagePart> textPart;
-                if ((textPart = std::dynamic_pointer_cast<ChatWindow::ChatTextMessagePart>(part))) {
-                    try {
-                        boost::match_results<std::string::const_iterator> match;
-                        const std::string& text = textPart->text;
-                        std::string::const_iterator start = text.begin();
-                        while (regex_search(start, text.end(), match, emoticonRegex)) {
-                            int matchIndex = 0;
-                            for (matchIndex = 1; matchIndex < static_cast<int>(match.size()); matchIndex++) {
-                                if (match[matchIndex].length() > 0) {
-                                    //This is the matching subgroup
-                                    break;
-                                }
-                            }
-                            std::string::const_iterator matchStart = match[matchIndex].first;
-                            std::string::const_iterator matchEnd = match[matchIndex].second;
-                            if (start != matchStart) {
-                                /* If we're skipping over plain text since the previous emoticon, record it as plain text */
-                                newMessage.append(std::make_shared<ChatWindow::ChatTextMessagePart>(std::string(start, matchStart)));
-                            }
-                            std::shared_ptr<ChatWindow::ChatEmoticonMessagePart> emoticonPart = std::make_shared<ChatWindow::ChatEmoticonMessagePart>();
-                            std::string matchString = match[matchIndex].str();
-                            std::map<std::string, std::string>::const_iterator emoticonIterator = emoticons_.find(matchString);
-                            assert (emoticonIterator != emoticons_.end());
-                            const StringPair& emoticon = *emoticonIterator;
-                            emoticonPart->imagePath = emoticon.second;
-                            emoticonPart->alternativeText = emoticon.first;
-                            newMessage.append(emoticonPart);
-                            start = matchEnd;
-                        }
-                        if (start != text.end()) {
-                            /* If there's plain text after the last emoticon, record it */
-                            newMessage.append(std::make_shared<ChatWindow::ChatTextMessagePart>(std::string(start, text.end())));
-                        }
 
+        /* Parse two, emoticons
+         * An emoticon is only recognized at the start or end of the text, or beside whitespace. Like the
+         * regular expression this replaces, this takes the leftmost match (counting a preceding whitespace
+         * as part of the match), preferring the first emoticon in map order, and restarts matching after each
+         * emoticon as if the remaining text was a new text.
+         */
+        const std::vector<std::string>& patterns = emoticonMatcher_.getPatterns();
+        ChatWindow::ChatMessage newMessage;
+        for (const auto& part : message.getParts()) {
+            std::shared_ptr<ChatWindow::ChatTextMessagePart> textPart;
+            if (!(textPart = std::dynamic_pointer_cast<ChatWindow::ChatTextMessagePart>(part))) {
+                newMessage.append(part);
+                continue;
+            }
+
+            const std::string& text = textPart->text;
+            std::vector<MultiStringMatcher::Match> matches = emoticonMatcher_.findAll(text);
+            size_t start = 0;
+            size_t firstCandidate = 0;
+            while (true) {
+                /* Find the leftmost valid match from the current start */
+                while (firstCandidate < matches.size() && matches[firstCandidate].position < start) {
+                    ++firstCandidate;
+                }
+                bool found = false;
+                size_t bestMatchStart = 0;
+                size_t bestPattern = 0;
+                size_t bestPosition = 0;
+                for (size_t i = firstCandidate; i < matches.size(); ++i) {
+                    size_t position = matches[i].position;
+                    if (found && position > bestMatchStart + 1) {
+                        break;
                     }
-                    catch (const std::runtime_error&) {
-                        /* Basically too expensive to compute the regex results and it gave up, so pass through as text */
-                        newMessage.append(part);
+                    size_t end = position + patterns[matches[i].pattern].size();
+                    size_t matchStart;
+                    if (position == start || end == text.size() || isSpace(text[end])) {
+                        matchStart = position;
+                    }
+                    else if (position > start && isSpace(text[position - 1])) {
+                        matchStart = position - 1;
+                    }
+                    else {
+                        continue;
+                    }
+                    if (!found || matchStart < bestMatchStart || (matchStart == bestMatchStart && matches[i].pattern < bestPattern)) {
+                        found = true;
+                        bestMatchStart = matchStart;
+                        bestPattern = matches[i].pattern;
+                        bestPosition = position;
                     }
                 }
-                else {
-                    newMessage.append(part);
+                if (!found) {
+                    break;
                 }
+
+                if (start != bestPosition) {
+                    /* If we're skipping over plain text since the previous emoticon, record it as plain text */
+                    newMessage.append(std::make_shared<ChatWindow::ChatTextMessagePart>(text.substr(start, bestPosition - start)));
+                }
+                std::shared_ptr<ChatWindow::ChatEmoticonMessagePart> emoticonPart = std::make_shared<ChatWindow::ChatEmoticonMessagePart>();
+                std::map<std::string, std::string>::const_iterator emoticonIterator = emoticons_.find(patterns[bestPattern]);
+                assert (emoticonIterator != emoticons_.end());
+                const StringPair& emoticon = *emoticonIterator;
+                emoticonPart->imagePath = emoticon.second;
+                emoticonPart->alternativeText = emoticon.first;
+                newMessage.append(emoticonPart);
+                start = bestPosition + emoticon.first.size();
+            }
+            if (start != text.size()) {
+                /* If there's plain text after the last emoticon, record it */
+                newMessage.append(std::make_shared<ChatWindow::ChatTextMessagePart>(text.substr(start)));
             }
-            parsedMessage.setParts(newMessage.getParts());
         }
 
+        ChatWindow::ChatMessage parsedMessage = message;
+        parsedMessage.setParts(newMessage.getParts());
         return parsedMessage;
     }
 
+    void ChatMessageParser::updateKeywordMatcher() {
+        const std::vector<std::string>& patterns = keywordMatcher_.getPatterns();
+        const auto& keywordHighlights = highlightConfiguration_->keywordHighlights;
+        bool upToDate = patterns.size() == keywordHighlights.size() + 1 && patterns[0] == nick_;
+        for (size_t i = 0; upToDate && i < keywordHighlights.size(); ++i) {
+            upToDate = patterns[i + 1] == keywordHighlights[i].keyword;
+        }
+        if (!upToDate) {
+            std::vector<std::string> newPatterns;
+            newPatterns.push_back(nick_);
+            for (const auto& keywordHighlight : keywordHighlights) {
+                newPatterns.push_back(keywordHighlight.keyword);
+            }
+            keywordMatcher_ = MultiStringMatcher(newPatterns, false);
+        }
+    }
+
     ChatWindow::ChatMessage ChatMessageParser::splitHighlight(const ChatWindow::ChatMessage& message) {
-        auto keywordToRegEx = [](const std::string& keyword, bool matchCaseSensitive) {
-            std::string escaped = Regex::escape(keyword);
-            boost::regex::flag_type flags = boost::regex::normal;
-            if (!matchCaseSensitive) {
-                flags |= boost::regex::icase;
+        updateKeywordMatcher();
+
+        // Rules in order of precedence: mentions of own nickname, then the keywords
+        std::vector<KeywordRule> rules;
+        HighlightAction ownMentionKeywordAction = highlightConfiguration_->ownMentionAction;
+        ownMentionKeywordAction.setSoundFilePath(boost::optional<std::string>());
+        ownMentionKeywordAction.setSystemNotificationEnabled(false);
+        if (!getNick().empty() && !highlightConfiguration_->ownMentionAction.isEmpty()) {
+            rules.push_back(KeywordRule(0, false, ownMentionKeywordAction));
+        }
+        for (size_t i = 0; i < highlightConfiguration_->keywordHighlights.size(); ++i) {
+            const auto& keywordHighlight = highlightConfiguration_->keywordHighlights[i];
+            if (keywordHighlight.keyword.empty() || keywordHighlight.action.isEmpty()) {
+                continue;
+            }
+            rules.push_back(KeywordRule(i + 1, keywordHighlight.matchCaseSensitive, keywordHighlight.action));
+        }
+        if (rules.empty()) {
+            return message;
+        }
+
+        /* Each rule highlights whole words in the text that is not yet highlighted by a previous rule. The
+         * word boundaries are determined within each piece of remaining text, restarting after each match.
+         */
+        const std::vector<std::string>& patterns = keywordMatcher_.getPatterns();
+        bool ownMention = false;
+        ChatWindow::ChatMessage resultMessage;
+        for (const auto& part : message.getParts()) {
+            std::shared_ptr<ChatWindow::ChatTextMessagePart> textPart;
+            if (!(textPart = std::dynamic_pointer_cast<ChatWindow::ChatTextMessagePart>(part))) {
+                resultMessage.append(part);
+                continue;
+            }
+
+            const std::string& text = textPart->text;
+            std::vector<std::vector<size_t> > positionsByPattern(patterns.size());
+            for (const auto& match : keywordMatcher_.findAll(text)) {
+                positionsByPattern[match.pattern].push_back(match.position);
             }
-            return boost::regex("\\b" + escaped + "\\b", flags);
-        };
 
-        auto highlightKeywordInChatMessage = [&](const ChatWindow::ChatMessage& message, const std::string& keyword, bool matchCaseSensitive, const HighlightAction& action) {
-            ChatWindow::ChatMessage resultMessage;
-
-            for (const auto& part : message.getParts()) {
-                std::shared_ptr<ChatWindow::ChatTextMessagePart> textPart;
-                if ((textPart = std::dynamic_pointer_cast<ChatWindow::ChatTextMessagePart>(part))) {
-                    try {
-                        boost::match_results<std::string::const_iterator> match;
-                        const std::string& text = textPart->text;
-                        std::string::const_iterator start = text.begin();
-                        while (regex_search(start, text.end(), match, keywordToRegEx(keyword, matchCaseSensitive))) {
-                            std::string::const_iterator matchStart = match[0].first;
-                            std::string::const_iterator matchEnd = match[0].second;
-                            if (start != matchStart) {
-                                /* If we're skipping over plain text since the previous emoticon, record it as plain text */
-                                resultMessage.append(std::make_shared<ChatWindow::ChatTextMessagePart>(std::string(start, matchStart)));
-                            }
-                            std::shared_ptr<ChatWindow::ChatHighlightingMessagePart> highlightPart = std::make_shared<ChatWindow::ChatHighlightingMessagePart>();
-                            highlightPart->text = match.str();
-                            highlightPart->action = action;
-                            resultMessage.append(highlightPart);
-                            start = matchEnd;
+            std::vector<Segment> segments(1, Segment(0, text.size(), nullptr));
+            for (const auto& rule : rules) {
+                const std::vector<size_t>& positions = positionsByPattern[rule.pattern];
+                if (positions.empty()) {
+                    continue;
+                }
+                const std::string& pattern = patterns[rule.pattern];
+                std::vector<Segment> newSegments;
+                for (const auto& segment : segments) {
+                    if (segment.rule) {
+                        newSegments.push_back(segment);
+                        continue;
+                    }
+                    size_t start = segment.begin;
+                    for (std::vector<size_t>::const_iterator i = std::lower_bound(positions.begin(), positions.end(), start); i != positions.end() && *i + pattern.size() <= segment.end; ++i) {
+                        size_t position = *i;
+                        if (position < start) {
+                            continue;
+                        }
+                        if (rule.matchCaseSensitive && text.compare(position, pattern.size(), pattern) != 0) {
+                            continue;
+                        }
+                        if (!isWordBoundary(text, position, start, segment.end) || !isWordBoundary(text, position + pattern.size(), start, segment.end)) {
+                            continue;
                         }
-                        if (start != text.end()) {
-                            /* If there's plain text after the last emoticon, record it */
-                            resultMessage.append(std::make_shared<ChatWindow::ChatTextMessagePart>(std::string(start, text.end())));
+                        if (start != position) {
+                            newSegments.push_back(Segment(start, position, nullptr));
                         }
+                        newSegments.push_back(Segment(position, position + pattern.size(), &rule));
+                        start = position + pattern.size();
                     }
-                    catch (const std::runtime_error&) {
-                        /* Basically too expensive to compute the regex results and it gave up, so pass through as text */
-                        resultMessage.append(part);
+                    if (start != segment.end) {
+                        newSegments.push_back(Segment(start, segment.end, nullptr));
                     }
-                } else {
-                    resultMessage.append(part);
                 }
+                segments.swap(newSegments);
             }
-            return resultMessage;
-        };
-
-        ChatWindow::ChatMessage parsedMessage = message;
 
-        // detect mentions of own nickname
-        HighlightAction ownMentionKeywordAction = highlightConfiguration_->ownMentionAction;
-        ownMentionKeywordAction.setSoundFilePath(boost::optional<std::string>());
-        ownMentionKeywordAction.setSystemNotificationEnabled(false);
-        if (!getNick().empty() && !highlightConfiguration_->ownMentionAction.isEmpty()) {
-            auto nicknameHighlightedMessage = highlightKeywordInChatMessage(parsedMessage, nick_, false, ownMentionKeywordAction);
-            auto highlightedParts = nicknameHighlightedMessage.getParts();
-            auto ownNicknamePart = std::find_if(highlightedParts.begin(), highlightedParts.end(), [&](std::shared_ptr<ChatWindow::ChatMessagePart>& part){
-                auto highlightPart = std::dynamic_pointer_cast<ChatWindow::ChatHighlightingMessagePart>(part);
-                if (highlightPart && highlightPart->text == nick_) {
-                    return true;
+            for (const auto& segment : segments) {
+                std::string segmentText = text.substr(segment.begin, segment.end - segment.begin);
+                if (segment.rule) {
+                    std::shared_ptr<ChatWindow::ChatHighlightingMessagePart> highlightPart = std::make_shared<ChatWindow::ChatHighlightingMessagePart>();
+                    highlightPart->text = segmentText;
+                    highlightPart->action = segment.rule->action;
+                    ownMention = ownMention || (segment.rule->pattern == 0 && segmentText == nick_);
+                    resultMessage.append(highlightPart);
+                }
+                else {
+                    resultMessage.append(std::make_shared<ChatWindow::ChatTextMessagePart>(segmentText));
                 }
-                return false;
-            });
-            if (ownNicknamePart != highlightedParts.end()) {
-                parsedMessage.setHighlightActionOwnMention(highlightConfiguration_->ownMentionAction);
             }
-            parsedMessage.setParts(nicknameHighlightedMessage.getParts());
         }
 
-        // detect keywords
-        for (const auto& keywordHighlight : highlightConfiguration_->keywordHighlights) {
-            if (keywordHighlight.keyword.empty() || keywordHighlight.action.isEmpty()) {
-                continue;
-            }
-            auto newMessage = highlightKeywordInChatMessage(parsedMessage, keywordHighlight.keyword, keywordHighlight.matchCaseSensitive, keywordHighlight.action);
-            parsedMessage.setParts(newMessage.getParts());
+        ChatWindow::ChatMessage parsedMessage = message;
+        if (ownMention) {
+            parsedMessage.setHighlightActionOwnMention(highlightConfiguration_->ownMentionAction);
         }
-
+        parsedMessage.setParts(resultMessage.getParts());
         return parsedMessage;
     }
 
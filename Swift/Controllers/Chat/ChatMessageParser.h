@@ -6,12 +6,16 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <Swift/Controllers/Highlighting/HighlightConfiguration.h>
 #include <Swift/Controllers/UIInterfaces/ChatWindow.h>
 
+#include <SwifTools/MultiStringMatcher.h>
+
 namespace Swift {
 
     /**
@@ -34,9 +38,14 @@ namespace Swift {
             ChatWindow::ChatMessage emoticonHighlight(const ChatWindow::ChatMessage& parsedMessage);
             ChatWindow::ChatMessage splitHighlight(const ChatWindow::ChatMessage& parsedMessage);
             ChatWindow::ChatMessage fullMessageHighlight(const ChatWindow::ChatMessage& parsedMessage, const std::string& sender);
+            void updateKeywordMatcher();
 
         private:
             std::map<std::string, std::string> emoticons_;
+            MultiStringMatcher emoticonMatcher_;
+            // Matches the nick (pattern 0) and the highlight keywords (pattern i + 1),
+            // rebuilt when either changes.
+            MultiStringMatcher keywordMatcher_;
             std::shared_ptr<HighlightConfiguration> highlightConfiguration_;
             Mode mode_;
             std::string nick_;
@@ -246,6 +246,7 @@ void ChatsManager::saveRecents() {
 
 void ChatsManager::handleClearRecentsRequested() {
     recentChats_.clear();
+    onContactsChanged();
     saveRecents();
     handleUnreadCountChanged(nullptr);
 }
@@ -479,6 +480,7 @@ boost::optional<ChatListWindow::Chat> ChatsManager::removeExistingChat(const Cha
     if (result != recentChats_.end()) {
         ChatListWindow::Chat existingChat = *result;
         recentChats_.erase(std::remove(recentChats_.begin(), recentChats_.end(), chat), recentChats_.end());
+        handleRecentChanged(existingChat);
         return boost::optional<ChatListWindow::Chat>(existingChat);
     } else {
         return boost::optional<ChatListWindow::Chat>();
@@ -511,6 +513,7 @@ void ChatsManager::appendRecent(const ChatListWindow::Chat& chat) {
         mergedChat.impromptuJIDs.insert(oldChat->impromptuJIDs.begin(), oldChat->impromptuJIDs.end());
     }
     recentChats_.push_front(mergedChat);
+    handleRecentChanged(mergedChat);
 }
 
 void ChatsManager::prependRecent(const ChatListWindow::Chat& chat) {
@@ -521,6 +524,14 @@ void ChatsManager::prependRecent(const ChatListWindow::Chat& chat) {
         mergedChat.impromptuJIDs.insert(oldChat->impromptuJIDs.begin(), oldChat->impromptuJIDs.end());
     }
     recentChats_.push_back(mergedChat);
+    handleRecentChanged(mergedChat);
+}
+
+void ChatsManager::handleRecentChanged(const ChatListWindow::Chat& chat) {
+    // MUC recents are not suggested as contacts
+    if (!chat.isMUC) {
+        onContactChanged(chat.jid.toBare());
+    }
 }
 
 void ChatsManager::handleUserLeftMUC(MUCController* mucController) {
@@ -532,8 +543,18 @@ void ChatsManager::handleUserLeftMUC(MUCController* mucController) {
                     chat.statusType = StatusShow::None;
                 }
             }
+            JID mucJID = it->first;
             mucControllers_.erase(it);
             delete mucController;
+            for (auto occupant = mucOccupantStatuses_.begin(); occupant != mucOccupantStatuses_.end(); ) {
+                if (occupant->first.toBare() == mucJID) {
+                    occupant = mucOccupantStatuses_.erase(occupant);
+                }
+                else {
+                    ++occupant;
+                }
+            }
+            onMUCNicksChanged();
             break;
         }
     }
@@ -643,6 +664,7 @@ void ChatsManager::markAllRecentsOffline() {
     for (ChatListWindow::Chat& chat : recentChats_) {
         chat.setStatusType(StatusShow::None);
     }
+    onContactsChanged();
 
     chatListWindow_->setRecents(recentChats_);
 }
@@ -667,12 +689,19 @@ void ChatsManager::handleTransformChatToMUC(ChatController* chatController, Chat
  * If a resource goes offline, release bound chatdialog to that resource.
  */
 void ChatsManager::handlePresenceChange(std::shared_ptr<Presence> newPresence) {
-    if (mucRegistry_->isMUC(newPresence->getFrom().toBare())) return;
+    if (mucRegistry_->isMUC(newPresence->getFrom().toBare())) {
+        handleMUCOccupantPresenceChange(newPresence);
+        return;
+    }
 
     for (ChatListWindow::Chat& chat : recentChats_) {
         if (newPresence->getFrom().toBare() == chat.jid.toBare() && !chat.isMUC) {
             Presence::ref presence = presenceOracle_->getHighestPriorityPresence(chat.jid.toBare());
-            chat.setStatusType(presence ? presence->getShow() : StatusShow::None);
+            StatusShow::Type statusType = presence ? presence->getShow() : StatusShow::None;
+            if (statusType != chat.statusType) {
+                chat.setStatusType(statusType);
+                onContactChanged(chat.jid.toBare());
+            }
             chatListWindow_->setRecents(recentChats_);
             break;
         }
@@ -688,6 +717,28 @@ void ChatsManager::handlePresenceChange(std::shared_ptr<Presence> newPresence) {
     rebindControllerJID(fullJID, bareJID);
 }
 
+/**
+ * Only the nicks and statuses of the occupants of joined MUCs are suggested as
+ * contacts, so other occupant presence changes are ignored.
+ */
+void ChatsManager::handleMUCOccupantPresenceChange(std::shared_ptr<Presence> presence) {
+    const JID& occupantJID = presence->getFrom();
+    if (mucControllers_.find(occupantJID.toBare()) == mucControllers_.end()) {
+        return;
+    }
+    auto occupant = mucOccupantStatuses_.find(occupantJID);
+    if (presence->getType() == Presence::Unavailable) {
+        if (occupant != mucOccupantStatuses_.end()) {
+            mucOccupantStatuses_.erase(occupant);
+            onMUCNicksChanged();
+        }
+    }
+    else if (occupant == mucOccupantStatuses_.end() || occupant->second != presence->getShow()) {
+        mucOccupantStatuses_[occupantJID] = presence->getShow();
+        onMUCNicksChanged();
+    }
+}
+
 void ChatsManager::setAvatarManager(AvatarManager* avatarManager) {
     if (avatarManager_) {
         avatarManager_->onAvatarChanged.disconnect(boost::bind(&ChatsManager::handleAvatarChanged, this, _1));
@@ -698,6 +749,7 @@ void ChatsManager::setAvatarManager(AvatarManager* avatarManager) {
             chat.setAvatarPath(avatarManager_->getAvatarPath(chat.jid));
         }
     }
+    onContactsChanged();
     avatarManager_->onAvatarChanged.connect(boost::bind(&ChatsManager::handleAvatarChanged, this, _1));
 }
 
@@ -705,6 +757,7 @@ void ChatsManager::handleAvatarChanged(const JID& jid) {
     for (ChatListWindow::Chat& chat : recentChats_) {
         if (!chat.isMUC && jid.toBare() == chat.jid.toBare()) {
             chat.setAvatarPath(avatarManager_->getAvatarPath(jid));
+            onContactChanged(chat.jid.toBare());
             break;
         }
     }
@@ -869,6 +922,7 @@ MUC::ref ChatsManager::handleJoinMUCRequest(const JID &mucJID, const boost::opti
         }
 
         mucControllers_[mucJID] = controller;
+        onMUCNicksChanged();
         controller->setAvailableServerFeatures(serverDiscoInfo_);
         controller->onUserLeft.connect(boost::bind(&ChatsManager::handleUserLeftMUC, this, controller));
         controller->onUserJoined.connect(boost::bind(&ChatsManager::handleChatActivity, this, mucJID.toBare(), "", true));
@@ -1113,9 +1167,9 @@ std::vector<ChatListWindow::Chat> ChatsManager::getRecentChats() const {
 
 std::vector<Contact::ref> Swift::ChatsManager::getContacts(bool withMUCNicks) {
     std::vector<Contact::ref> result;
-    for (ChatListWindow::Chat chat : recentChats_) {
+    for (const ChatListWindow::Chat& chat : recentChats_) {
         if (!chat.isMUC) {
-            result.push_back(std::make_shared<Contact>(chat.chatName.empty() ? chat.jid.toString() : chat.chatName, chat.jid, chat.statusType, chat.avatarPath));
+            result.push_back(createContact(chat));
         }
     }
     if (withMUCNicks) {
@@ -1136,6 +1190,20 @@ std::vector<Contact::ref> Swift::ChatsManager::getContacts(bool withMUCNicks) {
     return result;
 }
 
+std::vector<Contact::ref> Swift::ChatsManager::getContactsWithJID(const JID& jid) {
+    std::vector<Contact::ref> result;
+    for (const ChatListWindow::Chat& chat : recentChats_) {
+        if (!chat.isMUC && chat.jid.toBare() == jid) {
+            result.push_back(createContact(chat));
+        }
+    }
+    return result;
+}
+
+Contact::ref ChatsManager::createContact(const ChatListWindow::Chat& chat) {
+    return std::make_shared<Contact>(chat.chatName.empty() ? chat.jid.toString() : chat.chatName, chat.jid, chat.statusType, chat.avatarPath);
+}
+
 ChatsManager::SingleChatWindowFactoryAdapter::SingleChatWindowFactoryAdapter(ChatWindow* chatWindow) : chatWindow_(chatWindow) {}
 ChatsManager::SingleChatWindowFactoryAdapter::~SingleChatWindowFactoryAdapter() {}
 ChatWindow* ChatsManager::SingleChatWindowFactoryAdapter::createChatWindow(const JID &, UIEventStream*) {
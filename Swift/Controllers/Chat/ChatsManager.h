@@ -71,6 +71,7 @@ namespace Swift {
             void handleIncomingMessage(std::shared_ptr<Message> incomingMessage);
             std::vector<ChatListWindow::Chat> getRecentChats() const;
             virtual std::vector<Contact::ref> getContacts(bool withMUCNicks);
+            virtual std::vector<Contact::ref> getContactsWithJID(const JID& jid);
 
             boost::signals2::signal<void (bool supportsImpromptu)> onImpromptuMUCServiceDiscovered;
 
@@ -94,6 +95,9 @@ namespace Swift {
             void handleMUCSelectedAfterSearch(const JID&);
             void rebindControllerJID(const JID& from, const JID& to);
             void handlePresenceChange(std::shared_ptr<Presence> newPresence);
+            void handleMUCOccupantPresenceChange(std::shared_ptr<Presence> presence);
+            void handleRecentChanged(const ChatListWindow::Chat& chat);
+            static Contact::ref createContact(const ChatListWindow::Chat& chat);
             void handleUIEvent(std::shared_ptr<UIEvent> event);
             void handleMUCBookmarkAdded(const MUCBookmark& bookmark);
             void handleMUCBookmarkRemoved(const MUCBookmark& bookmark);
@@ -141,6 +145,8 @@ namespace Swift {
 
         private:
             std::map<JID, MUCController*> mucControllers_;
+            // Statuses of the occupants of joined MUCs, as suggested by getContacts()
+            std::map<JID, StatusShow::Type> mucOccupantStatuses_;
             std::map<JID, ChatController*> chatControllers_;
             std::map<ChatControllerBase*, SingleChatWindowFactoryAdapter*> chatWindowFactoryAdapters_;
             EventController* eventController_;
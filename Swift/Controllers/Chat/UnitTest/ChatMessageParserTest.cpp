@@ -290,3 +290,16 @@ TEST_F(ChatMessageParserTest, testWithDefaultConfiguration) {
     ASSERT_EQ(HighlightAction(), result.getHighlightActionGroupMessage());
     ASSERT_EQ(HighlightAction(), result.getHighlightActionSender());
 }
+
+TEST_F(ChatMessageParserTest, testKeywordsChangedAfterConstruction) {
+    auto config = highlightConfigFromKeyword("one", false);
+    auto testling = ChatMessageParser(emoticons_, config);
+    auto result = testling.parseMessageBody("one two");
+    assertHighlight(result, 0, "one", config->keywordHighlights[0].action);
+    assertText(result, 1, " two");
+
+    config->keywordHighlights[0].keyword = "two";
+    result = testling.parseMessageBody("one two");
+    assertText(result, 0, "one ");
+    assertHighlight(result, 1, "two", config->keywordHighlights[0].action);
+}
@@ -4,12 +4,28 @@
  * See Documentation/Licenses/BSD-simplified.txt for more information.
  */
 
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
 #include <Swift/Controllers/ContactProvider.h>
 
+#include <algorithm>
+
 namespace Swift {
 
 ContactProvider::~ContactProvider() {
 
 }
 
+std::vector<Contact::ref> ContactProvider::getContactsWithJID(const JID& jid) {
+    std::vector<Contact::ref> contacts = getContacts(false);
+    contacts.erase(std::remove_if(contacts.begin(), contacts.end(), [&](const Contact::ref& contact) {
+        return !contact->jid.isValid() || contact->jid.toBare() != jid;
+    }), contacts.end());
+    return contacts;
+}
+
 }
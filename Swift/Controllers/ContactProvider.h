@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (c) 2014 Isode Limited.
+ * Copyright (c) 2014-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -14,6 +14,8 @@
 
 #include <vector>
 
+#include <boost/signals2.hpp>
+
 #include <Swift/Controllers/Contact.h>
 
 namespace Swift {
@@ -22,6 +24,31 @@ class ContactProvider {
     public:
         virtual ~ContactProvider();
         virtual std::vector<Contact::ref> getContacts(bool withMUCNicks) = 0;
+
+        /**
+         * Returns the contacts with the given bare JID. MUC nicks are never
+         * returned, as they have no JID.
+         *
+         * The default implementation filters the result of getContacts().
+         */
+        virtual std::vector<Contact::ref> getContactsWithJID(const JID& jid);
+
+        /**
+         * Emitted when the result of getContacts() may have changed.
+         */
+        boost::signals2::signal<void ()> onContactsChanged;
+
+        /**
+         * Emitted when only the contacts with the given bare JID may have
+         * changed.
+         */
+        boost::signals2::signal<void (const JID&)> onContactChanged;
+
+        /**
+         * Emitted when only the MUC nicks returned by getContacts() may have
+         * changed.
+         */
+        boost::signals2::signal<void ()> onMUCNicksChanged;
 };
 
 }
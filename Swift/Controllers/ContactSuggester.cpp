@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (c) 2014-2016 Isode Limited.
+ * Copyright (c) 2014-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -13,24 +13,45 @@
 #include <Swift/Controllers/ContactSuggester.h>
 
 #include <algorithm>
-#include <set>
+#include <cctype>
 #include <vector>
 
 #include <boost/algorithm/string.hpp>
-#include <boost/algorithm/string/find.hpp>
 #include <boost/bind.hpp>
-#include <boost/lambda/bind.hpp>
-#include <boost/lambda/lambda.hpp>
 
 #include <Swiften/Base/Algorithm.h>
 #include <Swiften/JID/JID.h>
 
 #include <Swift/Controllers/ContactProvider.h>
 
-namespace lambda = boost::lambda;
-
 namespace Swift {
 
+namespace {
+    char toLower(char c) {
+        return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+
+    std::uint64_t getCharacters(const std::string& lowerText) {
+        std::uint64_t characters = 0;
+        for (char c : lowerText) {
+            characters |= std::uint64_t(1) << (static_cast<unsigned char>(c) % 64);
+        }
+        return characters;
+    }
+
+    bool fuzzyMatchLowercase(const std::string& lowerText, const std::string& lowerMatch) {
+        size_t lastMatch = 0;
+        for (char c : lowerMatch) {
+            size_t where = lowerText.find(c, lastMatch);
+            if (where == std::string::npos) {
+                return false;
+            }
+            lastMatch = where + 1;
+        }
+        return true;
+    }
+}
+
 ContactSuggester::ContactSuggester() {
 }
 
@@ -39,6 +60,27 @@ ContactSuggester::~ContactSuggester() {
 
 void ContactSuggester::addContactProvider(ContactProvider* provider) {
     contactProviders_.push_back(provider);
+    contactProviderConnections_.push_back(provider->onContactsChanged.connect(boost::bind(&ContactSuggester::handleContactsChanged, this)));
+    contactProviderConnections_.push_back(provider->onContactChanged.connect(boost::bind(&ContactSuggester::handleContactChanged, this, _1)));
+    contactProviderConnections_.push_back(provider->onMUCNicksChanged.connect(boost::bind(&ContactSuggester::handleMUCNicksChanged, this)));
+    handleContactsChanged();
+}
+
+void ContactSuggester::handleContactsChanged() {
+    indexWithMUCNicks_.dirty = true;
+    indexWithoutMUCNicks_.dirty = true;
+}
+
+void ContactSuggester::handleContactChanged(const JID& jid) {
+    for (Index* index : {&indexWithMUCNicks_, &indexWithoutMUCNicks_}) {
+        if (!index->dirty) {
+            index->changedJIDs.insert(jid.toBare());
+        }
+    }
+}
+
+void ContactSuggester::handleMUCNicksChanged() {
+    indexWithMUCNicks_.dirty = true;
 }
 
 bool ContactSuggester::matchContact(const std::string& search, const Contact::ref& c) {
@@ -51,34 +93,143 @@ bool ContactSuggester::matchContact(const std::string& search, const Contact::re
     return false;
 }
 
+void ContactSuggester::rebuildIndex(Index& index, bool withMUCNicks) const {
+    std::vector<Contact::ref> contacts;
+    for (auto provider : contactProviders_) {
+        append(contacts, provider->getContacts(withMUCNicks));
+    }
+    std::sort(contacts.begin(), contacts.end(), Contact::lexicographicalSortPredicate);
+    contacts.erase(std::unique(contacts.begin(), contacts.end(), Contact::equalityPredicate), contacts.end());
+
+    index.entries.clear();
+    index.entries.reserve(contacts.size());
+    for (const auto& contact : contacts) {
+        index.entries.push_back(createIndexEntry(contact));
+    }
+    std::stable_sort(index.entries.begin(), index.entries.end(), isRankedBefore);
+
+    index.changedJIDs.clear();
+    index.lastSearch.clear();
+    index.lastMatches.clear();
+    index.dirty = false;
+}
+
+void ContactSuggester::updateIndex(Index& index) const {
+    for (const auto& jid : index.changedJIDs) {
+        index.entries.erase(std::remove_if(index.entries.begin(), index.entries.end(), [&](const IndexEntry& entry) {
+            return entry.contact->jid.isValid() && entry.contact->jid.toBare() == jid;
+        }), index.entries.end());
+
+        std::vector<Contact::ref> contacts;
+        for (auto provider : contactProviders_) {
+            append(contacts, provider->getContactsWithJID(jid));
+        }
+        std::sort(contacts.begin(), contacts.end(), Contact::lexicographicalSortPredicate);
+        contacts.erase(std::unique(contacts.begin(), contacts.end(), Contact::equalityPredicate), contacts.end());
+
+        // Keep the entries sorted by status and name
+        for (const auto& contact : contacts) {
+            IndexEntry entry = createIndexEntry(contact);
+            auto position = std::upper_bound(index.entries.begin(), index.entries.end(), entry, isRankedBefore);
+            index.entries.insert(position, entry);
+        }
+    }
+
+    index.changedJIDs.clear();
+    index.lastSearch.clear();
+    index.lastMatches.clear();
+}
+
+// Same order as Contact::sortPredicate for contacts that match the search equally well
+bool ContactSuggester::isRankedBefore(const IndexEntry& a, const IndexEntry& b) {
+    if (a.contact->statusType == b.contact->statusType) {
+        return a.lowerName.compare(b.lowerName) < 0;
+    }
+    return a.contact->statusType < b.contact->statusType;
+}
+
+ContactSuggester::IndexEntry ContactSuggester::createIndexEntry(const Contact::ref& contact) {
+    IndexEntry entry;
+    entry.contact = contact;
+    entry.lowerName = boost::algorithm::to_lower_copy(contact->name);
+    if (contact->jid.isValid()) {
+        entry.lowerJID = boost::algorithm::to_lower_copy(contact->jid.toString());
+    }
+    entry.characters = getCharacters(entry.lowerName) | getCharacters(entry.lowerJID);
+    return entry;
+}
+
 std::vector<Contact::ref> ContactSuggester::getSuggestions(const std::string& search, bool withMUCNicks) const {
-    std::vector<Contact::ref> results;
+    Index& index = withMUCNicks ? indexWithMUCNicks_ : indexWithoutMUCNicks_;
+    bool narrowing = !index.dirty && index.changedJIDs.empty() && !index.lastSearch.empty();
+    if (index.dirty) {
+        rebuildIndex(index, withMUCNicks);
+    }
+    else if (!index.changedJIDs.empty()) {
+        updateIndex(index);
+    }
 
-    for (auto provider : contactProviders_) {
-        append(results, provider->getContacts(withMUCNicks));
+    std::string lowerSearch = boost::algorithm::to_lower_copy(search);
+    std::uint64_t searchCharacters = getCharacters(lowerSearch);
+    narrowing = narrowing && boost::algorithm::starts_with(lowerSearch, index.lastSearch);
+
+    // A contact matching a search also matches all prefixes of that search,
+    // so a longer search only needs to look at the previous matches.
+    std::vector<size_t> matches;
+    auto matchEntry = [&](size_t i) {
+        const IndexEntry& entry = index.entries[i];
+        if ((entry.characters & searchCharacters) == searchCharacters && (fuzzyMatchLowercase(entry.lowerName, lowerSearch) || fuzzyMatchLowercase(entry.lowerJID, lowerSearch))) {
+            matches.push_back(i);
+        }
+    };
+    if (narrowing) {
+        for (size_t i : index.lastMatches) {
+            matchEntry(i);
+        }
+    }
+    else {
+        for (size_t i = 0; i < index.entries.size(); ++i) {
+            matchEntry(i);
+        }
     }
 
-    std::sort(results.begin(), results.end(), Contact::lexicographicalSortPredicate);
-    results.erase(std::unique(results.begin(), results.end(), Contact::equalityPredicate), results.end());
-    results.erase(std::remove_if(results.begin(), results.end(), !lambda::bind(&matchContact, search, lambda::_1)),
-        results.end());
-    std::sort(results.begin(), results.end(), boost::bind(&Contact::sortPredicate, _1, _2, search));
+    // Names starting with the search come first, then names containing it
+    std::vector<Contact::ref> results;
+    results.reserve(matches.size());
+    std::vector<Contact::ref> containing;
+    std::vector<Contact::ref> others;
+    for (size_t i : matches) {
+        const IndexEntry& entry = index.entries[i];
+        size_t position = entry.lowerName.find(lowerSearch);
+        if (position == 0) {
+            results.push_back(entry.contact);
+        }
+        else if (position != std::string::npos) {
+            containing.push_back(entry.contact);
+        }
+        else {
+            others.push_back(entry.contact);
+        }
+    }
+    append(results, containing);
+    append(results, others);
 
+    index.lastSearch = lowerSearch;
+    index.lastMatches.swap(matches);
     return results;
 }
 
-bool ContactSuggester::fuzzyMatch(std::string text, std::string match) {
-    std::string lowerText = text;
-    boost::algorithm::to_lower(lowerText);
-    std::string lowerMatch = match;
-    boost::algorithm::to_lower(lowerMatch);
+bool ContactSuggester::fuzzyMatch(const std::string& text, const std::string& match) {
     size_t lastMatch = 0;
-    for (char i : lowerMatch) {
-        size_t where = lowerText.find_first_of(i, lastMatch);
-        if (where == std::string::npos) {
+    for (char c : match) {
+        char lowerC = toLower(c);
+        while (lastMatch < text.size() && toLower(text[lastMatch]) != lowerC) {
+            ++lastMatch;
+        }
+        if (lastMatch == text.size()) {
             return false;
         }
-        lastMatch = where + 1;
+        ++lastMatch;
     }
     return true;
 }
@@ -5,16 +5,22 @@
  */
 
 /*
- * Copyright (c) 2014 Isode Limited.
+ * Copyright (c) 2014-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <cstdint>
+#include <set>
 #include <string>
 #include <vector>
 
+#include <boost/signals2.hpp>
+
+#include <Swiften/JID/JID.h>
+
 #include <Swift/Controllers/Contact.h>
 
 class ContactSuggesterTest;
@@ -22,6 +28,15 @@ class ContactSuggesterTest;
 namespace Swift {
     class ContactProvider;
 
+    /**
+     * Suggests contacts from a number of contact providers.
+     *
+     * The contacts are kept in an index with lowercased keys, which is only
+     * rebuilt when a provider reports that its contacts changed. When a
+     * provider reports that a single contact changed, only the entries of that
+     * contact are updated. When a search extends the previous search, only
+     * the previous results are matched again.
+     */
     class ContactSuggester {
     public:
         ContactSuggester();
@@ -35,9 +50,41 @@ namespace Swift {
         /**
          * Performs fuzzy matching on the string text. Matches when each character of match string is present in sequence in text string.
          */
-        static bool fuzzyMatch(std::string text, std::string match);
+        static bool fuzzyMatch(const std::string& text, const std::string& match);
+
+    private:
+        struct IndexEntry {
+            Contact::ref contact;
+            std::string lowerName;
+            std::string lowerJID;
+            // Bit set of the characters occurring in the name and JID
+            std::uint64_t characters;
+        };
+
+        struct Index {
+            Index() : dirty(true) {}
+
+            bool dirty;
+            // Sorted by status and name, the order of equally relevant suggestions
+            std::vector<IndexEntry> entries;
+            // Bare JIDs of the contacts to update before the next search
+            std::set<JID> changedJIDs;
+            std::string lastSearch;
+            std::vector<size_t> lastMatches;
+        };
+
+        void handleContactsChanged();
+        void handleContactChanged(const JID& jid);
+        void handleMUCNicksChanged();
+        void rebuildIndex(Index& index, bool withMUCNicks) const;
+        void updateIndex(Index& index) const;
+        static IndexEntry createIndexEntry(const Contact::ref& contact);
+        static bool isRankedBefore(const IndexEntry& a, const IndexEntry& b);
 
     private:
         std::vector<ContactProvider*> contactProviders_;
+        std::vector<boost::signals2::scoped_connection> contactProviderConnections_;
+        mutable Index indexWithMUCNicks_;
+        mutable Index indexWithoutMUCNicks_;
     };
 }
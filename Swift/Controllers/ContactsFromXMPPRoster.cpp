@@ -5,13 +5,15 @@
  */
 
 /*
- * Copyright (c) 2014-2016 Isode Limited.
+ * Copyright (c) 2014-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swift/Controllers/ContactsFromXMPPRoster.h>
 
+#include <boost/bind.hpp>
+
 #include <Swiften/Avatars/AvatarManager.h>
 #include <Swiften/Presence/PresenceOracle.h>
 #include <Swiften/Roster/XMPPRoster.h>
@@ -20,6 +22,12 @@
 namespace Swift {
 
 ContactsFromXMPPRoster::ContactsFromXMPPRoster(XMPPRoster* roster, AvatarManager* avatarManager, PresenceOracle* presenceOracle) : roster_(roster), avatarManager_(avatarManager), presenceOracle_(presenceOracle) {
+    connections_.push_back(roster_->onJIDAdded.connect(boost::bind(&ContactsFromXMPPRoster::handleContactChanged, this, _1)));
+    connections_.push_back(roster_->onJIDRemoved.connect([this](const JID& jid) { onContactChanged(jid.toBare()); }));
+    connections_.push_back(roster_->onJIDUpdated.connect(boost::bind(&ContactsFromXMPPRoster::handleContactChanged, this, _1)));
+    connections_.push_back(roster_->onRosterCleared.connect([this]() { onContactsChanged(); }));
+    connections_.push_back(presenceOracle_->onPresenceChange.connect([this](Presence::ref presence) { handleContactChanged(presence->getFrom()); }));
+    connections_.push_back(avatarManager_->onAvatarChanged.connect(boost::bind(&ContactsFromXMPPRoster::handleContactChanged, this, _1)));
 }
 
 ContactsFromXMPPRoster::~ContactsFromXMPPRoster() {
@@ -29,12 +37,30 @@ std::vector<Contact::ref> ContactsFromXMPPRoster::getContacts(bool /*withMUCNick
     std::vector<Contact::ref> results;
     std::vector<XMPPRosterItem> rosterItems = roster_->getItems();
     for (const auto& rosterItem : rosterItems) {
-        Contact::ref contact = std::make_shared<Contact>(rosterItem.getName().empty() ? rosterItem.getJID().toString() : rosterItem.getName(), rosterItem.getJID(), StatusShow::None,"");
-        contact->statusType = presenceOracle_->getAccountPresence(contact->jid) ? presenceOracle_->getAccountPresence(contact->jid)->getShow() : StatusShow::None;
-        contact->avatarPath = avatarManager_->getAvatarPath(contact->jid);
-        results.push_back(contact);
+        results.push_back(createContact(rosterItem.getJID(), rosterItem.getName()));
+    }
+    return results;
+}
+
+std::vector<Contact::ref> ContactsFromXMPPRoster::getContactsWithJID(const JID& jid) {
+    std::vector<Contact::ref> results;
+    if (roster_->containsJID(jid)) {
+        results.push_back(createContact(jid, roster_->getNameForJID(jid)));
     }
     return results;
 }
 
+Contact::ref ContactsFromXMPPRoster::createContact(const JID& jid, const std::string& name) const {
+    Contact::ref contact = std::make_shared<Contact>(name.empty() ? jid.toString() : name, jid, StatusShow::None,"");
+    contact->statusType = presenceOracle_->getAccountPresence(contact->jid) ? presenceOracle_->getAccountPresence(contact->jid)->getShow() : StatusShow::None;
+    contact->avatarPath = avatarManager_->getAvatarPath(contact->jid);
+    return contact;
+}
+
+void ContactsFromXMPPRoster::handleContactChanged(const JID& jid) {
+    if (roster_->containsJID(jid.toBare())) {
+        onContactChanged(jid.toBare());
+    }
+}
+
 }
@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (c) 2014 Isode Limited.
+ * Copyright (c) 2014-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -26,10 +26,17 @@ class ContactsFromXMPPRoster : public ContactProvider {
         virtual ~ContactsFromXMPPRoster();
 
         virtual std::vector<Contact::ref> getContacts(bool withMUCNicks);
+        virtual std::vector<Contact::ref> getContactsWithJID(const JID& jid);
+
+    private:
+        Contact::ref createContact(const JID& jid, const std::string& name) const;
+        void handleContactChanged(const JID& jid);
+
     private:
         XMPPRoster* roster_;
         AvatarManager* avatarManager_;
         PresenceOracle* presenceOracle_;
+        std::vector<boost::signals2::scoped_connection> connections_;
 };
 
 }
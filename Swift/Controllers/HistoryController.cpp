@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (c) 2014-2015 Isode Limited.
+ * Copyright (c) 2014-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -13,18 +13,31 @@
 
 #include <Swift/Controllers/HistoryController.h>
 
+#include <boost/bind.hpp>
 #include <boost/date_time/c_local_time_adjustor.hpp>
 
+#include <Swiften/EventLoop/EventLoop.h>
+#include <Swiften/EventLoop/EventOwner.h>
 #include <Swiften/History/HistoryMessage.h>
 #include <Swiften/History/HistoryStorage.h>
 #include <Swiften/JID/JID.h>
 
 namespace Swift {
 
-HistoryController::HistoryController(HistoryStorage* localHistoryStorage) : localHistory_(localHistoryStorage) {
+HistoryController::HistoryController(HistoryStorage* localHistoryStorage, EventLoop* eventLoop) : localHistory_(localHistoryStorage), eventLoop_(eventLoop), eventOwner_(std::make_shared<EventOwner>()), nextRequestID_(0), stopping_(false) {
+    thread_ = new std::thread(boost::bind(&HistoryController::run, this));
 }
 
 HistoryController::~HistoryController() {
+    {
+        std::lock_guard<std::mutex> lock(pageRequestsMutex_);
+        stopping_ = true;
+        pageRequests_.clear();
+    }
+    pageRequestsCondition_.notify_all();
+    thread_->join();
+    delete thread_;
+    eventLoop_->removeEventsFromOwner(eventOwner_);
 }
 
 void HistoryController::addMessage(const std::string& message, const JID& fromJID, const JID& toJID, HistoryMessage::Type type, const boost::posix_time::ptime& timeStamp) {
@@ -59,8 +72,75 @@ ContactsMap HistoryController::getContacts(const JID& selfJID, HistoryMessage::T
     return localHistory_->getContacts(selfJID, type, keyword);
 }
 
+std::vector<HistorySearchResult> HistoryController::searchMessages(const JID& selfJID, HistoryMessage::Type type, const std::string& keyword, size_t offset, size_t limit) const {
+    return localHistory_->searchMessages(selfJID, type, keyword, offset, limit);
+}
+
 boost::posix_time::ptime HistoryController::getLastTimeStampFromMUC(const JID& selfJID, const JID& mucJID) {
     return localHistory_->getLastTimeStampFromMUC(selfJID, mucJID);
 }
 
+int HistoryController::requestMessagesAfter(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, const boost::optional<long long>& afterMessageID, size_t pageSize) {
+    return addPageRequest(boost::bind(&HistoryStorage::getMessagesAfter, localHistory_, selfJID, contactJID, type, date, afterMessageID, pageSize));
+}
+
+int HistoryController::requestMessagesBefore(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, const boost::optional<long long>& beforeMessageID, size_t pageSize) {
+    return addPageRequest(boost::bind(&HistoryStorage::getMessagesBefore, localHistory_, selfJID, contactJID, type, date, beforeMessageID, pageSize));
+}
+
+int HistoryController::requestMessagesFromPreviousDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, size_t pageSize) {
+    return addPageRequest(boost::bind(&HistoryController::getMessagePageFromAdjacentDate, this, selfJID, contactJID, type, date, true, pageSize));
+}
+
+int HistoryController::requestMessagesFromNextDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, size_t pageSize) {
+    return addPageRequest(boost::bind(&HistoryController::getMessagePageFromAdjacentDate, this, selfJID, contactJID, type, date, false, pageSize));
+}
+
+HistoryMessagePage HistoryController::getMessagePageFromAdjacentDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, bool reverseOrder, size_t pageSize) const {
+    boost::gregorian::date adjacentDate = localHistory_->getNextDateWithLogs(selfJID, contactJID, type, date, reverseOrder);
+    if (adjacentDate.is_not_a_date()) {
+        HistoryMessagePage page;
+        page.date = adjacentDate;
+        return page;
+    }
+    if (reverseOrder) {
+        return localHistory_->getMessagesBefore(selfJID, contactJID, type, adjacentDate, boost::optional<long long>(), pageSize);
+    }
+    return localHistory_->getMessagesAfter(selfJID, contactJID, type, adjacentDate, boost::optional<long long>(), pageSize);
+}
+
+int HistoryController::addPageRequest(PageQuery query) {
+    int requestID;
+    {
+        std::lock_guard<std::mutex> lock(pageRequestsMutex_);
+        requestID = nextRequestID_++;
+        pageRequests_.push_back(std::make_pair(requestID, query));
+    }
+    pageRequestsCondition_.notify_one();
+    return requestID;
+}
+
+void HistoryController::run() {
+    while (true) {
+        std::pair<int, PageQuery> request;
+        {
+            std::unique_lock<std::mutex> lock(pageRequestsMutex_);
+            while (!stopping_ && pageRequests_.empty()) {
+                pageRequestsCondition_.wait(lock);
+            }
+            if (stopping_) {
+                return;
+            }
+            request = pageRequests_.front();
+            pageRequests_.pop_front();
+        }
+        HistoryMessagePage page = request.second();
+        eventLoop_->postEvent(boost::bind(&HistoryController::handleMessagePageLoaded, this, request.first, page), eventOwner_);
+    }
+}
+
+void HistoryController::handleMessagePageLoaded(int requestID, const HistoryMessagePage& page) {
+    onMessagePageLoaded(requestID, page);
+}
+
 }
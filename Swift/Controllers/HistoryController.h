@@ -5,16 +5,24 @@
  */
 
 /*
- * Copyright (c) 2015-2016 Isode Limited.
+ * Copyright (c) 2015-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/function.hpp>
+#include <boost/optional.hpp>
 #include <boost/signals2.hpp>
 
 #include <Swiften/History/HistoryMessage.h>
@@ -22,10 +30,12 @@
 
 namespace Swift {
     class JID;
+    class EventLoop;
+    class EventOwner;
 
     class HistoryController {
         public:
-            HistoryController(HistoryStorage* localHistoryStorage);
+            HistoryController(HistoryStorage* localHistoryStorage, EventLoop* eventLoop);
             ~HistoryController();
 
             void addMessage(const std::string& message, const JID& fromJID, const JID& toJID, HistoryMessage::Type type, const boost::posix_time::ptime& timeStamp);
@@ -33,13 +43,46 @@ namespace Swift {
             std::vector<HistoryMessage> getMessagesFromPreviousDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const;
             std::vector<HistoryMessage> getMessagesFromNextDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const;
             ContactsMap getContacts(const JID& selfJID, HistoryMessage::Type type, const std::string& keyword = std::string()) const;
+            std::vector<HistorySearchResult> searchMessages(const JID& selfJID, HistoryMessage::Type type, const std::string& keyword, size_t offset, size_t limit) const;
             std::vector<HistoryMessage> getMUCContext(const JID& selfJID, const JID& mucJID, const boost::posix_time::ptime& timeStamp) const;
 
             boost::posix_time::ptime getLastTimeStampFromMUC(const JID& selfJID, const JID& mucJID);
 
+            /**
+             * Loads a page of messages on a background thread. Returns the
+             * ID of the request, with which onMessagePageLoaded is emitted
+             * once the page is loaded.
+             */
+            int requestMessagesAfter(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, const boost::optional<long long>& afterMessageID, size_t pageSize);
+            int requestMessagesBefore(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, const boost::optional<long long>& beforeMessageID, size_t pageSize);
+
+            /**
+             * Loads the last page of messages of the previous date with
+             * messages, and the first page of the next date with messages.
+             */
+            int requestMessagesFromPreviousDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, size_t pageSize);
+            int requestMessagesFromNextDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, size_t pageSize);
+
             boost::signals2::signal<void (const HistoryMessage&)> onNewMessage;
+            boost::signals2::signal<void (int, const HistoryMessagePage&)> onMessagePageLoaded;
+
+        private:
+            typedef boost::function<HistoryMessagePage ()> PageQuery;
+
+            int addPageRequest(PageQuery query);
+            void run();
+            void handleMessagePageLoaded(int requestID, const HistoryMessagePage& page);
+            HistoryMessagePage getMessagePageFromAdjacentDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, bool reverseOrder, size_t pageSize) const;
 
         private:
             HistoryStorage* localHistory_;
+            EventLoop* eventLoop_;
+            std::shared_ptr<EventOwner> eventOwner_;
+            int nextRequestID_;
+            std::deque<std::pair<int, PageQuery> > pageRequests_;
+            std::mutex pageRequestsMutex_;
+            std::condition_variable pageRequestsCondition_;
+            bool stopping_;
+            std::thread* thread_;
     };
 }
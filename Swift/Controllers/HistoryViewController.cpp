@@ -5,13 +5,16 @@
  */
 
 /*
- * Copyright (c) 2013-2016 Isode Limited.
+ * Copyright (c) 2013-2017 Isode Limited.
  * Licensed under the GNU General Public License.
  * See the COPYING file for more information.
  */
 
 #include <Swift/Controllers/HistoryViewController.h>
 
+#include <locale>
+
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/range/adaptor/reversed.hpp>
 
 #include <Swiften/Avatars/AvatarManager.h>
@@ -27,6 +30,17 @@
 
 namespace Swift {
     static const std::string category[] = { "Contacts", "MUC", "Contacts" };
+    static const size_t messagePageSize = 100;
+
+    // Only the position of a page is kept to request the pages next to it
+    static HistoryMessagePage getPagePosition(const HistoryMessagePage& page) {
+        HistoryMessagePage position;
+        position.date = page.date;
+        position.firstMessageID = page.firstMessageID;
+        position.lastMessageID = page.lastMessageID;
+        position.hasMore = page.hasMore;
+        return position;
+    }
 
 HistoryViewController::HistoryViewController(
         const JID& selfJID,
@@ -62,6 +76,7 @@ HistoryViewController::~HistoryViewController() {
         historyWindow_->onNextButtonClicked.disconnect(boost::bind(&HistoryViewController::handleNextButtonClicked, this));
         historyWindow_->onCalendarClicked.disconnect(boost::bind(&HistoryViewController::handleCalendarClicked, this, _1));
         historyController_->onNewMessage.disconnect(boost::bind(&HistoryViewController::handleNewMessage, this, _1));
+        historyController_->onMessagePageLoaded.disconnect(boost::bind(&HistoryViewController::handleMessagePageLoaded, this, _1, _2));
 
         presenceOracle_->onPresenceChange.disconnect(boost::bind(&HistoryViewController::handlePresenceChanged, this, _1));
         avatarManager_->onAvatarChanged.disconnect(boost::bind(&HistoryViewController::handleAvatarChanged, this, _1));
@@ -84,6 +99,7 @@ void HistoryViewController::handleUIEvent(std::shared_ptr<UIEvent> rawEvent) {
             historyWindow_->onNextButtonClicked.connect(boost::bind(&HistoryViewController::handleNextButtonClicked, this));
             historyWindow_->onCalendarClicked.connect(boost::bind(&HistoryViewController::handleCalendarClicked, this, _1));
             historyController_->onNewMessage.connect(boost::bind(&HistoryViewController::handleNewMessage, this, _1));
+            historyController_->onMessagePageLoaded.connect(boost::bind(&HistoryViewController::handleMessagePageLoaded, this, _1, _2));
 
             presenceOracle_->onPresenceChange.connect(boost::bind(&HistoryViewController::handlePresenceChanged, this, _1));
             avatarManager_->onAvatarChanged.connect(boost::bind(&HistoryViewController::handleAvatarChanged, this, _1));
@@ -112,22 +128,16 @@ void HistoryViewController::handleSelectedContactChanged(RosterItem* newContact)
 
     JID contactJID = contact->getJID();
 
-    std::vector<HistoryMessage> messages;
     for (int it = HistoryMessage::Chat; it <= HistoryMessage::PrivateMessage; it++) {
         HistoryMessage::Type type = static_cast<HistoryMessage::Type>(it);
 
         if (contacts_[type].count(contactJID)) {
             currentResultDate_ = *contacts_[type][contactJID].rbegin();
             selectedItemType_ = type;
-            messages = historyController_->getMessagesFromDate(selfJID_, contactJID, type, currentResultDate_);
         }
     }
 
-    historyWindow_->setDate(currentResultDate_);
-
-    for (const auto& message : messages) {
-        addNewMessage(message, false);
-    }
+    loadMessagesFromDate(currentResultDate_);
 }
 
 void HistoryViewController::handleNewMessage(const HistoryMessage& message) {
@@ -141,15 +151,18 @@ void HistoryViewController::handleNewMessage(const HistoryMessage& message) {
         displayJID = contactJID.toBare();
     }
 
-    // check current conversation
-    if (selectedItem_ && selectedItem_->getJID() == displayJID) {
+    // check current conversation, unless the message will be part of the
+    // pages still being loaded, or of the rest of the day that is loaded
+    // when scrolling down
+    if (selectedItem_ && selectedItem_->getJID() == displayJID && !bottomPageRequest_ && !bottomPage_) {
         if (historyWindow_->getLastVisibleDate() == message.getTime().date()) {
             addNewMessage(message, false);
         }
     }
 
-    // check if the new message matches the query
-    if (message.getMessage().find(historyWindow_->getSearchBoxText()) == std::string::npos) {
+    // check if the new message matches the query, the way the history
+    // storage matches it (case insensitive for ASCII only, like SQL LIKE)
+    if (!boost::algorithm::icontains(message.getMessage(), historyWindow_->getSearchBoxText(), std::locale::classic())) {
         return;
     }
 
@@ -202,12 +215,15 @@ void HistoryViewController::handleScrollReachedTop(const boost::gregorian::date&
         return;
     }
 
-    std::vector<HistoryMessage> messages = historyController_->getMessagesFromPreviousDate(selfJID_, selectedItem_->getJID(), selectedItemType_, date);
-
-    for (const auto& message : messages) {
-        addNewMessage(message, true);
+    if (topPageRequest_) {
+        return;
+    }
+    if (topPage_) {
+        topPageRequest_ = historyController_->requestMessagesBefore(selfJID_, selectedItem_->getJID(), selectedItemType_, topPage_->date, topPage_->firstMessageID, messagePageSize);
+    }
+    else {
+        topPageRequest_ = historyController_->requestMessagesFromPreviousDate(selfJID_, selectedItem_->getJID(), selectedItemType_, date, messagePageSize);
     }
-    historyWindow_->resetConversationViewTopInsertPoint();
 }
 
 void HistoryViewController::handleScrollReachedBottom(const boost::gregorian::date& date) {
@@ -215,10 +231,14 @@ void HistoryViewController::handleScrollReachedBottom(const boost::gregorian::da
         return;
     }
 
-    std::vector<HistoryMessage> messages = historyController_->getMessagesFromNextDate(selfJID_, selectedItem_->getJID(), selectedItemType_, date);
-
-    for (const auto& message : messages) {
-        addNewMessage(message, false);
+    if (bottomPageRequest_) {
+        return;
+    }
+    if (bottomPage_) {
+        bottomPageRequest_ = historyController_->requestMessagesAfter(selfJID_, selectedItem_->getJID(), selectedItemType_, bottomPage_->date, bottomPage_->lastMessageID, messagePageSize);
+    }
+    else {
+        bottomPageRequest_ = historyController_->requestMessagesFromNextDate(selfJID_, selectedItem_->getJID(), selectedItemType_, date, messagePageSize);
     }
 }
 
@@ -233,14 +253,8 @@ void HistoryViewController::handleNextButtonClicked() {
         return;
     }
 
-    historyWindow_->resetConversationView();
     currentResultDate_ = *(++date);
-    std::vector<HistoryMessage> messages = historyController_->getMessagesFromDate(selfJID_, selectedItem_->getJID(), selectedItemType_, currentResultDate_);
-    historyWindow_->setDate(currentResultDate_);
-
-    for (const auto& message : messages) {
-        addNewMessage(message, false);
-    }
+    loadMessagesFromDate(currentResultDate_);
 }
 
 void HistoryViewController::handlePreviousButtonClicked() {
@@ -254,14 +268,8 @@ void HistoryViewController::handlePreviousButtonClicked() {
         return;
     }
 
-    historyWindow_->resetConversationView();
     currentResultDate_ = *(--date);
-    std::vector<HistoryMessage> messages = historyController_->getMessagesFromDate(selfJID_, selectedItem_->getJID(), selectedItemType_, currentResultDate_);
-    historyWindow_->setDate(currentResultDate_);
-
-    for (const auto& message : messages) {
-        addNewMessage(message, false);
-    }
+    loadMessagesFromDate(currentResultDate_);
 }
 
 void HistoryViewController::reset() {
@@ -269,6 +277,49 @@ void HistoryViewController::reset() {
     contacts_.clear();
     selectedItem_ = nullptr;
     historyWindow_->resetConversationView();
+    cancelMessagePageRequests();
+}
+
+void HistoryViewController::loadMessagesFromDate(const boost::gregorian::date& date) {
+    historyWindow_->resetConversationView();
+    historyWindow_->setDate(date);
+    cancelMessagePageRequests();
+    if (selectedItem_) {
+        bottomPageRequest_ = historyController_->requestMessagesAfter(selfJID_, selectedItem_->getJID(), selectedItemType_, date, boost::optional<long long>(), messagePageSize);
+    }
+}
+
+void HistoryViewController::cancelMessagePageRequests() {
+    // Pages of requests that are already queued are ignored when they arrive
+    topPageRequest_ = boost::none;
+    bottomPageRequest_ = boost::none;
+    topPage_ = boost::none;
+    bottomPage_ = boost::none;
+}
+
+void HistoryViewController::handleMessagePageLoaded(int requestID, const HistoryMessagePage& page) {
+    if (!selectedItem_) {
+        return;
+    }
+
+    // Older pages are added above the messages that are already shown, and
+    // newer pages below them. The rest of a day is only loaded once the view
+    // is scrolled to its top or bottom again.
+    if (topPageRequest_ && *topPageRequest_ == requestID) {
+        for (const auto& message : page.messages) {
+            addNewMessage(message, true);
+        }
+        historyWindow_->resetConversationViewTopInsertPoint();
+        topPageRequest_ = boost::none;
+        topPage_ = page.hasMore ? getPagePosition(page) : boost::optional<HistoryMessagePage>();
+    }
+    else if (bottomPageRequest_ && *bottomPageRequest_ == requestID) {
+        for (const auto& message : page.messages) {
+            addNewMessage(message, false);
+        }
+        bottomPageRequest_ = boost::none;
+        bottomPage_ = page.hasMore ? getPagePosition(page) : boost::optional<HistoryMessagePage>();
+    }
 }
 
 void HistoryViewController::handleCalendarClicked(const boost::gregorian::date& date) {
@@ -302,14 +353,7 @@ void HistoryViewController::handleCalendarClicked(const boost::gregorian::date&
         return;
     }
     currentResultDate_ = newDate;
-    historyWindow_->resetConversationView();
-
-    std::vector<HistoryMessage> messages = historyController_->getMessagesFromDate(selfJID_, selectedItem_->getJID(), selectedItemType_, currentResultDate_);
-    historyWindow_->setDate(currentResultDate_);
-
-    for (const auto& message : messages) {
-        addNewMessage(message, false);
-    }
+    loadMessagesFromDate(currentResultDate_);
 }
 
 void HistoryViewController::handlePresenceChanged(Presence::ref presence) {
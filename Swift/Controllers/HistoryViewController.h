@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (c) 2016 Isode Limited.
+ * Copyright (c) 2016-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -16,6 +16,7 @@
 #include <set>
 
 #include <boost/bind.hpp>
+#include <boost/optional.hpp>
 #include <boost/signals2.hpp>
 
 #include <Swiften/History/HistoryStorage.h>
@@ -51,8 +52,11 @@ namespace Swift {
             void handleCalendarClicked(const boost::gregorian::date& date);
             void handlePresenceChanged(Presence::ref presence);
             void handleAvatarChanged(const JID& jid);
+            void handleMessagePageLoaded(int requestID, const HistoryMessagePage& page);
 
             void addNewMessage(const HistoryMessage& message, bool addAtTheTop);
+            void loadMessagesFromDate(const boost::gregorian::date& date);
+            void cancelMessagePageRequests();
             void reset();
             Presence::ref getPresence(const JID& jid, bool isMUC);
 
@@ -71,5 +75,16 @@ namespace Swift {
             ContactRosterItem* selectedItem_;
             HistoryMessage::Type selectedItemType_ = HistoryMessage::Chat;
             boost::gregorian::date currentResultDate_;
+
+            // Requests for the pages being added at the top and at the
+            // bottom of the conversation view
+            boost::optional<int> topPageRequest_;
+            boost::optional<int> bottomPageRequest_;
+
+            // The pages at the top and at the bottom of the conversation
+            // view, if there are more messages on their date, which are
+            // loaded when scrolling past them
+            boost::optional<HistoryMessagePage> topPage_;
+            boost::optional<HistoryMessagePage> bottomPage_;
     };
 }
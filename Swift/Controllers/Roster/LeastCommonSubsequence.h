@@ -1,11 +1,13 @@
 /*
- * Copyright (c) 2011-2016 Isode Limited.
+ * Copyright (c) 2011-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <cassert>
+#include <cstddef>
 #include <vector>
 
 #include <boost/numeric/conversion/cast.hpp>
@@ -36,6 +38,127 @@ namespace Swift {
                 }
             }
         }
+
+        /**
+         * Computes the longest common subsequence of two ranges with Myers'
+         * O((N+M)D) algorithm, using the linear space refinement (recursing
+         * on the middle snake).
+         *
+         * The result maps every index of the first range to the index of the
+         * matching element in the second range, or to -1 if the element
+         * is not part of the common subsequence.
+         */
+        template<typename It, typename Predicate>
+        class MyersDiff {
+            public:
+                MyersDiff(It xBegin, size_t xLength, It yBegin, size_t yLength) : xBegin_(xBegin), yBegin_(yBegin), matches_(xLength, -1) {
+                    size_t maxD = (xLength + yLength + 1) / 2 + 1;
+                    forward_.resize(2 * maxD + 1);
+                    backward_.resize(2 * maxD + 1);
+                    compare(0, static_cast<std::ptrdiff_t>(xLength), 0, static_cast<std::ptrdiff_t>(yLength));
+                }
+
+                const std::vector<std::ptrdiff_t>& getMatches() const {
+                    return matches_;
+                }
+
+            private:
+                bool equals(std::ptrdiff_t i, std::ptrdiff_t j) const {
+                    return predicate_(*(xBegin_ + i), *(yBegin_ + j));
+                }
+
+                void compare(std::ptrdiff_t xStart, std::ptrdiff_t xEnd, std::ptrdiff_t yStart, std::ptrdiff_t yEnd) {
+                    while (xStart < xEnd && yStart < yEnd && equals(xStart, yStart)) {
+                        matches_[static_cast<size_t>(xStart++)] = yStart++;
+                    }
+                    while (xStart < xEnd && yStart < yEnd && equals(xEnd - 1, yEnd - 1)) {
+                        matches_[static_cast<size_t>(--xEnd)] = --yEnd;
+                    }
+                    if (xStart == xEnd || yStart == yEnd) {
+                        return;
+                    }
+
+                    std::ptrdiff_t snakeXStart, snakeYStart, snakeXEnd, snakeYEnd;
+                    std::ptrdiff_t d = findMiddleSnake(xStart, xEnd, yStart, yEnd, snakeXStart, snakeYStart, snakeXEnd, snakeYEnd);
+                    for (std::ptrdiff_t k = 0; k < snakeXEnd - snakeXStart; ++k) {
+                        matches_[static_cast<size_t>(snakeXStart + k)] = snakeYStart + k;
+                    }
+                    if (d > 1) {
+                        compare(xStart, snakeXStart, yStart, snakeYStart);
+                        compare(snakeXEnd, xEnd, snakeYEnd, yEnd);
+                    }
+                    // A single edit is fully covered by the trimmed prefix and
+                    // suffix, and the snake.
+                }
+
+                /**
+                 * Searches forward from the start and backward from the end
+                 * until both searches overlap, and returns the length of the
+                 * shortest edit script. The coordinates of the snake where
+                 * they overlap are returned through the output parameters.
+                 */
+                std::ptrdiff_t findMiddleSnake(std::ptrdiff_t xStart, std::ptrdiff_t xEnd, std::ptrdiff_t yStart, std::ptrdiff_t yEnd, std::ptrdiff_t& snakeXStart, std::ptrdiff_t& snakeYStart, std::ptrdiff_t& snakeXEnd, std::ptrdiff_t& snakeYEnd) {
+                    std::ptrdiff_t n = xEnd - xStart;
+                    std::ptrdiff_t m = yEnd - yStart;
+                    std::ptrdiff_t delta = n - m;
+                    bool odd = (delta % 2) != 0;
+                    std::ptrdiff_t maxD = (n + m + 1) / 2;
+
+                    // Furthest reaching x (relative to the start of the range,
+                    // or to the end for the backward search) per diagonal
+                    std::ptrdiff_t* forward = &forward_[static_cast<size_t>(maxD) + 1];
+                    std::ptrdiff_t* backward = &backward_[static_cast<size_t>(maxD) + 1];
+                    forward[1] = 0;
+                    backward[1] = 0;
+
+                    for (std::ptrdiff_t d = 0; d <= maxD; ++d) {
+                        for (std::ptrdiff_t k = -d; k <= d; k += 2) {
+                            std::ptrdiff_t x = (k == -d || (k != d && forward[k-1] < forward[k+1])) ? forward[k+1] : forward[k-1] + 1;
+                            std::ptrdiff_t y = x - k;
+                            std::ptrdiff_t startX = x;
+                            while (x < n && y < m && equals(xStart + x, yStart + y)) {
+                                ++x;
+                                ++y;
+                            }
+                            forward[k] = x;
+                            if (odd && k >= delta - (d - 1) && k <= delta + (d - 1) && x + backward[delta - k] >= n) {
+                                snakeXStart = xStart + startX;
+                                snakeYStart = yStart + startX - k;
+                                snakeXEnd = xStart + x;
+                                snakeYEnd = yStart + y;
+                                return 2 * d - 1;
+                            }
+                        }
+                        for (std::ptrdiff_t k = -d; k <= d; k += 2) {
+                            std::ptrdiff_t x = (k == -d || (k != d && backward[k-1] < backward[k+1])) ? backward[k+1] : backward[k-1] + 1;
+                            std::ptrdiff_t y = x - k;
+                            std::ptrdiff_t startX = x;
+                            while (x < n && y < m && equals(xEnd - x - 1, yEnd - y - 1)) {
+                                ++x;
+                                ++y;
+                            }
+                            backward[k] = x;
+                            if (!odd && delta - k >= -d && delta - k <= d && x + forward[delta - k] >= n) {
+                                snakeXStart = xEnd - x;
+                                snakeYStart = yEnd - y;
+                                snakeXEnd = xEnd - startX;
+                                snakeYEnd = yEnd - (startX - k);
+                                return 2 * d;
+                            }
+                        }
+                    }
+                    assert(false);
+                    return n + m;
+                }
+
+            private:
+                It xBegin_;
+                It yBegin_;
+                Predicate predicate_;
+                std::vector<std::ptrdiff_t> matches_;
+                std::vector<std::ptrdiff_t> forward_;
+                std::vector<std::ptrdiff_t> backward_;
+        };
     }
 
     template<typename X, typename InsertRemovePredicate, typename UpdatePredicate>
@@ -68,41 +191,34 @@ namespace Swift {
             ++yEnd;
         }
 
-        // Compute lengths
+        // Compute the shortest edit script between the remaining ranges
         size_t xLength = static_cast<size_t>(std::distance(xBegin, xEnd.base()));
         size_t yLength = static_cast<size_t>(std::distance(yBegin, yEnd.base()));
+        Detail::MyersDiff<typename std::vector<X>::const_iterator, InsertRemovePredicate> diff(xBegin, xLength, yBegin, yLength);
+        const std::vector<std::ptrdiff_t>& matches = diff.getMatches();
 
-        // Compute LCS matrix
-        std::vector<unsigned int> lcs;
-        Detail::computeLeastCommonSubsequenceMatrix<typename std::vector<X>::const_iterator, typename std::vector<X>::const_iterator, unsigned int, InsertRemovePredicate>(xBegin, xEnd.base(), yBegin, yEnd.base(), lcs);
-
-        // Process LCS matrix
-        size_t i = xLength;
+        // Report the result from the back, like the common suffix
         size_t j = yLength;
-        size_t width = xLength + 1;
-        while (true) {
-            if (i > 0 && j > 0 && insertRemovePredicate(x[prefixLength + i-1], y[prefixLength + j-1])) {
-                // x[i-1] same
-                if (updatePredicate(x[prefixLength + i - 1], y[prefixLength + j - 1])) {
-                    updates.push_back(prefixLength + i-1);
-                    postUpdates.push_back(prefixLength + j-1);
-                }
-                i -= 1;
-                j -= 1;
+        for (size_t i = xLength; i > 0; --i) {
+            if (matches[i-1] < 0) {
+                // x[i-1] removed
+                removes.push_back(prefixLength + i-1);
+                continue;
             }
-            else if (j > 0 && (i == 0 || lcs[i + (j-1)*width] >= lcs[i-1 + j*width])) {
+            size_t matchedJ = static_cast<size_t>(matches[i-1]);
+            for (; j > matchedJ + 1; --j) {
                 // y[j-1] added
                 inserts.push_back(prefixLength + j-1);
-                j -= 1;
             }
-            else if (i > 0 && (j == 0 || lcs[i + (j-1)*width] < lcs[i-1 + j*width])) {
-                // x[i-1] removed
-                removes.push_back(prefixLength + i-1);
-                i -= 1;
-            }
-            else {
-                break;
+            j = matchedJ;
+            if (updatePredicate(x[prefixLength + i-1], y[prefixLength + matchedJ])) {
+                updates.push_back(prefixLength + i-1);
+                postUpdates.push_back(prefixLength + matchedJ);
             }
         }
+        for (; j > 0; --j) {
+            // y[j-1] added
+            inserts.push_back(prefixLength + j-1);
+        }
     }
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2016 Isode Limited.
+ * Copyright (c) 2011-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -31,6 +31,13 @@ struct IsXOrY {
     }
 };
 
+struct IsEven {
+    bool operator()(int i, int i2) const {
+        CPPUNIT_ASSERT_EQUAL(i, i2);
+        return i % 2 == 0;
+    }
+};
+
 struct IsArizonaOrNewJersey {
     bool operator()(const std::string& s, const std::string& s2) const {
         CPPUNIT_ASSERT_EQUAL(s, s2);
@@ -55,6 +62,8 @@ class LeastCommonSubsequenceTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testComputeIndexDiff_NoCommonSequence);
         CPPUNIT_TEST(testComputeIndexDiff_SameSequences);
         CPPUNIT_TEST(testComputeIndexDiff_CommonPrefixAndSuffix);
+        CPPUNIT_TEST(testComputeIndexDiff_MultipleSnakes);
+        CPPUNIT_TEST(testComputeIndexDiff_LargeSequencesWithFewChanges);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -306,6 +315,50 @@ class LeastCommonSubsequenceTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(expectedRemoves, removes);
             CPPUNIT_ASSERT_EQUAL(expectedInserts, inserts);
         }
+
+        void testComputeIndexDiff_MultipleSnakes() {
+            std::vector<char> x = boost::assign::list_of('a')('b')('c')('a')('b')('b')('a');
+            std::vector<char> y = boost::assign::list_of('c')('b')('a')('b')('a')('c');
+
+            std::vector<size_t> updates;
+            std::vector<size_t> postUpdates;
+            std::vector<size_t> removes;
+            std::vector<size_t> inserts;
+            computeIndexDiff<char, std::equal_to<char>, IsBOrC >(x, y, updates, postUpdates, removes, inserts);
+
+            std::vector<size_t> expectedUpdates = boost::assign::list_of(4)(1);
+            std::vector<size_t> expectedPostUpdates = boost::assign::list_of(3)(1);
+            std::vector<size_t> expectedRemoves = boost::assign::list_of(5)(2)(0);
+            std::vector<size_t> expectedInserts = boost::assign::list_of(5)(0);
+            CPPUNIT_ASSERT_EQUAL(expectedUpdates, updates);
+            CPPUNIT_ASSERT_EQUAL(expectedPostUpdates, postUpdates);
+            CPPUNIT_ASSERT_EQUAL(expectedRemoves, removes);
+            CPPUNIT_ASSERT_EQUAL(expectedInserts, inserts);
+        }
+
+        void testComputeIndexDiff_LargeSequencesWithFewChanges() {
+            std::vector<int> x;
+            for (int i = 0; i < 10000; ++i) {
+                x.push_back(2*i + 1);
+            }
+            std::vector<int> y(x);
+            y.erase(y.begin() + 7000);
+            y.erase(y.begin() + 5000);
+            y.insert(y.begin() + 100, 2);
+
+            std::vector<size_t> updates;
+            std::vector<size_t> postUpdates;
+            std::vector<size_t> removes;
+            std::vector<size_t> inserts;
+            computeIndexDiff<int, std::equal_to<int>, IsEven >(x, y, updates, postUpdates, removes, inserts);
+
+            std::vector<size_t> expectedRemoves = boost::assign::list_of(7000)(5000);
+            std::vector<size_t> expectedInserts = boost::assign::list_of(100);
+            CPPUNIT_ASSERT(updates.empty());
+            CPPUNIT_ASSERT(postUpdates.empty());
+            CPPUNIT_ASSERT_EQUAL(expectedRemoves, removes);
+            CPPUNIT_ASSERT_EQUAL(expectedInserts, inserts);
+        }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(LeastCommonSubsequenceTest);
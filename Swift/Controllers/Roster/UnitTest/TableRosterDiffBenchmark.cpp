@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <Swift/Controllers/Roster/LeastCommonSubsequence.h>
+#include <Swift/Controllers/Roster/TableRoster.h>
+
+using namespace Swift;
+
+/*
+ * Measures how long computing the diff between two versions of a large
+ * roster section takes, for a number of typical roster changes.
+ */
+
+namespace {
+    struct ItemEquals {
+        bool operator()(const TableRoster::Item& i1, const TableRoster::Item& i2) const {
+            return i1.jid == i2.jid;
+        }
+    };
+
+    struct ItemNeedsUpdate {
+        bool operator()(const TableRoster::Item& i1, const TableRoster::Item& i2) const {
+            return i1.status != i2.status || i1.description != i2.description || i1.name != i2.name || i1.avatarPath.empty() != i2.avatarPath.empty();
+        }
+    };
+
+    std::vector<TableRoster::Item> createRoster(int size) {
+        std::vector<TableRoster::Item> items;
+        for (int i = 0; i < size; ++i) {
+            std::string name = "contact" + std::to_string(i);
+            items.push_back(TableRoster::Item(name, "", JID(name + "@example.com"), StatusShow::Online, ""));
+        }
+        return items;
+    }
+
+    void benchmark(const std::string& description, const std::vector<TableRoster::Item>& oldItems, const std::vector<TableRoster::Item>& newItems) {
+        std::vector<size_t> updates;
+        std::vector<size_t> postUpdates;
+        std::vector<size_t> removes;
+        std::vector<size_t> inserts;
+        auto start = std::chrono::steady_clock::now();
+        computeIndexDiff<TableRoster::Item, ItemEquals, ItemNeedsUpdate>(oldItems, newItems, updates, postUpdates, removes, inserts);
+        auto end = std::chrono::steady_clock::now();
+        std::cout << description << ": " << std::chrono::duration<double, std::milli>(end - start).count() << "ms ";
+        std::cout << "(" << updates.size() << " updates, " << removes.size() << " removes, " << inserts.size() << " inserts)" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int size = 10000;
+    int changes = 100;
+    if (argc > 1) {
+        size = std::atoi(argv[1]);
+    }
+    if (argc > 2) {
+        changes = std::atoi(argv[2]);
+    }
+    if (size <= 0 || changes < 0 || changes > size) {
+        std::cerr << "Usage: " << argv[0] << " [roster size] [changes]" << std::endl;
+        return -1;
+    }
+
+    std::mt19937 random(0);
+    std::vector<TableRoster::Item> roster = createRoster(size);
+
+    benchmark("Unchanged", roster, roster);
+
+    std::vector<TableRoster::Item> statusChanges(roster);
+    for (int i = 0; i < changes; ++i) {
+        statusChanges[random() % statusChanges.size()].status = StatusShow::Away;
+    }
+    benchmark("Status changes", roster, statusChanges);
+
+    std::vector<TableRoster::Item> moves(roster);
+    for (int i = 0; i < changes; ++i) {
+        size_t from = random() % moves.size();
+        TableRoster::Item item = moves[from];
+        moves.erase(moves.begin() + static_cast<long>(from));
+        moves.insert(moves.begin() + static_cast<long>(random() % moves.size()), item);
+    }
+    benchmark("Moved contacts", roster, moves);
+
+    std::vector<TableRoster::Item> signOns(roster.begin() + size / 2, roster.end());
+    std::vector<TableRoster::Item> added = createRoster(size + size / 2);
+    signOns.insert(signOns.begin(), added.begin() + size, added.end());
+    benchmark("Replaced half of the roster", roster, signOns);
+
+    benchmark("Emptied roster", roster, std::vector<TableRoster::Item>());
+    return 0;
+}
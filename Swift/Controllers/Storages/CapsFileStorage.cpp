@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -20,13 +20,16 @@ CapsFileStorage::CapsFileStorage(const boost::filesystem::path& path) : path(pat
 }
 
 DiscoInfo::ref CapsFileStorage::getDiscoInfo(const std::string& hash) const {
-    return DiscoInfoPersister().loadPayloadGeneric(getCapsPath(hash));
+    return *cache.get(hash, [this](const std::string& hash) {
+        return boost::optional<DiscoInfo::ref>(DiscoInfoPersister().loadPayloadGeneric(getCapsPath(hash)));
+    });
 }
 
 void CapsFileStorage::setDiscoInfo(const std::string& hash, DiscoInfo::ref discoInfo) {
     DiscoInfo::ref bareDiscoInfo(new DiscoInfo(*discoInfo.get()));
     bareDiscoInfo->setNode("");
     DiscoInfoPersister().savePayload(bareDiscoInfo, getCapsPath(hash));
+    cache.insert(hash, bareDiscoInfo);
 }
 
 boost::filesystem::path CapsFileStorage::getCapsPath(const std::string& hash) const {
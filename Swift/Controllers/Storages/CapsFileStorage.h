@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -10,6 +10,7 @@
 
 #include <boost/filesystem/path.hpp>
 
+#include <Swiften/Base/LRUCache.h>
 #include <Swiften/Disco/CapsStorage.h>
 
 namespace Swift {
@@ -25,5 +26,8 @@ namespace Swift {
 
         private:
             boost::filesystem::path path;
+            // Parsed disco#info of the most recently used hashes, including
+            // a null payload for hashes without a file.
+            mutable LRUCache<std::string, DiscoInfo::ref, 1000> cache;
     };
 }
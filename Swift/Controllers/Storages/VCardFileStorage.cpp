@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -53,7 +53,9 @@ VCardFileStorage::VCardFileStorage(boost::filesystem::path dir, CryptoProvider*
 }
 
 std::shared_ptr<VCard> VCardFileStorage::getVCard(const JID& jid) const {
-    std::shared_ptr<VCard> result = VCardPersister().loadPayloadGeneric(getVCardPath(jid));
+    std::shared_ptr<VCard> result = *vcards.get(jid.toString(), [this, &jid](const std::string&) {
+        return boost::optional<VCard::ref>(VCardPersister().loadPayloadGeneric(getVCardPath(jid)));
+    });
     getAndUpdatePhotoHash(jid, result);
     return result;
 }
@@ -70,6 +72,7 @@ boost::posix_time::ptime VCardFileStorage::getVCardWriteTime(const JID& jid) con
 void VCardFileStorage::setVCard(const JID& jid, VCard::ref v) {
     vcardWriteTimes[jid] = boost::posix_time::second_clock::universal_time();
     VCardPersister().savePayload(v, getVCardPath(jid));
+    vcards.insert(jid.toString(), v);
     getAndUpdatePhotoHash(jid, v);
 }
 
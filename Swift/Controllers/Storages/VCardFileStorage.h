@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -12,6 +12,7 @@
 
 #include <boost/filesystem/path.hpp>
 
+#include <Swiften/Base/LRUCache.h>
 #include <Swiften/VCards/VCardStorage.h>
 
 namespace Swift {
@@ -40,5 +41,8 @@ namespace Swift {
             typedef std::map<JID, std::string> PhotoHashMap;
             mutable PhotoHashMap photoHashes;
             std::map<JID, boost::posix_time::ptime> vcardWriteTimes;
+            // Parsed vCards of the most recently used JIDs, including a null
+            // payload for JIDs without a file.
+            mutable LRUCache<std::string, VCard::ref, 1000> vcards;
     };
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014-2016 Isode Limited.
+ * Copyright (c) 2014-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -12,15 +12,46 @@
 #include <cppunit/extensions/HelperMacros.h>
 #include <cppunit/extensions/TestFactoryRegistry.h>
 
+#include <Swift/Controllers/ContactProvider.h>
 #include <Swift/Controllers/ContactSuggester.h>
 
 using namespace Swift;
 
+namespace {
+    class DummyContactProvider : public ContactProvider {
+        public:
+            virtual std::vector<Contact::ref> getContacts(bool /*withMUCNicks*/) {
+                ++getContactsCount;
+                return contacts;
+            }
+
+            virtual std::vector<Contact::ref> getContactsWithJID(const JID& jid) {
+                std::vector<Contact::ref> result;
+                for (const auto& contact : contacts) {
+                    if (contact->jid.toBare() == jid) {
+                        result.push_back(contact);
+                    }
+                }
+                return result;
+            }
+
+            std::vector<Contact::ref> contacts;
+            int getContactsCount = 0;
+    };
+}
+
 class ContactSuggesterTest : public CppUnit::TestFixture {
     CPPUNIT_TEST_SUITE(ContactSuggesterTest);
     CPPUNIT_TEST(equalityTest);
     CPPUNIT_TEST(lexicographicalSortTest);
     CPPUNIT_TEST(sortTest);
+    CPPUNIT_TEST(testGetSuggestions);
+    CPPUNIT_TEST(testGetSuggestions_RemovesDuplicates);
+    CPPUNIT_TEST(testGetSuggestions_ExtendedSearch);
+    CPPUNIT_TEST(testGetSuggestions_ContactsChanged);
+    CPPUNIT_TEST(testGetSuggestions_ContactChanged);
+    CPPUNIT_TEST(testGetSuggestions_MUCNicksChanged);
+    CPPUNIT_TEST(testFuzzyMatch);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -123,6 +154,118 @@ public:
         }
     }
 
+    void testGetSuggestions() {
+        DummyContactProvider provider;
+        provider.contacts.push_back(std::make_shared<Contact>("Alice", JID("alice@wonderland.lit"), StatusShow::Away, ""));
+        provider.contacts.push_back(std::make_shared<Contact>("Mad Hatter", JID("hatter@tea.party"), StatusShow::Online, ""));
+        provider.contacts.push_back(std::make_shared<Contact>("Queen", JID("alicia@wonderland.lit"), StatusShow::Online, ""));
+        provider.contacts.push_back(std::make_shared<Contact>("Malice", JID("malice@wonderland.lit"), StatusShow::Online, ""));
+        ContactSuggester testling;
+        testling.addContactProvider(&provider);
+
+        std::vector<Contact::ref> suggestions = testling.getSuggestions("ALI", false);
+
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), suggestions.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("Alice"), suggestions[0]->name);
+        CPPUNIT_ASSERT_EQUAL(std::string("Malice"), suggestions[1]->name);
+        CPPUNIT_ASSERT_EQUAL(std::string("Queen"), suggestions[2]->name);
+    }
+
+    void testGetSuggestions_RemovesDuplicates() {
+        DummyContactProvider provider1;
+        provider1.contacts.push_back(std::make_shared<Contact>("Alice", JID("alice@wonderland.lit"), StatusShow::Online, ""));
+        DummyContactProvider provider2;
+        provider2.contacts.push_back(std::make_shared<Contact>("Alice", JID("alice@wonderland.lit"), StatusShow::Online, ""));
+        provider2.contacts.push_back(std::make_shared<Contact>("Alice Liddell", JID(), StatusShow::Online, ""));
+        ContactSuggester testling;
+        testling.addContactProvider(&provider1);
+        testling.addContactProvider(&provider2);
+
+        std::vector<Contact::ref> suggestions = testling.getSuggestions("alice", false);
+
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), suggestions.size());
+    }
+
+    void testGetSuggestions_ExtendedSearch() {
+        DummyContactProvider provider;
+        provider.contacts.push_back(std::make_shared<Contact>("Alice", JID("alice@wonderland.lit"), StatusShow::Online, ""));
+        provider.contacts.push_back(std::make_shared<Contact>("Mad Hatter", JID("hatter@tea.party"), StatusShow::Online, ""));
+        ContactSuggester testling;
+        testling.addContactProvider(&provider);
+
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), testling.getSuggestions("a", false).size());
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), testling.getSuggestions("al", false).size());
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), testling.getSuggestions("alx", false).size());
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), testling.getSuggestions("hat", false).size());
+        CPPUNIT_ASSERT_EQUAL(1, provider.getContactsCount);
+    }
+
+    void testGetSuggestions_ContactsChanged() {
+        DummyContactProvider provider;
+        provider.contacts.push_back(std::make_shared<Contact>("Alice", JID("alice@tea.party"), StatusShow::Online, ""));
+        ContactSuggester testling;
+        testling.addContactProvider(&provider);
+        testling.getSuggestions("al", false);
+
+        provider.contacts.push_back(std::make_shared<Contact>("Alan", JID("alan@wonderland.lit"), StatusShow::Online, ""));
+        provider.onContactsChanged();
+        std::vector<Contact::ref> suggestions = testling.getSuggestions("alan", false);
+
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), suggestions.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("Alan"), suggestions[0]->name);
+        CPPUNIT_ASSERT_EQUAL(2, provider.getContactsCount);
+    }
+
+    void testGetSuggestions_ContactChanged() {
+        DummyContactProvider provider;
+        provider.contacts.push_back(std::make_shared<Contact>("Alice", JID("alice@wonderland.lit"), StatusShow::Online, ""));
+        provider.contacts.push_back(std::make_shared<Contact>("Mad Hatter", JID("hatter@tea.party"), StatusShow::Online, ""));
+        ContactSuggester testling;
+        testling.addContactProvider(&provider);
+        testling.getSuggestions("a", false);
+
+        provider.contacts[0]->statusType = StatusShow::Away;
+        provider.onContactChanged(JID("alice@wonderland.lit/rabbithole"));
+        provider.contacts.push_back(std::make_shared<Contact>("Alan", JID("alan@wonderland.lit"), StatusShow::Online, ""));
+        provider.onContactChanged(JID("alan@wonderland.lit"));
+        std::vector<Contact::ref> suggestions = testling.getSuggestions("a", false);
+
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), suggestions.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("Alan"), suggestions[0]->name);
+        CPPUNIT_ASSERT_EQUAL(std::string("Alice"), suggestions[1]->name);
+        CPPUNIT_ASSERT_EQUAL(std::string("Mad Hatter"), suggestions[2]->name);
+
+        provider.contacts.pop_back();
+        provider.onContactChanged(JID("alan@wonderland.lit"));
+        suggestions = testling.getSuggestions("a", false);
+
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), suggestions.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("Alice"), suggestions[0]->name);
+        CPPUNIT_ASSERT_EQUAL(1, provider.getContactsCount);
+    }
+
+    void testGetSuggestions_MUCNicksChanged() {
+        DummyContactProvider provider;
+        provider.contacts.push_back(std::make_shared<Contact>("Alice", JID("alice@wonderland.lit"), StatusShow::Online, ""));
+        ContactSuggester testling;
+        testling.addContactProvider(&provider);
+        testling.getSuggestions("a", false);
+        testling.getSuggestions("a", true);
+
+        provider.onMUCNicksChanged();
+        testling.getSuggestions("a", false);
+        testling.getSuggestions("a", true);
+
+        CPPUNIT_ASSERT_EQUAL(3, provider.getContactsCount);
+    }
+
+    void testFuzzyMatch() {
+        CPPUNIT_ASSERT(ContactSuggester::fuzzyMatch("Mad Hatter", "mhr"));
+        CPPUNIT_ASSERT(ContactSuggester::fuzzyMatch("Mad Hatter", ""));
+        CPPUNIT_ASSERT(!ContactSuggester::fuzzyMatch("Mad Hatter", "rhm"));
+        CPPUNIT_ASSERT(!ContactSuggester::fuzzyMatch("Mad", "Madd"));
+    }
+
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(ContactSuggesterTest);
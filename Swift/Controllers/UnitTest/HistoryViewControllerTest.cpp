@@ -0,0 +1,355 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Avatars/NullAvatarManager.h>
+#include <Swiften/Client/DummyStanzaChannel.h>
+#include <Swiften/Client/NickResolver.h>
+#include <Swiften/EventLoop/DummyEventLoop.h>
+#include <Swiften/History/HistoryStorage.h>
+#include <Swiften/MUC/MUCRegistry.h>
+#include <Swiften/Presence/PresenceOracle.h>
+#include <Swiften/Roster/XMPPRosterImpl.h>
+
+#include <Swift/Controllers/HistoryController.h>
+#include <Swift/Controllers/HistoryViewController.h>
+#include <Swift/Controllers/Roster/ContactRosterItem.h>
+#include <Swift/Controllers/UIEvents/RequestHistoryUIEvent.h>
+#include <Swift/Controllers/UIEvents/UIEventStream.h>
+#include <Swift/Controllers/UIInterfaces/HistoryWindow.h>
+#include <Swift/Controllers/UIInterfaces/HistoryWindowFactory.h>
+
+using namespace Swift;
+
+namespace {
+    class MockHistoryWindow : public HistoryWindow {
+        public:
+            virtual void activate() {}
+            virtual void setRosterModel(Roster*) {}
+            virtual void addMessage(const std::string& message, const std::string&, bool, const std::string&, const boost::posix_time::ptime&, bool addAtTheTop) {
+                if (addAtTheTop) {
+                    messages.insert(messages.begin(), message);
+                }
+                else {
+                    messages.push_back(message);
+                }
+            }
+            virtual void resetConversationView() {
+                messages.clear();
+            }
+            virtual void resetConversationViewTopInsertPoint() {
+                topPagesAdded++;
+            }
+            virtual void setDate(const boost::gregorian::date&) {}
+            virtual std::string getSearchBoxText() {
+                return std::string();
+            }
+            virtual boost::gregorian::date getLastVisibleDate() {
+                return lastVisibleDate;
+            }
+
+            std::vector<std::string> messages;
+            int topPagesAdded = 0;
+            boost::gregorian::date lastVisibleDate;
+    };
+
+    // The window is deleted by the controller
+    class MockHistoryWindowFactory : public HistoryWindowFactory {
+        public:
+            virtual HistoryWindow* createHistoryWindow(UIEventStream*) {
+                window = new MockHistoryWindow();
+                return window;
+            }
+
+            MockHistoryWindow* window = nullptr;
+    };
+
+    /**
+     * Stores the messages of a single conversation on a single day, and
+     * records the pages that are requested from it.
+     */
+    class PagedHistoryStorage : public HistoryStorage {
+        public:
+            struct PageQuery {
+                bool after;
+                boost::optional<long long> messageID;
+            };
+
+            PagedHistoryStorage(const JID& contact, const boost::gregorian::date& date, size_t messageCount) : contact_(contact), date_(date), messageCount_(messageCount), adjacentDateQueries_(0) {
+            }
+
+            virtual void addMessage(const HistoryMessage&) {}
+
+            virtual std::vector<HistoryMessage> getMessagesFromDate(const JID&, const JID&, HistoryMessage::Type, const boost::gregorian::date&) const {
+                return std::vector<HistoryMessage>();
+            }
+
+            virtual std::vector<HistoryMessage> getMessagesFromNextDate(const JID&, const JID&, HistoryMessage::Type, const boost::gregorian::date&) const {
+                return std::vector<HistoryMessage>();
+            }
+
+            virtual std::vector<HistoryMessage> getMessagesFromPreviousDate(const JID&, const JID&, HistoryMessage::Type, const boost::gregorian::date&) const {
+                return std::vector<HistoryMessage>();
+            }
+
+            virtual boost::gregorian::date getNextDateWithLogs(const JID&, const JID&, HistoryMessage::Type, const boost::gregorian::date&, bool) const {
+                std::lock_guard<std::mutex> lock(mutex_);
+                adjacentDateQueries_++;
+                return boost::gregorian::date(boost::gregorian::not_a_date_time);
+            }
+
+            virtual HistoryMessagePage getMessagesAfter(const JID&, const JID&, HistoryMessage::Type, const boost::gregorian::date& date, const boost::optional<long long>& afterMessageID, size_t pageSize) const {
+                std::lock_guard<std::mutex> lock(mutex_);
+                queries_.push_back(PageQuery{true, afterMessageID});
+                long long first = afterMessageID ? *afterMessageID + 1 : 1;
+                long long last = std::min(first + static_cast<long long>(pageSize) - 1, static_cast<long long>(messageCount_));
+                return createPage(date, first, last, last < static_cast<long long>(messageCount_));
+            }
+
+            virtual HistoryMessagePage getMessagesBefore(const JID&, const JID&, HistoryMessage::Type, const boost::gregorian::date& date, const boost::optional<long long>& beforeMessageID, size_t pageSize) const {
+                std::lock_guard<std::mutex> lock(mutex_);
+                queries_.push_back(PageQuery{false, beforeMessageID});
+                long long last = beforeMessageID ? *beforeMessageID - 1 : static_cast<long long>(messageCount_);
+                long long first = std::max(last - static_cast<long long>(pageSize) + 1, 1LL);
+                return createPage(date, first, last, first > 1);
+            }
+
+            virtual ContactsMap getContacts(const JID&, HistoryMessage::Type type, const std::string&) const {
+                ContactsMap contacts;
+                if (type == HistoryMessage::Chat) {
+                    contacts[contact_].insert(date_);
+                }
+                return contacts;
+            }
+
+            virtual std::vector<HistorySearchResult> searchMessages(const JID&, HistoryMessage::Type, const std::string&, size_t, size_t) const {
+                return std::vector<HistorySearchResult>();
+            }
+
+            virtual boost::posix_time::ptime getLastTimeStampFromMUC(const JID&, const JID&) const {
+                return boost::posix_time::ptime();
+            }
+
+            std::vector<PageQuery> getQueries() const {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return queries_;
+            }
+
+            int getAdjacentDateQueries() const {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return adjacentDateQueries_;
+            }
+
+        private:
+            HistoryMessagePage createPage(const boost::gregorian::date& date, long long first, long long last, bool hasMore) const {
+                HistoryMessagePage page;
+                page.date = date;
+                for (long long id = first; id <= last; id++) {
+                    page.messages.push_back(HistoryMessage(std::to_string(id), contact_, JID("me@example.com"), HistoryMessage::Chat, boost::posix_time::ptime(date)));
+                }
+                page.firstMessageID = first;
+                page.lastMessageID = last;
+                page.hasMore = hasMore;
+                return page;
+            }
+
+        private:
+            JID contact_;
+            boost::gregorian::date date_;
+            size_t messageCount_;
+            mutable std::mutex mutex_;
+            mutable std::vector<PageQuery> queries_;
+            mutable int adjacentDateQueries_;
+    };
+}
+
+class HistoryViewControllerTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(HistoryViewControllerTest);
+        CPPUNIT_TEST(testSelectContact_LoadsFirstPageOnly);
+        CPPUNIT_TEST(testScrollReachedBottom_LoadsNextPageOfDate);
+        CPPUNIT_TEST(testScrollReachedBottom_LastPageLoadsNextDate);
+        CPPUNIT_TEST(testScrollReachedTop_LoadsPreviousDate);
+        CPPUNIT_TEST(testNewMessage_DayLoaded);
+        CPPUNIT_TEST(testNewMessage_DayPartlyLoaded);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            contact_ = JID("alice@example.com");
+            date_ = boost::gregorian::date(2017, 3, 14);
+            eventLoop_ = new DummyEventLoop();
+            uiEventStream_ = new UIEventStream();
+            historyStorage_ = new PagedHistoryStorage(contact_, date_, 250);
+            historyController_ = new HistoryController(historyStorage_, eventLoop_);
+            stanzaChannel_ = new DummyStanzaChannel();
+            xmppRoster_ = new XMPPRosterImpl();
+            mucRegistry_ = new MUCRegistry();
+            nickResolver_ = new NickResolver(JID("me@example.com"), xmppRoster_, nullptr, mucRegistry_);
+            avatarManager_ = new NullAvatarManager();
+            presenceOracle_ = new PresenceOracle(stanzaChannel_, xmppRoster_);
+            historyWindowFactory_ = new MockHistoryWindowFactory();
+            testling_ = new HistoryViewController(JID("me@example.com"), uiEventStream_, historyController_, nickResolver_, avatarManager_, presenceOracle_, historyWindowFactory_);
+            contactItem_ = new ContactRosterItem(contact_, contact_, "Alice", nullptr);
+
+            uiEventStream_->send(std::make_shared<RequestHistoryUIEvent>());
+            window_ = historyWindowFactory_->window;
+        }
+
+        void tearDown() {
+            delete testling_;
+            delete contactItem_;
+            delete historyWindowFactory_;
+            delete presenceOracle_;
+            delete avatarManager_;
+            delete nickResolver_;
+            delete mucRegistry_;
+            delete xmppRoster_;
+            delete stanzaChannel_;
+            delete historyController_;
+            delete historyStorage_;
+            delete uiEventStream_;
+            delete eventLoop_;
+        }
+
+        void testSelectContact_LoadsFirstPageOnly() {
+            window_->onSelectedContactChanged(contactItem_);
+            waitForMessageCount(100);
+
+            // Wait for a request that is queued after any eagerly requested
+            // page, so that such a page would have been queried by now
+            window_->onScrollReachedTop(date_);
+            waitForTopPages(1);
+
+            std::vector<PagedHistoryStorage::PageQuery> queries = historyStorage_->getQueries();
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), queries.size());
+            CPPUNIT_ASSERT(queries[0].after);
+            CPPUNIT_ASSERT(!queries[0].messageID);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(100), window_->messages.size());
+        }
+
+        void testScrollReachedBottom_LoadsNextPageOfDate() {
+            window_->onSelectedContactChanged(contactItem_);
+            waitForMessageCount(100);
+
+            window_->onScrollReachedBottom(date_);
+            waitForMessageCount(200);
+
+            std::vector<PagedHistoryStorage::PageQuery> queries = historyStorage_->getQueries();
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), queries.size());
+            CPPUNIT_ASSERT(queries[1].after);
+            CPPUNIT_ASSERT_EQUAL(100LL, queries[1].messageID.get_value_or(0));
+            CPPUNIT_ASSERT_EQUAL(std::string("1"), window_->messages.front());
+            CPPUNIT_ASSERT_EQUAL(std::string("200"), window_->messages.back());
+            CPPUNIT_ASSERT_EQUAL(0, historyStorage_->getAdjacentDateQueries());
+        }
+
+        void testScrollReachedBottom_LastPageLoadsNextDate() {
+            window_->onSelectedContactChanged(contactItem_);
+            waitForMessageCount(100);
+            window_->onScrollReachedBottom(date_);
+            waitForMessageCount(200);
+            window_->onScrollReachedBottom(date_);
+            waitForMessageCount(250);
+
+            window_->onScrollReachedBottom(date_);
+            waitForAdjacentDateQueries(1);
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), historyStorage_->getQueries().size());
+        }
+
+        void testScrollReachedTop_LoadsPreviousDate() {
+            window_->onSelectedContactChanged(contactItem_);
+            waitForMessageCount(100);
+
+            window_->onScrollReachedTop(date_);
+            waitForTopPages(1);
+
+            CPPUNIT_ASSERT_EQUAL(1, historyStorage_->getAdjacentDateQueries());
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(100), window_->messages.size());
+        }
+
+        void testNewMessage_DayLoaded() {
+            window_->onSelectedContactChanged(contactItem_);
+            waitForMessageCount(100);
+            window_->onScrollReachedBottom(date_);
+            waitForMessageCount(200);
+            window_->onScrollReachedBottom(date_);
+            waitForMessageCount(250);
+            window_->lastVisibleDate = date_;
+
+            historyController_->addMessage("new", contact_, JID("me@example.com"), HistoryMessage::Chat, boost::posix_time::ptime(date_, boost::posix_time::hours(12)));
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(251), window_->messages.size());
+            CPPUNIT_ASSERT_EQUAL(std::string("new"), window_->messages.back());
+        }
+
+        void testNewMessage_DayPartlyLoaded() {
+            window_->onSelectedContactChanged(contactItem_);
+            waitForMessageCount(100);
+            window_->lastVisibleDate = date_;
+
+            // The message is loaded with the rest of the day, after the
+            // messages that aren't shown yet
+            historyController_->addMessage("new", contact_, JID("me@example.com"), HistoryMessage::Chat, boost::posix_time::ptime(date_, boost::posix_time::hours(12)));
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(100), window_->messages.size());
+            CPPUNIT_ASSERT_EQUAL(std::string("100"), window_->messages.back());
+        }
+
+    private:
+        // Pages are loaded on the history controller's thread, and delivered
+        // through the event loop
+        template<typename Predicate>
+        void waitFor(Predicate predicate) {
+            for (int i = 0; i < 500 && !predicate(); i++) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                eventLoop_->processEvents();
+            }
+            CPPUNIT_ASSERT(predicate());
+        }
+
+        void waitForMessageCount(size_t count) {
+            waitFor([&]() { return window_->messages.size() == count; });
+        }
+
+        void waitForTopPages(int count) {
+            waitFor([&]() { return window_->topPagesAdded == count; });
+        }
+
+        void waitForAdjacentDateQueries(int count) {
+            waitFor([&]() { return historyStorage_->getAdjacentDateQueries() == count; });
+        }
+
+    private:
+        JID contact_;
+        boost::gregorian::date date_;
+        DummyEventLoop* eventLoop_;
+        UIEventStream* uiEventStream_;
+        PagedHistoryStorage* historyStorage_;
+        HistoryController* historyController_;
+        DummyStanzaChannel* stanzaChannel_;
+        XMPPRosterImpl* xmppRoster_;
+        MUCRegistry* mucRegistry_;
+        NickResolver* nickResolver_;
+        NullAvatarManager* avatarManager_;
+        PresenceOracle* presenceOracle_;
+        MockHistoryWindowFactory* historyWindowFactory_;
+        HistoryViewController* testling_;
+        ContactRosterItem* contactItem_;
+        MockHistoryWindow* window_;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(HistoryViewControllerTest);
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2016 Isode Limited.
+ * Copyright (c) 2015-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -170,6 +170,9 @@ std::ostream& operator<<(std::ostream& os, Swift::ClientSession::State state) {
         case CS::State::EnablingSessionManagement:
             os << "ClientSession::State::EnablingSessionManagement";
             break;
+        case CS::State::ResumingSession:
+            os << "ClientSession::State::ResumingSession";
+            break;
         case CS::State::BindingResource:
             os << "ClientSession::State::BindingResource";
             break;
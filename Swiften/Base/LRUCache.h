@@ -33,13 +33,14 @@ public:
 public:
     /**
      * Inserts the key/value pair in the front of the cache. If the \p key
-     * already exists in the cache, it is moved to the front instead. If
-     * afterwards, the cahe size exceeds the \p MAX_SIZE limit, the least
-     * recently item is removed from the cache.
+     * already exists in the cache, its value is replaced and it is moved to
+     * the front instead. If afterwards, the cahe size exceeds the
+     * \p MAX_SIZE limit, the least recently item is removed from the cache.
      */
     void insert(const KEY_TYPE& key, VALUE_TYPE value) {
         auto pushResult = cache.push_front(entry_t(key, value));
         if (!pushResult.second) {
+            cache.replace(pushResult.first, entry_t(key, value));
             cache.relocate(cache.begin(), pushResult.first);
         }
         else if (cache.size() > MAX_SIZE) {
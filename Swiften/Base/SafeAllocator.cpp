@@ -1,11 +1,13 @@
 /*
- * Copyright (c) 2013 Isode Limited.
+ * Copyright (c) 2013-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swiften/Base/SafeByteArray.h>
 
+#include <cstring>
+
 #include <Swiften/Base/Platform.h>
 #ifdef SWIFTEN_PLATFORM_WINDOWS
 #include <windows.h>
@@ -16,6 +18,11 @@ namespace Swift {
 SWIFTEN_API void secureZeroMemory(char* memory, size_t numberOfBytes) {
 #ifdef SWIFTEN_PLATFORM_WINDOWS
     SecureZeroMemory(memory, numberOfBytes);
+#elif defined(__GNUC__)
+    // Zero the memory at memset speed, and use the pointer in an empty asm block
+    // so the compiler cannot drop the stores as dead.
+    std::memset(memory, 0, numberOfBytes);
+    __asm__ __volatile__("" : : "r"(memory) : "memory");
 #else
     volatile char* p = memory;
     for (size_t i = 0; i < numberOfBytes; ++i) {
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,6 +7,7 @@
 #include <Swiften/Base/Platform.h>
 
 #include <cassert>
+#include <cstring>
 #include <algorithm>
 #include <sstream>
 #include <iomanip>
@@ -183,6 +184,33 @@ std::string String::sanitizeXMPPString(const std::string& input) {
     return result;
 }
 
+void String::sanitizeXMPPStringInPlace(std::string& s) {
+    char* output = &s[0];
+    const char* it = output;
+    const auto end = it + s.length();
+
+    std::size_t consumed;
+    bool status = UTF8_ACCEPT;
+
+    while (it < end) {
+        const auto codepoint = getNextCodepoint(it, end, consumed, status);
+        if (status) {
+            if (isValidXMPPCharacter(codepoint)) {
+                // Nothing needs to move until the first removed character
+                if (output != it) {
+                    std::memmove(output, it, consumed);
+                }
+                output += consumed;
+            }
+            it += consumed;
+        }
+        else {
+            ++it;
+        }
+    }
+    s.resize(static_cast<size_t>(output - &s[0]));
+}
+
 std::vector<std::string> String::split(const std::string& s, char c) {
     assert((c & 0x80) == 0);
     std::vector<std::string> result;
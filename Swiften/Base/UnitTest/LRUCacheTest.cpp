@@ -84,6 +84,22 @@ TEST(LRUCacheTest, testMoveRecentToFrontOnReinsert) {
     ASSERT_EQ(b::optional<std::string>("DD"), testling.get("D"));
 }
 
+TEST(LRUCacheTest, testReplaceValueOnReinsert) {
+    LRUCache<std::string, std::string, 3> testling;
+
+    testling.insert("A", "AA");
+    testling.insert("B", "BB");
+    testling.insert("C", "CC");
+
+    testling.insert("A", "A2");
+    testling.insert("D", "DD");
+
+    ASSERT_EQ(b::optional<std::string>("A2"), testling.get("A"));
+    ASSERT_EQ(b::optional<std::string>(), testling.get("B"));
+    ASSERT_EQ(b::optional<std::string>("CC"), testling.get("C"));
+    ASSERT_EQ(b::optional<std::string>("DD"), testling.get("D"));
+}
+
 TEST(LRUCacheTest, testCacheReturnsValuesPreviouslyInserted) {
     LRUCache<std::string, std::string, 3> testling;
 
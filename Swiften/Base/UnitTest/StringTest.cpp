@@ -29,6 +29,7 @@ using namespace Swift;
         CPPUNIT_TEST(testReplaceAll_MatchingReplace);
         CPPUNIT_TEST(testIsValidXMPPCharacter);
         CPPUNIT_TEST(testSanitizeXMPPString);
+        CPPUNIT_TEST(testSanitizeXMPPStringInPlace);
         CPPUNIT_TEST(testSplit);
 #ifdef SWIFTEN_PLATFORM_WINDOWS
         CPPUNIT_TEST(testConvertWStringToString);
@@ -149,6 +150,24 @@ using namespace Swift;
             }
         }
 
+        void testSanitizeXMPPStringInPlace() {
+            std::vector<std::pair<std::string, std::string>> testData = {
+                { "", "" },
+                { std::string("\0\t", 2), "\t" },
+                { std::string("\0blah\0", 6) , std::string("blah", 4) },
+                { "z\xC3\x9F\xE6\xB0\xB4\xF0\x9D\x84\x8B" , "z\xC3\x9F\xE6\xB0\xB4\xF0\x9D\x84\x8B" },
+                { "\x7FT\t\x0c\xff\xfeT", "T\tT" },
+                { "\x01Q\x0BW\x81T", "QWT" },
+                { "ABC\x01" "\xF0\x9F\x98\x83" "D\x02\x03" "\xE2\xBE\xA6" "EF", "ABC" "\xF0\x9F\x98\x83" "D" "\xE2\xBE\xA6" "EF" }
+            };
+
+            for (std::size_t i = 0; i != testData.size(); ++i) {
+                std::string actual = testData[i].first;
+                String::sanitizeXMPPStringInPlace(actual);
+                CPPUNIT_ASSERT_EQUAL_MESSAGE(boost::str(boost::format("While testing string idx=%d") % i), testData[i].second, actual);
+            }
+        }
+
         void testSplit() {
             std::vector<std::string> result = String::split("abc def ghi", ' ');
 
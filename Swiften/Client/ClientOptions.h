@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2016 Isode Limited.
+ * Copyright (c) 2011-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -56,7 +56,12 @@ namespace Swift {
         bool allowPLAINWithoutTLS = false;
 
         /**
-         * Use XEP-196 stream resumption when available.
+         * Use XEP-0198 stream resumption when available.
+         *
+         * When the connection is lost, the client reconnects and resumes the
+         * session, resending the stanzas the server did not ack, without
+         * reporting a disconnection. Only used for direct TCP connections,
+         * and when the password is not forgotten.
          *
          * Default: false
          */
@@ -78,6 +83,29 @@ namespace Swift {
          */
         bool useAcks = true;
 
+        /**
+         * Request a XEP-0198 ack after this many stanzas were sent,
+         * instead of after every message.
+         * Default: 0 (after every message)
+         */
+        unsigned int ackRequestThreshold = 0;
+
+        /**
+         * Request a XEP-0198 ack when sent stanzas have been waiting for
+         * this long without one.
+         * Default: 0 (disabled)
+         */
+        int ackRequestDelayInMilliseconds = 0;
+
+        /**
+         * The maximum number of unacked stanzas kept for resending when
+         * the session is resumed, and of stanzas queued while the session is
+         * being resumed. When there are more, the oldest ones are dropped,
+         * and reported through onStanzaDropped.
+         * Default: 0 (unbounded)
+         */
+        size_t maxUnackedStanzas = 0;
+
         /**
          * Use Single Sign On.
          * Default: false
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -37,6 +37,8 @@
 #include <Swiften/Elements/StreamFeatures.h>
 #include <Swiften/Elements/StreamManagementEnabled.h>
 #include <Swiften/Elements/StreamManagementFailed.h>
+#include <Swiften/Elements/StreamResume.h>
+#include <Swiften/Elements/StreamResumed.h>
 #include <Swiften/Elements/TLSProceed.h>
 #include <Swiften/Network/Timer.h>
 #include <Swiften/Network/TimerFactory.h>
@@ -127,6 +129,8 @@ void ClientSession::handleStreamStart(const ProtocolHeader&) {
 }
 
 void ClientSession::handleStreamEnd() {
+    // A session closed by the server cannot be resumed
+    resumptionState_.reset();
     if (state == State::Finishing) {
         // We are already in finishing state if we iniated the close of the session.
         stream->close();
@@ -310,7 +314,14 @@ void ClientSession::handleElement(std::shared_ptr<ToplevelElement> element) {
             needSessionStart = streamFeatures->hasSession();
             needResourceBind = streamFeatures->hasResourceBind();
             needAcking = streamFeatures->hasStreamManagement() && useAcks;
-            if (!needResourceBind) {
+            if (resumptionState_ && needAcking) {
+                state = State::ResumingSession;
+                std::shared_ptr<StreamResume> resume = std::make_shared<StreamResume>();
+                resume->setResumeID(resumptionState_->resumeID);
+                resume->setHandledStanzasCount(resumptionState_->stanzaAckResponder->getHandledStanzasCount());
+                stream->writeElement(resume);
+            }
+            else if (!needResourceBind) {
                 // Resource binding is a MUST
                 finishSession(Error::ResourceBindError);
             }
@@ -329,18 +340,60 @@ void ClientSession::handleElement(std::shared_ptr<ToplevelElement> element) {
     else if (std::dynamic_pointer_cast<CompressFailure>(element)) {
         finishSession(Error::CompressionFailedError);
     }
-    else if (std::dynamic_pointer_cast<StreamManagementEnabled>(element)) {
-        stanzaAckRequester_ = std::make_shared<StanzaAckRequester>();
-        stanzaAckRequester_->onRequestAck.connect(boost::bind(&ClientSession::requestAck, shared_from_this()));
-        stanzaAckRequester_->onStanzaAcked.connect(boost::bind(&ClientSession::handleStanzaAcked, shared_from_this(), _1));
-        stanzaAckResponder_ = std::make_shared<StanzaAckResponder>();
-        stanzaAckResponder_->onAck.connect(boost::bind(&ClientSession::ack, shared_from_this(), _1));
+    else if (std::shared_ptr<StreamManagementEnabled> enabled = std::dynamic_pointer_cast<StreamManagementEnabled>(element)) {
+        std::shared_ptr<StanzaAckRequester> stanzaAckRequester = std::make_shared<StanzaAckRequester>(timerFactory);
+        stanzaAckRequester->setAckRequestThreshold(ackRequestThreshold);
+        stanzaAckRequester->setAckRequestDelay(ackRequestDelayInMilliseconds);
+        stanzaAckRequester->setMaxUnackedStanzas(maxUnackedStanzas);
+        enableStreamManagement(stanzaAckRequester, std::make_shared<StanzaAckResponder>());
+        if (useStreamResumption && enabled->getResumeSupported() && !enabled->getResumeID().empty()) {
+            resumptionState_ = std::make_shared<ResumptionState>();
+            resumptionState_->resumeID = enabled->getResumeID();
+            resumptionState_->localJID = localJID;
+            resumptionState_->stanzaAckRequester = stanzaAckRequester_;
+            resumptionState_->stanzaAckResponder = stanzaAckResponder_;
+        }
         needAcking = false;
         continueSessionInitialization();
     }
     else if (std::dynamic_pointer_cast<StreamManagementFailed>(element)) {
+        if (state == State::ResumingSession) {
+            // Fall back to a new session
+            SWIFT_LOG(debug) << "Resuming the session failed" << std::endl;
+            discardResumptionState();
+            if (!needResourceBind) {
+                finishSession(Error::ResourceBindError);
+            }
+            else {
+                continueSessionInitialization();
+            }
+        }
+        else {
+            needAcking = false;
+            continueSessionInitialization();
+        }
+    }
+    else if (std::shared_ptr<StreamResumed> streamResumed = std::dynamic_pointer_cast<StreamResumed>(element)) {
+        CHECK_STATE_OR_RETURN(State::ResumingSession);
+        if (!streamResumed->getHandledStanzasCount()) {
+            finishSession(Error::UnexpectedElementError);
+            return;
+        }
+        localJID = resumptionState_->localJID;
+        enableStreamManagement(resumptionState_->stanzaAckRequester, resumptionState_->stanzaAckResponder);
+        std::vector<std::shared_ptr<Stanza> > unackedStanzas = stanzaAckRequester_->handleSessionResumed(*streamResumed->getHandledStanzasCount());
+        for (const auto& stanza : unackedStanzas) {
+            stream->writeElement(stanza);
+        }
+        if (!unackedStanzas.empty()) {
+            requestAck();
+        }
         needAcking = false;
-        continueSessionInitialization();
+        needResourceBind = false;
+        needSessionStart = false;
+        resumed = true;
+        state = State::Initialized;
+        onInitialized();
     }
     else if (AuthChallenge* challenge = dynamic_cast<AuthChallenge*>(element.get())) {
         CHECK_STATE_OR_RETURN(State::Authenticating);
@@ -403,7 +456,9 @@ void ClientSession::continueSessionInitialization() {
     }
     else if (needAcking) {
         state = State::EnablingSessionManagement;
-        stream->writeElement(std::make_shared<EnableStreamManagement>());
+        std::shared_ptr<EnableStreamManagement> enable = std::make_shared<EnableStreamManagement>();
+        enable->setResume(useStreamResumption);
+        stream->writeElement(enable);
     }
     else if (needSessionStart) {
         state = State::StartingSession;
@@ -493,6 +548,12 @@ void ClientSession::handleStreamClosed(std::shared_ptr<Swift::Error> streamError
     State previousState = state;
     state = State::Finished;
 
+    // Only keep the state of sessions that were fully up, so that a session
+    // that keeps failing to resume is not resumed over and over again
+    if (previousState != State::Initialized) {
+        discardResumptionState();
+    }
+
     if (streamShutdownTimeout) {
         streamShutdownTimeout->stop();
         streamShutdownTimeout.reset();
@@ -501,6 +562,7 @@ void ClientSession::handleStreamClosed(std::shared_ptr<Swift::Error> streamError
     if (stanzaAckRequester_) {
         stanzaAckRequester_->onRequestAck.disconnect(boost::bind(&ClientSession::requestAck, shared_from_this()));
         stanzaAckRequester_->onStanzaAcked.disconnect(boost::bind(&ClientSession::handleStanzaAcked, shared_from_this(), _1));
+        stanzaAckRequester_->onStanzaDropped.disconnect(boost::bind(&ClientSession::handleStanzaDropped, shared_from_this(), _1));
         stanzaAckRequester_.reset();
     }
     if (stanzaAckResponder_) {
@@ -540,6 +602,7 @@ void ClientSession::finishSession(Error::Type error) {
 }
 
 void ClientSession::finishSession(std::shared_ptr<Swift::Error> error) {
+    resumptionState_.reset();
     if (!error_) {
         error_ = error;
     }
@@ -569,6 +632,15 @@ void ClientSession::finishSession(std::shared_ptr<Swift::Error> error) {
     }
 }
 
+void ClientSession::enableStreamManagement(std::shared_ptr<StanzaAckRequester> stanzaAckRequester, std::shared_ptr<StanzaAckResponder> stanzaAckResponder) {
+    stanzaAckRequester_ = stanzaAckRequester;
+    stanzaAckRequester_->onRequestAck.connect(boost::bind(&ClientSession::requestAck, shared_from_this()));
+    stanzaAckRequester_->onStanzaAcked.connect(boost::bind(&ClientSession::handleStanzaAcked, shared_from_this(), _1));
+    stanzaAckRequester_->onStanzaDropped.connect(boost::bind(&ClientSession::handleStanzaDropped, shared_from_this(), _1));
+    stanzaAckResponder_ = stanzaAckResponder;
+    stanzaAckResponder_->onAck.connect(boost::bind(&ClientSession::ack, shared_from_this(), _1));
+}
+
 void ClientSession::requestAck() {
     stream->writeElement(std::make_shared<StanzaAckRequest>());
 }
@@ -577,6 +649,20 @@ void ClientSession::handleStanzaAcked(std::shared_ptr<Stanza> stanza) {
     onStanzaAcked(stanza);
 }
 
+void ClientSession::handleStanzaDropped(std::shared_ptr<Stanza> stanza) {
+    onStanzaDropped(stanza);
+}
+
+void ClientSession::discardResumptionState() {
+    // Keep the stanzas the previous session did not get acked, so that they
+    // can be reported instead of silently disappearing
+    if (resumptionState_ && resumptionState_->stanzaAckRequester && resumptionState_->stanzaAckRequester != stanzaAckRequester_) {
+        std::vector<std::shared_ptr<Stanza> > stanzas = resumptionState_->stanzaAckRequester->getUnackedStanzas();
+        unresumedStanzas_.insert(unresumedStanzas_.end(), stanzas.begin(), stanzas.end());
+    }
+    resumptionState_.reset();
+}
+
 void ClientSession::ack(unsigned int handledStanzasCount) {
     stream->writeElement(std::make_shared<StanzaAck>(handledStanzasCount));
 }
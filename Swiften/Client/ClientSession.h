@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -40,6 +40,7 @@ namespace Swift {
                 WaitingForCredentials,
                 Authenticating,
                 EnablingSessionManagement,
+                ResumingSession,
                 BindingResource,
                 StartingSession,
                 Initialized,
@@ -71,6 +72,17 @@ namespace Swift {
                 RequireTLS
             };
 
+            /**
+             * The state needed to resume a XEP-0198 stream management session
+             * on a new connection.
+             */
+            struct ResumptionState {
+                std::string resumeID;
+                JID localJID;
+                std::shared_ptr<StanzaAckRequester> stanzaAckRequester;
+                std::shared_ptr<StanzaAckResponder> stanzaAckResponder;
+            };
+
             ~ClientSession();
 
             static std::shared_ptr<ClientSession> create(const JID& jid, std::shared_ptr<SessionStream> stream, IDNConverter* idnConverter, CryptoProvider* crypto, TimerFactory* timerFactory) {
@@ -97,6 +109,71 @@ namespace Swift {
                 useAcks = b;
             }
 
+            void setUseStreamResumption(bool b) {
+                useStreamResumption = b;
+            }
+
+            /**
+             * Sets after how many sent stanzas an ack is requested.
+             * 0 requests an ack after every message.
+             */
+            void setAckRequestThreshold(unsigned int stanzas) {
+                ackRequestThreshold = stanzas;
+            }
+
+            /**
+             * Sets how long sent stanzas can wait before an ack is requested.
+             * 0 disables this.
+             */
+            void setAckRequestDelay(int milliseconds) {
+                ackRequestDelayInMilliseconds = milliseconds;
+            }
+
+            /**
+             * Sets the maximum number of unacked stanzas kept for resending
+             * when the session is resumed. 0 keeps all of them.
+             */
+            void setMaxUnackedStanzas(size_t stanzas) {
+                maxUnackedStanzas = stanzas;
+            }
+
+            /**
+             * Returns the state needed to resume this session on a new
+             * connection, if any.
+             *
+             * This is only available after the connection of an initialized
+             * session was lost, and the server allowed the session to be resumed.
+             */
+            std::shared_ptr<ResumptionState> getResumptionState() const {
+                return state == State::Finished ? resumptionState_ : std::shared_ptr<ResumptionState>();
+            }
+
+            /**
+             * Resumes the session described by the given state, instead of
+             * binding a new resource, if the server supports it.
+             *
+             * This needs to be called before start().
+             */
+            void setResumptionState(std::shared_ptr<ResumptionState> resumptionState) {
+                resumptionState_ = resumptionState;
+            }
+
+            /**
+             * Returns whether the session was initialized by resuming a
+             * previous session.
+             */
+            bool isResumed() const {
+                return resumed;
+            }
+
+            /**
+             * Returns the stanzas that the server did not ack in the session
+             * this session tried to resume, if resuming it failed.
+             */
+            const std::vector<std::shared_ptr<Stanza> >& getUnresumedStanzas() const {
+                return unresumedStanzas_;
+            }
+
             bool getStreamManagementEnabled() const {
                 // Explicitly convert to bool. In C++11, it would be cleaner to
                 // compare to nullptr.
@@ -151,6 +228,7 @@ namespace Swift {
             boost::signals2::signal<void (std::shared_ptr<Swift::Error>)> onFinished;
             boost::signals2::signal<void (std::shared_ptr<Stanza>)> onStanzaReceived;
             boost::signals2::signal<void (std::shared_ptr<Stanza>)> onStanzaAcked;
+            boost::signals2::signal<void (std::shared_ptr<Stanza>)> onStanzaDropped;
 
         private:
             ClientSession(
@@ -180,8 +258,11 @@ namespace Swift {
             bool checkState(State);
             void continueSessionInitialization();
 
+            void enableStreamManagement(std::shared_ptr<StanzaAckRequester> stanzaAckRequester, std::shared_ptr<StanzaAckResponder> stanzaAckResponder);
             void requestAck();
             void handleStanzaAcked(std::shared_ptr<Stanza> stanza);
+            void handleStanzaDropped(std::shared_ptr<Stanza> stanza);
+            void discardResumptionState();
             void ack(unsigned int handledStanzasCount);
             void continueAfterTLSEncrypted();
             void checkTrustOrFinish(const std::vector<Certificate::ref>& certificateChain, std::shared_ptr<CertificateVerificationError> error);
@@ -200,6 +281,11 @@ namespace Swift {
             bool useStreamCompression;
             UseTLS useTLS;
             bool useAcks;
+            bool useStreamResumption = false;
+            unsigned int ackRequestThreshold = 0;
+            int ackRequestDelayInMilliseconds = 0;
+            size_t maxUnackedStanzas = 0;
+            bool resumed = false;
             bool needSessionStart;
             bool needResourceBind;
             bool needAcking;
@@ -207,6 +293,8 @@ namespace Swift {
             ClientAuthenticator* authenticator;
             std::shared_ptr<StanzaAckRequester> stanzaAckRequester_;
             std::shared_ptr<StanzaAckResponder> stanzaAckResponder_;
+            std::shared_ptr<ResumptionState> resumptionState_;
+            std::vector<std::shared_ptr<Stanza> > unresumedStanzas_;
             std::shared_ptr<Swift::Error> error_;
             CertificateTrustChecker* certificateTrustChecker;
             bool singleSignOn;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -17,6 +17,7 @@ ClientSessionStanzaChannel::~ClientSessionStanzaChannel() {
         session->onFinished.disconnect(boost::bind(&ClientSessionStanzaChannel::handleSessionFinished, this, _1));
         session->onStanzaReceived.disconnect(boost::bind(&ClientSessionStanzaChannel::handleStanza, this, _1));
         session->onStanzaAcked.disconnect(boost::bind(&ClientSessionStanzaChannel::handleStanzaAcked, this, _1));
+        session->onStanzaDropped.disconnect(boost::bind(&ClientSessionStanzaChannel::handleStanzaDropped, this, _1));
         session->onInitialized.disconnect(boost::bind(&ClientSessionStanzaChannel::handleSessionInitialized, this));
         session.reset();
     }
@@ -29,6 +30,7 @@ void ClientSessionStanzaChannel::setSession(std::shared_ptr<ClientSession> sessi
     session->onFinished.connect(boost::bind(&ClientSessionStanzaChannel::handleSessionFinished, this, _1));
     session->onStanzaReceived.connect(boost::bind(&ClientSessionStanzaChannel::handleStanza, this, _1));
     session->onStanzaAcked.connect(boost::bind(&ClientSessionStanzaChannel::handleStanzaAcked, this, _1));
+    session->onStanzaDropped.connect(boost::bind(&ClientSessionStanzaChannel::handleStanzaDropped, this, _1));
 }
 
 void ClientSessionStanzaChannel::sendIQ(std::shared_ptr<IQ> iq) {
@@ -52,17 +54,50 @@ void ClientSessionStanzaChannel::send(std::shared_ptr<Stanza> stanza) {
         SWIFT_LOG(warning) << "Client: Trying to send a stanza while disconnected." << std::endl;
         return;
     }
+    if (!isSessionInitialized()) {
+        pendingStanzas.push_back(stanza);
+        if (maxPendingStanzas > 0 && pendingStanzas.size() > maxPendingStanzas) {
+            std::shared_ptr<Stanza> droppedStanza = pendingStanzas.front();
+            pendingStanzas.pop_front();
+            onStanzaDropped(droppedStanza);
+        }
+        return;
+    }
     session->sendStanza(stanza);
 }
 
+void ClientSessionStanzaChannel::cancelResumption() {
+    if (resuming) {
+        resuming = false;
+        dropPendingStanzas();
+        onAvailableChanged(false);
+    }
+}
+
 void ClientSessionStanzaChannel::handleSessionFinished(std::shared_ptr<Error>) {
+    bool resumable = static_cast<bool>(session->getResumptionState());
+    if (resuming) {
+        // The session never got initialized, so the stanzas the previous
+        // session did not get acked were not reported yet
+        for (const auto& stanza : session->getUnresumedStanzas()) {
+            onStanzaDropped(stanza);
+        }
+    }
     session->onFinished.disconnect(boost::bind(&ClientSessionStanzaChannel::handleSessionFinished, this, _1));
     session->onStanzaReceived.disconnect(boost::bind(&ClientSessionStanzaChannel::handleStanza, this, _1));
     session->onStanzaAcked.disconnect(boost::bind(&ClientSessionStanzaChannel::handleStanzaAcked, this, _1));
+    session->onStanzaDropped.disconnect(boost::bind(&ClientSessionStanzaChannel::handleStanzaDropped, this, _1));
     session->onInitialized.disconnect(boost::bind(&ClientSessionStanzaChannel::handleSessionInitialized, this));
     session.reset();
 
-    onAvailableChanged(false);
+    if (resumable) {
+        resuming = true;
+    }
+    else {
+        resuming = false;
+        dropPendingStanzas();
+        onAvailableChanged(false);
+    }
 }
 
 void ClientSessionStanzaChannel::handleStanza(std::shared_ptr<Stanza> stanza) {
@@ -104,8 +139,42 @@ void ClientSessionStanzaChannel::handleStanzaAcked(std::shared_ptr<Stanza> stanz
     onStanzaAcked(stanza);
 }
 
+void ClientSessionStanzaChannel::handleStanzaDropped(std::shared_ptr<Stanza> stanza) {
+    onStanzaDropped(stanza);
+}
+
+void ClientSessionStanzaChannel::dropPendingStanzas() {
+    std::deque<std::shared_ptr<Stanza> > stanzas;
+    stanzas.swap(pendingStanzas);
+    for (const auto& stanza : stanzas) {
+        onStanzaDropped(stanza);
+    }
+}
+
 
 void ClientSessionStanzaChannel::handleSessionInitialized() {
+    if (resuming) {
+        resuming = false;
+        std::deque<std::shared_ptr<Stanza> > stanzas;
+        stanzas.swap(pendingStanzas);
+        if (session->isResumed()) {
+            for (const auto& stanza : stanzas) {
+                session->sendStanza(stanza);
+            }
+            return;
+        }
+        // The server could not resume the session, so a new one was started.
+        // Whether the stanzas it did not ack were handled is unknown, so they
+        // are reported instead of being sent twice. The queued ones were never
+        // sent, so they go out on the new session.
+        for (const auto& stanza : session->getUnresumedStanzas()) {
+            onStanzaDropped(stanza);
+        }
+        onAvailableChanged(false);
+        for (const auto& stanza : stanzas) {
+            session->sendStanza(stanza);
+        }
+    }
     onAvailableChanged(true);
 }
 
@@ -1,12 +1,14 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <deque>
 #include <memory>
+#include <vector>
 
 #include <Swiften/Base/API.h>
 #include <Swiften/Base/IDGenerator.h>
@@ -19,6 +21,13 @@
 namespace Swift {
     /**
      * StanzaChannel implementation around a ClientSession.
+     *
+     * When the connection of a resumable session is lost, the channel stays
+     * available while the session is being resumed on a new connection.
+     * Stanzas sent in the meantime are queued, and sent once the session is
+     * resumed, or once a new session is started when it could not be resumed.
+     * Stanzas that can not be sent this way, or that the previous session did
+     * not get acked, are reported through onStanzaDropped.
      */
     class SWIFTEN_API ClientSessionStanzaChannel : public StanzaChannel {
         public:
@@ -33,7 +42,22 @@ namespace Swift {
             virtual std::vector<Certificate::ref> getPeerCertificateChain() const;
 
             bool isAvailable() const {
-                return session && session->getState() == ClientSession::State::Initialized;
+                return resuming || isSessionInitialized();
+            }
+
+            /**
+             * Makes the channel unavailable if it was waiting for a session to
+             * be resumed.
+             */
+            void cancelResumption();
+
+            /**
+             * Sets the maximum number of stanzas queued while waiting for a
+             * session to be resumed. When more are sent, the oldest ones are
+             * dropped. 0 queues all of them.
+             */
+            void setMaxPendingStanzas(size_t stanzas) {
+                maxPendingStanzas = stanzas;
             }
 
         private:
@@ -42,11 +66,20 @@ namespace Swift {
             void handleSessionFinished(std::shared_ptr<Error> error);
             void handleStanza(std::shared_ptr<Stanza> stanza);
             void handleStanzaAcked(std::shared_ptr<Stanza> stanza);
+            void handleStanzaDropped(std::shared_ptr<Stanza> stanza);
             void handleSessionInitialized();
+            void dropPendingStanzas();
+
+            bool isSessionInitialized() const {
+                return session && session->getState() == ClientSession::State::Initialized;
+            }
 
         private:
             IDGenerator idGenerator;
             std::shared_ptr<ClientSession> session;
+            bool resuming = false;
+            size_t maxPendingStanzas = 0;
+            std::deque<std::shared_ptr<Stanza> > pendingStanzas;
     };
 
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -25,6 +25,7 @@
 #include <Swiften/Queries/IQRouter.h>
 #include <Swiften/Session/BOSHSessionStream.h>
 #include <Swiften/Session/BasicSessionStream.h>
+#include <Swiften/StreamManagement/StanzaAckRequester.h>
 #include <Swiften/TLS/CertificateVerificationError.h>
 #include <Swiften/TLS/PKCS12Certificate.h>
 #include <Swiften/TLS/TLSError.h>
@@ -36,6 +37,7 @@ CoreClient::CoreClient(const JID& jid, const SafeByteArray& password, NetworkFac
     stanzaChannel_->onMessageReceived.connect(boost::bind(&CoreClient::handleMessageReceived, this, _1));
     stanzaChannel_->onPresenceReceived.connect(boost::bind(&CoreClient::handlePresenceReceived, this, _1));
     stanzaChannel_->onStanzaAcked.connect(boost::bind(&CoreClient::handleStanzaAcked, this, _1));
+    stanzaChannel_->onStanzaDropped.connect(boost::bind(&CoreClient::handleStanzaDropped, this, _1));
     stanzaChannel_->onAvailableChanged.connect(boost::bind(&CoreClient::handleStanzaChannelAvailableChanged, this, _1));
 
     iqRouter_ = new IQRouter(stanzaChannel_);
@@ -50,6 +52,7 @@ CoreClient::~CoreClient() {
     stanzaChannel_->onMessageReceived.disconnect(boost::bind(&CoreClient::handleMessageReceived, this, _1));
     stanzaChannel_->onPresenceReceived.disconnect(boost::bind(&CoreClient::handlePresenceReceived, this, _1));
     stanzaChannel_->onStanzaAcked.disconnect(boost::bind(&CoreClient::handleStanzaAcked, this, _1));
+    stanzaChannel_->onStanzaDropped.disconnect(boost::bind(&CoreClient::handleStanzaDropped, this, _1));
     delete stanzaChannel_;
 }
 
@@ -60,14 +63,17 @@ void CoreClient::connect(const ClientOptions& o) {
     disconnectRequested_ = false;
 
     options = o;
+    cancelResumption();
+    startConnecting();
+}
 
-
+void CoreClient::startConnecting() {
     // Determine connection types to use
     assert(proxyConnectionFactories.empty());
     bool useDirectConnection = true;
     HostAddressPort systemSOCKS5Proxy = networkFactories->getProxyProvider()->getSOCKS5Proxy();
     HostAddressPort systemHTTPConnectProxy = networkFactories->getProxyProvider()->getHTTPConnectProxy();
-    switch (o.proxyType) {
+    switch (options.proxyType) {
         case ClientOptions::NoProxy:
             SWIFT_LOG(debug) << " without a proxy" << std::endl;
             break;
@@ -84,8 +90,8 @@ void CoreClient::connect(const ClientOptions& o) {
             break;
         case ClientOptions::SOCKS5Proxy: {
             SWIFT_LOG(debug) << " with manual configured SOCKS5 proxy" << std::endl;
-            std::string proxyHostname = o.manualProxyHostname.empty() ? systemSOCKS5Proxy.getAddress().toString() : o.manualProxyHostname;
-            int proxyPort = o.manualProxyPort == -1 ? systemSOCKS5Proxy.getPort() : o.manualProxyPort;
+            std::string proxyHostname = options.manualProxyHostname.empty() ? systemSOCKS5Proxy.getAddress().toString() : options.manualProxyHostname;
+            int proxyPort = options.manualProxyPort == -1 ? systemSOCKS5Proxy.getPort() : options.manualProxyPort;
             SWIFT_LOG(debug) << "Proxy: " << proxyHostname << ":" << proxyPort << std::endl;
             proxyConnectionFactories.push_back(new SOCKS5ProxiedConnectionFactory(networkFactories->getDomainNameResolver(), networkFactories->getConnectionFactory(), networkFactories->getTimerFactory(), proxyHostname, proxyPort));
             useDirectConnection = false;
@@ -93,10 +99,10 @@ void CoreClient::connect(const ClientOptions& o) {
         }
         case ClientOptions::HTTPConnectProxy: {
             SWIFT_LOG(debug) << " with manual configured HTTPConnect proxy" << std::endl;
-            std::string proxyHostname = o.manualProxyHostname.empty() ? systemHTTPConnectProxy.getAddress().toString() : o.manualProxyHostname;
-            int proxyPort = o.manualProxyPort == -1 ? systemHTTPConnectProxy.getPort() : o.manualProxyPort;
+            std::string proxyHostname = options.manualProxyHostname.empty() ? systemHTTPConnectProxy.getAddress().toString() : options.manualProxyHostname;
+            int proxyPort = options.manualProxyPort == -1 ? systemHTTPConnectProxy.getPort() : options.manualProxyPort;
             SWIFT_LOG(debug) << "Proxy: " << proxyHostname << ":" << proxyPort << std::endl;
-            proxyConnectionFactories.push_back(new HTTPConnectProxiedConnectionFactory(networkFactories->getDomainNameResolver(), networkFactories->getConnectionFactory(), networkFactories->getTimerFactory(), proxyHostname, proxyPort, o.httpTrafficFilter));
+            proxyConnectionFactories.push_back(new HTTPConnectProxiedConnectionFactory(networkFactories->getDomainNameResolver(), networkFactories->getConnectionFactory(), networkFactories->getTimerFactory(), proxyHostname, proxyPort, options.httpTrafficFilter));
             useDirectConnection = false;
             break;
         }
@@ -107,10 +113,10 @@ void CoreClient::connect(const ClientOptions& o) {
     }
 
     // Create connector
-    std::string host = o.manualHostname.empty() ?  jid_.getDomain() : o.manualHostname;
-    int port = o.manualPort;
+    std::string host = options.manualHostname.empty() ?  jid_.getDomain() : options.manualHostname;
+    int port = options.manualPort;
     boost::optional<std::string> serviceLookupPrefix;
-    if (o.manualHostname.empty()) {
+    if (options.manualHostname.empty()) {
         serviceLookupPrefix = "_xmpp-client._tcp.";
     }
     assert(!connector_);
@@ -150,7 +156,6 @@ void CoreClient::connect(const ClientOptions& o) {
         boshSessionStream_->open();
         bindSessionToStream();
     }
-
 }
 
 void CoreClient::bindSessionToStream() {
@@ -173,6 +178,15 @@ void CoreClient::bindSessionToStream() {
             break;
     }
     session_->setUseAcks(options.useAcks);
+    session_->setUseStreamResumption(options.useStreamResumption && options.boshURL.isEmpty() && !options.forgetPassword);
+    session_->setAckRequestThreshold(options.ackRequestThreshold);
+    session_->setAckRequestDelay(options.ackRequestDelayInMilliseconds);
+    session_->setMaxUnackedStanzas(options.maxUnackedStanzas);
+    stanzaChannel_->setMaxPendingStanzas(options.maxUnackedStanzas);
+    if (resumableSession_) {
+        session_->setResumptionState(resumableSession_->getResumptionState());
+        resumableSession_.reset();
+    }
     stanzaChannel_->setSession(session_);
     session_->onFinished.connect(boost::bind(&CoreClient::handleSessionFinished, this, _1));
     session_->onNeedCredentials.connect(boost::bind(&CoreClient::handleNeedCredentials, this));
@@ -188,6 +202,7 @@ void CoreClient::handleConnectorFinished(std::shared_ptr<Connection> connection,
         if (options.forgetPassword) {
             purgePassword();
         }
+        cancelResumption();
         boost::optional<ClientError> clientError;
         if (!disconnectRequested_) {
             clientError = std::dynamic_pointer_cast<DomainNameResolveError>(error) ? boost::optional<ClientError>(ClientError::DomainNameResolveError) : boost::optional<ClientError>(ClientError::ConnectionError);
@@ -200,13 +215,25 @@ void CoreClient::handleConnectorFinished(std::shared_ptr<Connection> connection,
 
         if (certificate_ && certificate_->isNull()) {
             //certificate cannot be read so do not initailise session
+            cancelResumption();
             onDisconnected(boost::optional<ClientError>(ClientError::ClientCertificateLoadError));
             return;
         }
 
         connection_ = connection;
 
-        sessionStream_ = std::make_shared<BasicSessionStream>(ClientStreamType, connection_, getPayloadParserFactories(), getPayloadSerializers(), networkFactories->getTLSContextFactory(), networkFactories->getTimerFactory(), networkFactories->getXMLParserFactory(), options.tlsOptions);
+        // Resume TLS sessions with the same server when reconnecting with the
+        // same account. Sessions authenticated with a client certificate
+        // aren't cached, as resuming one would skip presenting the
+        // certificate (and authenticate with the cached one instead).
+        TLSOptions tlsOptions = options.tlsOptions;
+        if (tlsOptions.sessionCacheKey.empty() && !certificate_) {
+            tlsOptions.sessionCacheKey = "xmpp:" + jid_.toBare().toString();
+            if (!options.manualHostname.empty()) {
+                tlsOptions.sessionCacheKey += "@" + options.manualHostname + ":" + std::to_string(options.manualPort);
+            }
+        }
+        sessionStream_ = std::make_shared<BasicSessionStream>(ClientStreamType, connection_, getPayloadParserFactories(), getPayloadSerializers(), networkFactories->getTLSContextFactory(), networkFactories->getTimerFactory(), networkFactories->getXMLParserFactory(), tlsOptions);
         if (certificate_) {
             sessionStream_->setTLSCertificate(certificate_);
         }
@@ -239,6 +266,13 @@ void CoreClient::handleSessionFinished(std::shared_ptr<Error> error) {
     }
     resetSession();
 
+    if (!disconnectRequested_ && session_->getResumptionState()) {
+        SWIFT_LOG(debug) << "Connection lost; resuming the session" << std::endl;
+        resumableSession_ = session_;
+        startConnecting();
+        return;
+    }
+
     boost::optional<ClientError> actualError;
     if (error) {
         ClientError clientError;
@@ -418,6 +452,10 @@ void CoreClient::handleStanzaAcked(Stanza::ref stanza) {
     onStanzaAcked(stanza);
 }
 
+void CoreClient::handleStanzaDropped(Stanza::ref stanza) {
+    onStanzaDropped(stanza);
+}
+
 bool CoreClient::isAvailable() const {
     return stanzaChannel_->isAvailable();
 }
@@ -447,6 +485,17 @@ void CoreClient::purgePassword() {
     safeClear(password_);
 }
 
+void CoreClient::cancelResumption() {
+    if (resumableSession_) {
+        std::vector<Stanza::ref> unackedStanzas = resumableSession_->getResumptionState()->stanzaAckRequester->getUnackedStanzas();
+        resumableSession_.reset();
+        stanzaChannel_->cancelResumption();
+        for (const auto& stanza : unackedStanzas) {
+            onStanzaDropped(stanza);
+        }
+    }
+}
+
 void CoreClient::resetConnector() {
     connector_->onConnectFinished.disconnect(boost::bind(&CoreClient::handleConnectorFinished, this, _1, _2));
     connector_.reset();
@@ -190,6 +190,15 @@ namespace Swift {
              */
             boost::signals2::signal<void (std::shared_ptr<Stanza>)> onStanzaAcked;
 
+            /**
+             * Emitted when a stanza is given up on without knowing whether
+             * the server received it, e.g. because the session could not be
+             * resumed, or because too many stanzas were waiting for an ack.
+             *
+             * \see ClientOptions::maxUnackedStanzas
+             */
+            boost::signals2::signal<void (std::shared_ptr<Stanza>)> onStanzaDropped;
+
         protected:
             std::shared_ptr<ClientSession> getSession() const {
                 return session_;
@@ -214,9 +223,12 @@ namespace Swift {
             void handlePresenceReceived(std::shared_ptr<Presence>);
             void handleMessageReceived(std::shared_ptr<Message>);
             void handleStanzaAcked(std::shared_ptr<Stanza>);
+            void handleStanzaDropped(std::shared_ptr<Stanza>);
             void purgePassword();
+            void startConnecting();
             void bindSessionToStream();
 
+            void cancelResumption();
             void resetConnector();
             void resetSession();
             void forceReset();
@@ -233,6 +245,7 @@ namespace Swift {
             std::shared_ptr<Connection> connection_;
             std::shared_ptr<SessionStream> sessionStream_;
             std::shared_ptr<ClientSession> session_;
+            std::shared_ptr<ClientSession> resumableSession_;
             CertificateWithKey::ref certificate_;
             bool disconnectRequested_;
             CertificateTrustChecker* certificateTrustChecker;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -29,5 +29,6 @@ namespace Swift {
             boost::signals2::signal<void (std::shared_ptr<Message>)> onMessageReceived;
             boost::signals2::signal<void (std::shared_ptr<Presence>) > onPresenceReceived;
             boost::signals2::signal<void (std::shared_ptr<Stanza>)> onStanzaAcked;
+            boost::signals2::signal<void (std::shared_ptr<Stanza>)> onStanzaDropped;
     };
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -27,12 +27,15 @@
 #include <Swiften/Elements/Message.h>
 #include <Swiften/Elements/ResourceBind.h>
 #include <Swiften/Elements/StanzaAck.h>
+#include <Swiften/Elements/StanzaAckRequest.h>
 #include <Swiften/Elements/StartTLSFailure.h>
 #include <Swiften/Elements/StartTLSRequest.h>
 #include <Swiften/Elements/StreamError.h>
 #include <Swiften/Elements/StreamFeatures.h>
 #include <Swiften/Elements/StreamManagementEnabled.h>
 #include <Swiften/Elements/StreamManagementFailed.h>
+#include <Swiften/Elements/StreamResume.h>
+#include <Swiften/Elements/StreamResumed.h>
 #include <Swiften/Elements/TLSProceed.h>
 #include <Swiften/IDN/IDNConverter.h>
 #include <Swiften/IDN/PlatformIDNConverter.h>
@@ -60,6 +63,9 @@ class ClientSessionTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testAuthenticate_EXTERNAL);
         CPPUNIT_TEST(testStreamManagement);
         CPPUNIT_TEST(testStreamManagement_Failed);
+        CPPUNIT_TEST(testStreamResumption);
+        CPPUNIT_TEST(testStreamResumption_Failed);
+        CPPUNIT_TEST(testStreamResumption_NotAfterFinish);
         CPPUNIT_TEST(testUnexpectedChallenge);
         CPPUNIT_TEST(testFinishAcksStanzas);
 
@@ -376,6 +382,78 @@ class ClientSessionTest : public CppUnit::TestFixture {
             session->finish();
         }
 
+        void testStreamResumption() {
+            std::shared_ptr<ClientSession> session(createSession());
+            session->setUseStreamResumption(true);
+            initializeSession(session, "resume-id");
+            server->sendMessage();
+            session->sendStanza(createMessage("m1"));
+            session->sendStanza(createMessage("m2"));
+            server->receivedEvents.clear();
+            server->breakConnection();
+
+            std::shared_ptr<ClientSession::ResumptionState> resumptionState = session->getResumptionState();
+            CPPUNIT_ASSERT(resumptionState);
+
+            server = std::make_shared<MockSessionStream>();
+            std::shared_ptr<ClientSession> resumedSession(createSession());
+            resumedSession->setUseStreamResumption(true);
+            resumedSession->setResumptionState(resumptionState);
+            authenticateSession(resumedSession);
+            server->sendStreamFeaturesWithBindAndStreamManagement();
+            server->receiveStreamResume("resume-id", 1);
+            server->sendStreamResumed(1);
+
+            CPPUNIT_ASSERT_EQUAL(ClientSession::State::Initialized, resumedSession->getState());
+            CPPUNIT_ASSERT(resumedSession->isResumed());
+            CPPUNIT_ASSERT(resumedSession->getStreamManagementEnabled());
+            CPPUNIT_ASSERT_EQUAL(JID("foo@bar.com/bla"), resumedSession->getLocalJID());
+            server->receiveStanza("m2");
+            server->receiveAckRequest();
+
+            resumedSession->finish();
+        }
+
+        void testStreamResumption_Failed() {
+            std::shared_ptr<ClientSession> session(createSession());
+            session->setUseStreamResumption(true);
+            initializeSession(session, "resume-id");
+            session->sendStanza(createMessage("m1"));
+            server->breakConnection();
+
+            server = std::make_shared<MockSessionStream>();
+            std::shared_ptr<ClientSession> resumedSession(createSession());
+            resumedSession->setUseStreamResumption(true);
+            resumedSession->setResumptionState(session->getResumptionState());
+            authenticateSession(resumedSession);
+            server->sendStreamFeaturesWithBindAndStreamManagement();
+            server->receiveStreamResume("resume-id", 0);
+            server->sendStreamManagementFailed();
+            server->receiveBind();
+            server->sendBindResult();
+            server->receiveStreamManagementEnable(true);
+            server->sendStreamManagementEnabled("other-resume-id");
+
+            CPPUNIT_ASSERT_EQUAL(ClientSession::State::Initialized, resumedSession->getState());
+            CPPUNIT_ASSERT(!resumedSession->isResumed());
+            CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(resumedSession->getUnresumedStanzas().size()));
+            CPPUNIT_ASSERT_EQUAL(std::string("m1"), resumedSession->getUnresumedStanzas()[0]->getID());
+
+            resumedSession->finish();
+        }
+
+        void testStreamResumption_NotAfterFinish() {
+            std::shared_ptr<ClientSession> session(createSession());
+            session->setUseStreamResumption(true);
+            initializeSession(session, "resume-id");
+
+            session->finish();
+            server->onStreamEndReceived();
+
+            CPPUNIT_ASSERT_EQUAL(ClientSession::State::Finished, session->getState());
+            CPPUNIT_ASSERT(!session->getResumptionState());
+        }
+
         void testFinishAcksStanzas() {
             std::shared_ptr<ClientSession> session(createSession());
             initializeSession(session);
@@ -432,7 +510,16 @@ class ClientSessionTest : public CppUnit::TestFixture {
             return session;
         }
 
-        void initializeSession(std::shared_ptr<ClientSession> session) {
+        void initializeSession(std::shared_ptr<ClientSession> session, const std::string& resumeID = "") {
+            authenticateSession(session);
+            server->sendStreamFeaturesWithBindAndStreamManagement();
+            server->receiveBind();
+            server->sendBindResult();
+            server->receiveStreamManagementEnable(!resumeID.empty());
+            server->sendStreamManagementEnabled(resumeID);
+        }
+
+        void authenticateSession(std::shared_ptr<ClientSession> session) {
             session->start();
             server->receiveStreamStart();
             server->sendStreamStart();
@@ -442,11 +529,12 @@ class ClientSessionTest : public CppUnit::TestFixture {
             server->sendAuthSuccess();
             server->receiveStreamStart();
             server->sendStreamStart();
-            server->sendStreamFeaturesWithBindAndStreamManagement();
-            server->receiveBind();
-            server->sendBindResult();
-            server->receiveStreamManagementEnable();
-            server->sendStreamManagementEnabled();
+        }
+
+        std::shared_ptr<Message> createMessage(const std::string& id) {
+            std::shared_ptr<Message> message = std::make_shared<Message>();
+            message->setID(id);
+            return message;
         }
 
         void handleSessionFinished(std::shared_ptr<Error> error) {
@@ -622,8 +710,19 @@ class ClientSessionTest : public CppUnit::TestFixture {
                     onElementReceived(std::make_shared<AuthFailure>());
                 }
 
-                void sendStreamManagementEnabled() {
-                    onElementReceived(std::make_shared<StreamManagementEnabled>());
+                void sendStreamManagementEnabled(const std::string& resumeID = "") {
+                    std::shared_ptr<StreamManagementEnabled> enabled = std::make_shared<StreamManagementEnabled>();
+                    if (!resumeID.empty()) {
+                        enabled->setResumeSupported();
+                        enabled->setResumeID(resumeID);
+                    }
+                    onElementReceived(enabled);
+                }
+
+                void sendStreamResumed(unsigned int handledStanzasCount) {
+                    std::shared_ptr<StreamResumed> resumed = std::make_shared<StreamResumed>();
+                    resumed->setHandledStanzasCount(handledStanzasCount);
+                    onElementReceived(resumed);
                 }
 
                 void sendStreamManagementFailed() {
@@ -662,10 +761,36 @@ class ClientSessionTest : public CppUnit::TestFixture {
                     CPPUNIT_ASSERT_EQUAL(mech, request->getMechanism());
                 }
 
-                void receiveStreamManagementEnable() {
+                void receiveStreamManagementEnable(bool resume = false) {
+                    Event event = popEvent();
+                    CPPUNIT_ASSERT(event.element);
+                    std::shared_ptr<EnableStreamManagement> enable = std::dynamic_pointer_cast<EnableStreamManagement>(event.element);
+                    CPPUNIT_ASSERT(enable);
+                    CPPUNIT_ASSERT_EQUAL(resume, enable->getResume());
+                }
+
+                void receiveStreamResume(const std::string& resumeID, unsigned int handledStanzasCount) {
+                    Event event = popEvent();
+                    CPPUNIT_ASSERT(event.element);
+                    std::shared_ptr<StreamResume> resume = std::dynamic_pointer_cast<StreamResume>(event.element);
+                    CPPUNIT_ASSERT(resume);
+                    CPPUNIT_ASSERT_EQUAL(resumeID, resume->getResumeID());
+                    CPPUNIT_ASSERT(resume->getHandledStanzasCount());
+                    CPPUNIT_ASSERT_EQUAL(handledStanzasCount, *resume->getHandledStanzasCount());
+                }
+
+                void receiveStanza(const std::string& id) {
+                    Event event = popEvent();
+                    CPPUNIT_ASSERT(event.element);
+                    std::shared_ptr<Stanza> stanza = std::dynamic_pointer_cast<Stanza>(event.element);
+                    CPPUNIT_ASSERT(stanza);
+                    CPPUNIT_ASSERT_EQUAL(id, stanza->getID());
+                }
+
+                void receiveAckRequest() {
                     Event event = popEvent();
                     CPPUNIT_ASSERT(event.element);
-                    CPPUNIT_ASSERT(std::dynamic_pointer_cast<EnableStreamManagement>(event.element));
+                    CPPUNIT_ASSERT(std::dynamic_pointer_cast<StanzaAckRequest>(event.element));
                 }
 
                 void receiveBind() {
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,16 +7,74 @@
 #include <Swiften/Disco/CapsInfoGenerator.h>
 
 #include <algorithm>
+#include <memory>
+#include <vector>
 
 #include <Swiften/Crypto/CryptoProvider.h>
+#include <Swiften/Crypto/Hash.h>
 #include <Swiften/Elements/DiscoInfo.h>
 #include <Swiften/Elements/FormField.h>
 #include <Swiften/StringCodecs/Base64.h>
 
 namespace {
+    // Feeds the hash in blocks, so the serialized disco#info is never built
+    // in memory as a whole.
+    class BufferedHashWriter {
+        public:
+            BufferedHashWriter(Swift::Hash& hash) : hash_(hash) {
+                buffer_.reserve(BLOCK_SIZE);
+            }
+
+            void write(const std::string& data) {
+                buffer_.insert(buffer_.end(), data.begin(), data.end());
+                if (buffer_.size() >= BLOCK_SIZE) {
+                    flush();
+                }
+            }
+
+            void writeSeparator(char separator) {
+                buffer_.push_back(static_cast<unsigned char>(separator));
+            }
+
+            std::vector<unsigned char> getHash() {
+                flush();
+                return hash_.getHash();
+            }
+
+        private:
+            void flush() {
+                if (!buffer_.empty()) {
+                    hash_.update(buffer_);
+                    buffer_.clear();
+                }
+            }
+
+        private:
+            static const size_t BLOCK_SIZE = 4096;
+            Swift::Hash& hash_;
+            Swift::ByteArray buffer_;
+    };
+
     bool compareFields(Swift::FormField::ref f1, Swift::FormField::ref f2) {
         return f1->getName() < f2->getName();
     }
+
+    template<typename T>
+    bool comparePointees(const T* t1, const T* t2) {
+        return *t1 < *t2;
+    }
+
+    // Sorts pointers to the elements, to avoid copying them
+    template<typename T>
+    std::vector<const T*> getSortedPointers(const std::vector<T>& elements) {
+        std::vector<const T*> result;
+        result.reserve(elements.size());
+        for (const auto& element : elements) {
+            result.push_back(&element);
+        }
+        std::sort(result.begin(), result.end(), &comparePointees<T>);
+        return result;
+    }
 }
 
 namespace Swift {
@@ -25,39 +83,52 @@ CapsInfoGenerator::CapsInfoGenerator(const std::string& node, CryptoProvider* cr
 }
 
 CapsInfo CapsInfoGenerator::generateCapsInfo(const DiscoInfo& discoInfo) const {
-    std::string serializedCaps;
+    return CapsInfo(node_, getVersion(discoInfo), "sha-1");
+}
+
+bool CapsInfoGenerator::verifyCapsInfo(const DiscoInfo& discoInfo, const std::string& version) const {
+    return getVersion(discoInfo) == version;
+}
+
+std::string CapsInfoGenerator::getVersion(const DiscoInfo& discoInfo) const {
+    std::unique_ptr<Hash> hash(crypto_->createSHA1());
+    BufferedHashWriter writer(*hash);
 
-    std::vector<DiscoInfo::Identity> identities(discoInfo.getIdentities());
-    std::sort(identities.begin(), identities.end());
-    for (const auto& identity : identities) {
-        serializedCaps += identity.getCategory() + "/" + identity.getType() + "/" + identity.getLanguage() + "/" + identity.getName() + "<";
+    for (const auto identity : getSortedPointers(discoInfo.getIdentities())) {
+        writer.write(identity->getCategory());
+        writer.writeSeparator('/');
+        writer.write(identity->getType());
+        writer.writeSeparator('/');
+        writer.write(identity->getLanguage());
+        writer.writeSeparator('/');
+        writer.write(identity->getName());
+        writer.writeSeparator('<');
     }
 
-    std::vector<std::string> features(discoInfo.getFeatures());
-    std::sort(features.begin(), features.end());
-    for (const auto& feature : features) {
-        serializedCaps += feature + "<";
+    for (const auto feature : getSortedPointers(discoInfo.getFeatures())) {
+        writer.write(*feature);
+        writer.writeSeparator('<');
     }
 
     for (const auto& extension : discoInfo.getExtensions()) {
-        serializedCaps += extension->getFormType() + "<";
+        writer.write(extension->getFormType());
+        writer.writeSeparator('<');
         std::vector<FormField::ref> fields(extension->getFields());
         std::sort(fields.begin(), fields.end(), &compareFields);
         for (const auto& field : fields) {
             if (field->getName() == "FORM_TYPE") {
                 continue;
             }
-            serializedCaps += field->getName() + "<";
-            std::vector<std::string> values(field->getValues());
-            std::sort(values.begin(), values.end());
-            for (const auto& value : values) {
-                serializedCaps += value + "<";
+            writer.write(field->getName());
+            writer.writeSeparator('<');
+            for (const auto value : getSortedPointers(field->getValues())) {
+                writer.write(*value);
+                writer.writeSeparator('<');
             }
         }
     }
 
-    std::string version(Base64::encode(crypto_->getSHA1Hash(createByteArray(serializedCaps))));
-    return CapsInfo(node_, version, "sha-1");
+    return Base64::encode(writer.getHash());
 }
 
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -21,7 +21,15 @@ namespace Swift {
 
             CapsInfo generateCapsInfo(const DiscoInfo& discoInfo) const;
 
+            /**
+             * Returns whether the given verification string is the hash of
+             * the disco#info.
+             */
+            bool verifyCapsInfo(const DiscoInfo& discoInfo, const std::string& version) const;
+
         private:
+            std::string getVersion(const DiscoInfo& discoInfo) const;
+
             std::string node_;
             CryptoProvider* crypto_;
     };
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -51,7 +51,7 @@ void CapsManager::handleStanzaChannelAvailableChanged(bool available) {
 
 void CapsManager::handleDiscoInfoReceived(const JID& from, const std::string& hash, DiscoInfo::ref discoInfo, ErrorPayload::ref error) {
     requestedDiscoInfos.erase(hash);
-    if (error || !discoInfo || CapsInfoGenerator("", crypto).generateCapsInfo(*discoInfo.get()).getVersion() != hash) {
+    if (error || !discoInfo || !CapsInfoGenerator("", crypto).verifyCapsInfo(*discoInfo, hash)) {
         if (warnOnInvalidHash && !error &&  discoInfo) {
             SWIFT_LOG(warning) << "Caps from " << from.toString() << " do not verify" << std::endl;
         }
@@ -28,21 +28,32 @@ void EntityCapsManager::handlePresenceReceived(std::shared_ptr<Presence> presenc
         }
         std::string hash = capsInfo->getVersion();
         std::map<JID, std::string>::iterator i = caps.find(from);
-        if (i == caps.end() || i->second != hash) {
+        if (i != caps.end() && i->second == hash) {
+            return;
+        }
+        bool hadCaps = false;
+        if (i != caps.end()) {
+            hadCaps = getCaps(from) != nullptr;
+            removeJIDFromHash(from, i->second);
+            i->second = hash;
+        }
+        else {
             caps.insert(std::make_pair(from, hash));
-            DiscoInfo::ref disco = capsProvider->getCaps(hash);
-            if (disco) {
-                onCapsChanged(from);
-            }
-            else if (i != caps.end()) {
-                caps.erase(i);
-                onCapsChanged(from);
-            }
+        }
+
+        HashEntities& entities = entitiesByHash[hash];
+        entities.jids.insert(from);
+        if (!entities.discoInfo) {
+            entities.discoInfo = capsProvider->getCaps(hash);
+        }
+        if (entities.discoInfo || hadCaps) {
+            onCapsChanged(from);
         }
     }
     else {
         std::map<JID, std::string>::iterator i = caps.find(from);
         if (i != caps.end()) {
+            removeJIDFromHash(from, i->second);
             caps.erase(i);
             onCapsChanged(from);
         }
@@ -53,6 +64,7 @@ void EntityCapsManager::handleStanzaChannelAvailableChanged(bool available) {
     if (available) {
         std::map<JID, std::string> capsCopy;
         capsCopy.swap(caps);
+        entitiesByHash.clear();
         for (std::map<JID,std::string>::const_iterator i = capsCopy.begin(); i != capsCopy.end(); ++i) {
             onCapsChanged(i->first);
         }
@@ -60,10 +72,24 @@ void EntityCapsManager::handleStanzaChannelAvailableChanged(bool available) {
 }
 
 void EntityCapsManager::handleCapsAvailable(const std::string& hash) {
-    // TODO: Use Boost.Bimap ?
-    for (std::map<JID,std::string>::const_iterator i = caps.begin(); i != caps.end(); ++i) {
-        if (i->second == hash) {
-            onCapsChanged(i->first);
+    auto i = entitiesByHash.find(hash);
+    if (i == entitiesByHash.end()) {
+        return;
+    }
+    i->second.discoInfo = capsProvider->getCaps(hash);
+    // Copy the JIDs, as the handlers may receive presences
+    std::set<JID> jids(i->second.jids);
+    for (const auto& jid : jids) {
+        onCapsChanged(jid);
+    }
+}
+
+void EntityCapsManager::removeJIDFromHash(const JID& jid, const std::string& hash) {
+    auto i = entitiesByHash.find(hash);
+    if (i != entitiesByHash.end()) {
+        i->second.jids.erase(jid);
+        if (i->second.jids.empty()) {
+            entitiesByHash.erase(i);
         }
     }
 }
@@ -71,25 +97,16 @@ void EntityCapsManager::handleCapsAvailable(const std::string& hash) {
 DiscoInfo::ref EntityCapsManager::getCaps(const JID& jid) const {
     std::map<JID, std::string>::const_iterator i = caps.find(jid);
     if (i != caps.end()) {
-        return capsProvider->getCaps(i->second);
+        auto entities = entitiesByHash.find(i->second);
+        if (entities != entitiesByHash.end()) {
+            return entities->second.discoInfo;
+        }
     }
     return DiscoInfo::ref();
 }
 
 DiscoInfo::ref EntityCapsManager::getCapsCached(const JID& jid) {
-    DiscoInfo::ref result;
-    auto capsHit = caps.find(jid);
-    if (capsHit != caps.end()) {
-        result = lruDiscoCache.get(capsHit->second, [&](const std::string& capsHash) {
-            boost::optional<DiscoInfo::ref> fileCacheResult;
-            auto fileCacheDiscoInfo = capsProvider->getCaps(capsHash);
-            if (fileCacheDiscoInfo) {
-                fileCacheResult = fileCacheDiscoInfo;
-            }
-            return fileCacheResult;
-        }).get_value_or(DiscoInfo::ref());
-    }
-    return result;
+    return getCaps(jid);
 }
 
 }
@@ -7,11 +7,13 @@
 #pragma once
 
 #include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
 
 #include <boost/signals2.hpp>
 
 #include <Swiften/Base/API.h>
-#include <Swiften/Base/LRUCache.h>
 #include <Swiften/Disco/EntityCapsProvider.h>
 #include <Swiften/Elements/DiscoInfo.h>
 #include <Swiften/Elements/ErrorPayload.h>
@@ -36,16 +38,28 @@ namespace Swift {
              */
             DiscoInfo::ref getCaps(const JID&) const;
 
+            /**
+             * Returns the cached caps for the entity without querying the caps
+             * provider.
+             */
             DiscoInfo::ref getCapsCached(const JID&);
 
         private:
             void handlePresenceReceived(std::shared_ptr<Presence>);
             void handleStanzaChannelAvailableChanged(bool);
             void handleCapsAvailable(const std::string&);
+            void removeJIDFromHash(const JID&, const std::string& hash);
 
         private:
+            // The entities advertising a hash, and the disco#info they share
+            // once the hash is resolved
+            struct HashEntities {
+                std::set<JID> jids;
+                DiscoInfo::ref discoInfo;
+            };
+
             CapsProvider* capsProvider;
             std::map<JID, std::string> caps;
-            LRUCache<std::string, DiscoInfo::ref, 64> lruDiscoCache;
+            std::unordered_map<std::string, HashEntities> entitiesByHash;
     };
 }
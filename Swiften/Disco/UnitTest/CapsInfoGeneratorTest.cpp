@@ -18,6 +18,7 @@ class CapsInfoGeneratorTest : public CppUnit::TestFixture {
         CPPUNIT_TEST_SUITE(CapsInfoGeneratorTest);
         CPPUNIT_TEST(testGenerate_XEP0115SimpleExample);
         CPPUNIT_TEST(testGenerate_XEP0115ComplexExample);
+        CPPUNIT_TEST(testVerify);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -41,6 +42,20 @@ class CapsInfoGeneratorTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(std::string("QgayPKawpkPSDYmwT/WM94uAlu0="), result.getVersion());
         }
 
+        void testVerify() {
+            DiscoInfo discoInfo;
+            discoInfo.addIdentity(DiscoInfo::Identity("Exodus 0.9.1", "client", "pc"));
+            discoInfo.addFeature("http://jabber.org/protocol/disco#items");
+            discoInfo.addFeature("http://jabber.org/protocol/caps");
+            discoInfo.addFeature("http://jabber.org/protocol/disco#info");
+            discoInfo.addFeature("http://jabber.org/protocol/muc");
+
+            CapsInfoGenerator testling("", crypto.get());
+
+            CPPUNIT_ASSERT(testling.verifyCapsInfo(discoInfo, "QgayPKawpkPSDYmwT/WM94uAlu0="));
+            CPPUNIT_ASSERT(!testling.verifyCapsInfo(discoInfo, "q07IKJEyjvHSyhy//CH0CxmKi8w="));
+        }
+
         void testGenerate_XEP0115ComplexExample() {
             DiscoInfo discoInfo;
             discoInfo.addIdentity(DiscoInfo::Identity("Psi 0.11", "client", "pc", "en"));
@@ -31,6 +31,8 @@ class EntityCapsManagerTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testReceiveUnavailablePresenceAfterKnownHashTriggersChangeAndClearsCaps);
         CPPUNIT_TEST(testReconnectTriggersChangeAndClearsCaps);
         CPPUNIT_TEST(testHashAvailable);
+        CPPUNIT_TEST(testHashAvailableTriggersChangeForAllEntitiesWithHash);
+        CPPUNIT_TEST(testReceiveOtherKnownHashTriggersChangeAndUpdatesCaps);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -93,6 +95,36 @@ class EntityCapsManagerTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(discoInfo1, testling->getCaps(user1));
         }
 
+        void testHashAvailableTriggersChangeForAllEntitiesWithHash() {
+            std::shared_ptr<EntityCapsManager> testling = createManager();
+            sendPresenceWithCaps(user1, capsInfo1);
+            sendPresenceWithCaps(user2, capsInfo2);
+            sendPresenceWithCaps(user3, capsInfo1);
+
+            capsProvider->caps[capsInfo1->getVersion()] = discoInfo1;
+            capsProvider->onCapsAvailable(capsInfo1->getVersion());
+
+            CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(changes.size()));
+            CPPUNIT_ASSERT_EQUAL(user1, changes[0]);
+            CPPUNIT_ASSERT_EQUAL(user3, changes[1]);
+            CPPUNIT_ASSERT_EQUAL(discoInfo1, testling->getCaps(user1));
+            CPPUNIT_ASSERT_EQUAL(discoInfo1, testling->getCaps(user3));
+            CPPUNIT_ASSERT(!testling->getCaps(user2));
+        }
+
+        void testReceiveOtherKnownHashTriggersChangeAndUpdatesCaps() {
+            std::shared_ptr<EntityCapsManager> testling = createManager();
+            capsProvider->caps[capsInfo1->getVersion()] = discoInfo1;
+            capsProvider->caps[capsInfo2->getVersion()] = discoInfo2;
+            sendPresenceWithCaps(user1, capsInfo1);
+            changes.clear();
+            sendPresenceWithCaps(user1, capsInfo2);
+
+            CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(changes.size()));
+            CPPUNIT_ASSERT_EQUAL(user1, changes[0]);
+            CPPUNIT_ASSERT_EQUAL(discoInfo2, testling->getCaps(user1));
+        }
+
         void testReceiveUnknownHashAfterKnownHashTriggersChangeAndClearsCaps() {
             std::shared_ptr<EntityCapsManager> testling = createManager();
             capsProvider->caps[capsInfo1->getVersion()] = discoInfo1;
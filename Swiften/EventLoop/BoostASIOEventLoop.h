@@ -12,7 +12,6 @@
 #include <boost/asio/io_service.hpp>
 
 #include <Swiften/Base/API.h>
-#include <Swiften/EventLoop/Event.h>
 #include <Swiften/EventLoop/EventLoop.h>
 
 namespace Swift {
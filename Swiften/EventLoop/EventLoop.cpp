@@ -1,30 +1,21 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swiften/EventLoop/EventLoop.h>
 
-#include <algorithm>
 #include <cassert>
-#include <vector>
-
-#include <boost/bind.hpp>
-#include <boost/lambda/bind.hpp>
-#include <boost/lambda/lambda.hpp>
-#include <boost/optional.hpp>
+#include <exception>
 
 #include <Swiften/Base/Log.h>
 
-namespace lambda = boost::lambda;
-
 namespace Swift {
 
-inline void invokeCallback(const Event& event) {
+inline void invokeCallback(EventQueue::Node& event) {
     try {
-        assert(!event.callback.empty());
-        event.callback();
+        event.invoke();
     }
     catch (const std::exception& e) {
         SWIFT_LOG(error) << "Uncaught exception in event loop: " << e.what() << std::endl;
@@ -41,7 +32,7 @@ EventLoop::~EventLoop() {
 }
 
 void EventLoop::handleNextEvents() {
-    const int eventsBatched = 100;
+    const size_t eventsBatched = 100;
     // If handleNextEvents is already in progress, e.g. in case of a recursive call due to
     // the event loop implementation, then do no handle further events. Instead call
     // eventPosted() to continue event handling later.
@@ -49,22 +40,22 @@ void EventLoop::handleNextEvents() {
     if (!handlingEvents_) {
         handlingEvents_ = true;
         std::unique_lock<std::recursive_mutex> lock(removeEventsMutex_);
-        {
-            std::vector<Event> nextEvents;
-            {
-                std::unique_lock<std::recursive_mutex> lock(eventsMutex_);
-                for (int n = 0; ((n < eventsBatched) && !events_.empty()); n++) {
-                    nextEvents.push_back(events_.front());
-                    events_.pop_front();
+        size_t handledEvents = 0;
+        while (handledEvents < eventsBatched) {
+            std::unique_ptr<EventQueue::Node> event(events_.pop());
+            if (!event) {
+                if (events_.isEmpty()) {
+                    // All events of removed owners are gone from the queue
+                    removedOwners_.clear();
                 }
-                callEventPosted = !events_.empty();
+                break;
             }
-            if (!nextEvents.empty()) {
-                for (const auto& event : nextEvents) {
-                    invokeCallback(event);
-                }
+            ++handledEvents;
+            if (!isRemoved(*event)) {
+                invokeCallback(*event);
             }
         }
+        callEventPosted = events_.markHandled(handledEvents);
         handlingEvents_ = false;
     }
 
@@ -73,30 +64,26 @@ void EventLoop::handleNextEvents() {
     }
 }
 
-void EventLoop::postEvent(boost::function<void ()> callback, std::shared_ptr<EventOwner> owner) {
-    Event event(owner, callback);
-    bool callEventPosted = false;
-    {
-        std::unique_lock<std::recursive_mutex> lock(eventsMutex_);
-
-        callEventPosted = events_.empty();
-
-        event.id = nextEventID_;
-        nextEventID_++;
-        events_.push_back(event);
-    }
-    if (callEventPosted) {
+void EventLoop::postEventNode(EventQueue::Node* event) {
+    event->id = nextEventID_++;
+    if (events_.push(event)) {
         eventPosted();
     }
 }
 
 void EventLoop::removeEventsFromOwner(std::shared_ptr<EventOwner> owner) {
-    std::unique_lock<std::recursive_mutex> removeLock(removeEventsMutex_, std::defer_lock);
-    std::unique_lock<std::recursive_mutex> eventsLock(eventsMutex_, std::defer_lock);
-
-    std::lock(removeLock, eventsLock);
+    std::unique_lock<std::recursive_mutex> lock(removeEventsMutex_);
+    // Instead of searching the queue, remember which events of the owner were
+    // posted so far, and skip them when they are taken from the queue.
+    removedOwners_[owner.get()] = nextEventID_;
+}
 
-    events_.remove_if(lambda::bind(&Event::owner, lambda::_1) == owner);
+bool EventLoop::isRemoved(const EventQueue::Node& event) const {
+    if (removedOwners_.empty()) {
+        return false;
+    }
+    auto i = removedOwners_.find(event.owner.get());
+    return i != removedOwners_.end() && event.id < i->second;
 }
 
 }
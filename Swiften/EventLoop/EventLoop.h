@@ -1,18 +1,21 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
-#include <list>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
 
 #include <boost/function.hpp>
 
 #include <Swiften/Base/API.h>
-#include <Swiften/EventLoop/Event.h>
+#include <Swiften/EventLoop/EventQueue.h>
 
 namespace Swift {
     class EventOwner;
@@ -22,6 +25,8 @@ namespace Swift {
      *
      *  Events are added to the event queue using the \ref postEvent method and can be removed from the queue using
      *  the \ref removeEventsFromOwner method.
+     *
+     *  Posting an event does not take a lock, so it is cheap to post events from other threads.
      */
     class SWIFTEN_API EventLoop {
         public:
@@ -32,8 +37,14 @@ namespace Swift {
              * The \ref postEvent method allows events to be added to the event queue of the \ref EventLoop.
              * An optional \ref EventOwner can be passed as \p owner, allowing later removal of events that have not yet been
              * executed using the \ref removeEventsFromOwner method.
+             *
+             * The \p event callback can be any function object, and is stored in the event without
+             * wrapping it in a \c boost::function.
              */
-            void postEvent(boost::function<void ()> event, std::shared_ptr<EventOwner> owner = std::shared_ptr<EventOwner>());
+            template<typename Callback>
+            void postEvent(Callback event, std::shared_ptr<EventOwner> owner = std::shared_ptr<EventOwner>()) {
+                postEventNode(new EventQueue::CallbackNode<Callback>(std::move(event), std::move(owner)));
+            }
 
             /**
              * The \ref removeEventsFromOwner method removes all events from the specified \p owner from the
@@ -62,10 +73,15 @@ namespace Swift {
             virtual void eventPosted() = 0;
 
         private:
-            unsigned int nextEventID_;
-            std::list<Event> events_;
+            void postEventNode(EventQueue::Node* event);
+            bool isRemoved(const EventQueue::Node& event) const;
+
+        private:
+            std::atomic<std::uint64_t> nextEventID_;
+            EventQueue events_;
             bool handlingEvents_;
-            std::recursive_mutex eventsMutex_;
             std::recursive_mutex removeEventsMutex_;
+            // For each owner whose events were removed, the ID of the first event that was not removed.
+            std::unordered_map<EventOwner*, std::uint64_t> removedOwners_;
     };
 }
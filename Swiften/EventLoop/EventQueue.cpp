@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/EventLoop/EventQueue.h>
+
+namespace Swift {
+
+EventQueue::Node::~Node() {
+}
+
+EventQueue::EventQueue() : head_(&stub_), tail_(&stub_), pending_(0) {
+}
+
+EventQueue::~EventQueue() {
+    while (Node* node = pop()) {
+        delete node;
+    }
+}
+
+bool EventQueue::push(Node* node) {
+    link(node);
+    return pending_.fetch_add(1) == 0;
+}
+
+void EventQueue::link(Node* node) {
+    node->next_.store(nullptr, std::memory_order_relaxed);
+    Node* previous = head_.exchange(node, std::memory_order_acq_rel);
+    // Until this store, the consumer cannot reach the node (or anything
+    // pushed after it), and pop() reports the queue as temporarily empty.
+    previous->next_.store(node, std::memory_order_release);
+}
+
+EventQueue::Node* EventQueue::pop() {
+    Node* tail = tail_;
+    Node* next = tail->next_.load(std::memory_order_acquire);
+    if (tail == &stub_) {
+        if (!next) {
+            return nullptr;
+        }
+        tail_ = next;
+        tail = next;
+        next = next->next_.load(std::memory_order_acquire);
+    }
+    if (next) {
+        tail_ = next;
+        return tail;
+    }
+    if (tail != head_.load(std::memory_order_acquire)) {
+        // A producer is in the middle of pushing
+        return nullptr;
+    }
+    // The tail is the last node; put the stub behind it so it can be taken
+    link(&stub_);
+    next = tail->next_.load(std::memory_order_acquire);
+    if (next) {
+        tail_ = next;
+        return tail;
+    }
+    return nullptr;
+}
+
+bool EventQueue::markHandled(size_t count) {
+    std::ptrdiff_t handled = static_cast<std::ptrdiff_t>(count);
+    // Producers count their events after pushing them, so this can
+    // temporarily drop below zero. That only leads to a spurious wakeup.
+    return pending_.fetch_sub(handled) - handled != 0;
+}
+
+bool EventQueue::isEmpty() const {
+    return tail_ == &stub_ && head_.load(std::memory_order_acquire) == &stub_;
+}
+
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include <boost/noncopyable.hpp>
+#include <boost/ref.hpp>
+
+#include <Swiften/Base/API.h>
+
+namespace Swift {
+    class EventOwner;
+
+    /**
+     * A queue of events that any number of threads can push to without
+     * taking a lock, and that a single thread at a time can pop from.
+     *
+     * This is Dmitry Vyukov's intrusive multiple-producer/single-consumer
+     * queue: the events are the queue nodes, so pushing an event does not
+     * allocate.
+     */
+    class SWIFTEN_API EventQueue : public boost::noncopyable {
+        public:
+            class SWIFTEN_API Node : public boost::noncopyable {
+                public:
+                    Node(std::shared_ptr<EventOwner> owner) : id(0), owner(std::move(owner)), next_(nullptr) {}
+                    virtual ~Node();
+
+                    virtual void invoke() = 0;
+
+                    std::uint64_t id;
+                    std::shared_ptr<EventOwner> owner;
+
+                private:
+                    friend class EventQueue;
+                    std::atomic<Node*> next_;
+            };
+
+            /**
+             * An event that stores its callback inline, so that posting it
+             * needs a single allocation.
+             */
+            template<typename Callback>
+            class CallbackNode : public Node {
+                public:
+                    CallbackNode(Callback callback, std::shared_ptr<EventOwner> owner) : Node(std::move(owner)), callback_(std::move(callback)) {}
+
+                    virtual void invoke() {
+                        call(callback_);
+                    }
+
+                private:
+                    template<typename T>
+                    static void call(T& callback) {
+                        callback();
+                    }
+
+                    template<typename T>
+                    static void call(boost::reference_wrapper<T>& callback) {
+                        callback.get()();
+                    }
+
+                private:
+                    Callback callback_;
+            };
+
+            EventQueue();
+            ~EventQueue();
+
+            /**
+             * Adds \p node to the queue, and takes ownership of it.
+             *
+             * \return true if the queue had no pending events.
+             */
+            bool push(Node* node);
+
+            /**
+             * Takes the oldest node from the queue, or returns nullptr if
+             * no node is available (yet). Only one thread can pop at a time.
+             */
+            Node* pop();
+
+            /**
+             * Marks \p count popped nodes as handled.
+             *
+             * \return true if there are events pending that have not been popped.
+             */
+            bool markHandled(size_t count);
+
+            /**
+             * Returns true if every node pushed so far has been popped. Like
+             * pop(), this can only be called from the consuming thread.
+             */
+            bool isEmpty() const;
+
+        private:
+            class StubNode : public Node {
+                public:
+                    StubNode() : Node(std::shared_ptr<EventOwner>()) {}
+                    virtual void invoke() {}
+            };
+
+            void link(Node* node);
+
+        private:
+            std::atomic<Node*> head_;
+            Node* tail_;
+            StubNode stub_;
+            std::atomic<std::ptrdiff_t> pending_;
+    };
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <Swiften/EventLoop/EventOwner.h>
+#include <Swiften/EventLoop/SimpleEventLoop.h>
+
+using namespace Swift;
+
+/*
+ * Measures how many events per second a SimpleEventLoop handles while a
+ * number of threads post events to it concurrently, the way the network
+ * threads post incoming data to the main loop.
+ */
+
+namespace {
+    struct BenchmarkEventOwner : public EventOwner {
+    };
+
+    class Counter {
+        public:
+            Counter(SimpleEventLoop* eventLoop, int expected) : eventLoop_(eventLoop), expected_(expected), count_(0) {
+            }
+
+            void handleEvent() {
+                if (++count_ == expected_) {
+                    eventLoop_->stop();
+                }
+            }
+
+            int getCount() const {
+                return count_;
+            }
+
+        private:
+            SimpleEventLoop* eventLoop_;
+            int expected_;
+            int count_;
+    };
+}
+
+int main(int argc, char* argv[]) {
+    int threadCount = 4;
+    int eventsPerThread = 250000;
+    if (argc > 1) {
+        threadCount = std::atoi(argv[1]);
+    }
+    if (argc > 2) {
+        eventsPerThread = std::atoi(argv[2]);
+    }
+    if (threadCount <= 0 || eventsPerThread <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [threads] [events per thread]" << std::endl;
+        return -1;
+    }
+
+    SimpleEventLoop eventLoop;
+    Counter counter(&eventLoop, threadCount * eventsPerThread);
+    std::shared_ptr<BenchmarkEventOwner> owner = std::make_shared<BenchmarkEventOwner>();
+    std::atomic<bool> go(false);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; ++i) {
+        threads.push_back(std::thread([&]() {
+            while (!go) {
+                std::this_thread::yield();
+            }
+            for (int j = 0; j < eventsPerThread; ++j) {
+                eventLoop.postEvent([&counter]() { counter.handleEvent(); }, owner);
+            }
+        }));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    go = true;
+    eventLoop.run();
+    auto end = std::chrono::steady_clock::now();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << "Handled " << counter.getCount() << " events from " << threadCount << " threads in " << seconds << "s: ";
+    std::cout << static_cast<double>(counter.getCount()) / seconds << " events/s" << std::endl;
+    return 0;
+}
@@ -1,10 +1,11 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <thread>
+#include <vector>
 
 #include <boost/bind.hpp>
 
@@ -23,6 +24,10 @@ class EventLoopTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testPost);
         CPPUNIT_TEST(testRemove);
         CPPUNIT_TEST(testHandleEvent_Recursive);
+        CPPUNIT_TEST(testRemove_FromEvent);
+        CPPUNIT_TEST(testRemove_PostAfterRemove);
+        CPPUNIT_TEST(testPost_FromMultipleThreads);
+        CPPUNIT_TEST(testPost_MoreThanOneBatch);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -74,6 +79,75 @@ class EventLoopTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(1, events_[1]);
         }
 
+        void testRemove_FromEvent() {
+            DummyEventLoop testling;
+            std::shared_ptr<MyEventOwner> eventOwner1(new MyEventOwner());
+            std::shared_ptr<MyEventOwner> eventOwner2(new MyEventOwner());
+
+            testling.postEvent(boost::bind(&EventLoop::removeEventsFromOwner, &testling, eventOwner2), eventOwner1);
+            testling.postEvent(boost::bind(&EventLoopTest::logEvent, this, 1), eventOwner2);
+            testling.postEvent(boost::bind(&EventLoopTest::logEvent, this, 2), eventOwner1);
+            testling.processEvents();
+
+            CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(events_.size()));
+            CPPUNIT_ASSERT_EQUAL(2, events_[0]);
+        }
+
+        void testRemove_PostAfterRemove() {
+            DummyEventLoop testling;
+            std::shared_ptr<MyEventOwner> eventOwner(new MyEventOwner());
+
+            testling.postEvent(boost::bind(&EventLoopTest::logEvent, this, 1), eventOwner);
+            testling.removeEventsFromOwner(eventOwner);
+            testling.postEvent(boost::bind(&EventLoopTest::logEvent, this, 2), eventOwner);
+            testling.processEvents();
+            testling.postEvent(boost::bind(&EventLoopTest::logEvent, this, 3), eventOwner);
+            testling.processEvents();
+
+            CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(events_.size()));
+            CPPUNIT_ASSERT_EQUAL(2, events_[0]);
+            CPPUNIT_ASSERT_EQUAL(3, events_[1]);
+        }
+
+        void testPost_FromMultipleThreads() {
+            SimpleEventLoop testling;
+            const int threadCount = 4;
+            const int eventsPerThread = 1000;
+            std::vector<std::vector<int> > threadEvents(threadCount);
+
+            std::vector<std::thread> threads;
+            for (int i = 0; i < threadCount; ++i) {
+                threads.push_back(std::thread([&testling, &threadEvents, i]() {
+                    for (int j = 0; j < eventsPerThread; ++j) {
+                        testling.postEvent([&threadEvents, i, j]() { threadEvents[i].push_back(j); });
+                    }
+                }));
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            testling.stop();
+            testling.run();
+
+            for (const auto& events : threadEvents) {
+                CPPUNIT_ASSERT_EQUAL(eventsPerThread, static_cast<int>(events.size()));
+                for (int j = 0; j < eventsPerThread; ++j) {
+                    CPPUNIT_ASSERT_EQUAL(j, events[j]);
+                }
+            }
+        }
+
+        void testPost_MoreThanOneBatch() {
+            DummyEventLoop testling;
+            for (int i = 0; i < 250; ++i) {
+                testling.postEvent(boost::bind(&EventLoopTest::logEvent, this, i));
+            }
+            testling.processEvents();
+
+            CPPUNIT_ASSERT_EQUAL(250, static_cast<int>(events_.size()));
+            CPPUNIT_ASSERT_EQUAL(249, events_[249]);
+        }
+
     private:
         struct MyEventOwner : public EventOwner {};
         void logEvent(int i) {
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/Base/SafeByteArray.h>
+#include <Swiften/Parser/PayloadParsers/FullPayloadParserFactoryCollection.h>
+#include <Swiften/Parser/PlatformXMLParserFactory.h>
+#include <Swiften/Parser/XMPPParser.h>
+#include <Swiften/Parser/XMPPParserClient.h>
+
+using namespace Swift;
+
+/*
+ * Measures the throughput of the incoming stanza parsing path, by feeding a
+ * flood of presence and message stanzas to an XMPPParser in chunks of the
+ * size a connection typically delivers.
+ */
+
+class CountingXMPPParserClient : public XMPPParserClient {
+    public:
+        CountingXMPPParserClient() : elements(0) {
+        }
+
+        virtual void handleStreamStart(const ProtocolHeader&) {
+        }
+
+        virtual void handleElement(std::shared_ptr<ToplevelElement>) {
+            ++elements;
+        }
+
+        virtual void handleStreamEnd() {
+        }
+
+        size_t elements;
+};
+
+static std::string createStanzas(int count) {
+    std::string result;
+    for (int i = 0; i < count; ++i) {
+        std::string index = std::to_string(i);
+        if (i % 2 == 0) {
+            result +=
+                "<presence from='contact" + index + "@example.com/resource' to='me@example.com/swift'>"
+                    "<show>away</show>"
+                    "<status>Out to lunch</status>"
+                    "<priority>5</priority>"
+                    "<c xmlns='http://jabber.org/protocol/caps' hash='sha-1' node='http://swift.im' ver='ZvDOYCgl1oDtFVY/5DyrbGuTemw='/>"
+                "</presence>";
+        }
+        else {
+            result +=
+                "<message from='contact" + index + "@example.com/resource' to='me@example.com/swift' type='chat' id='msg" + index + "'>"
+                    "<body>Hello there, this is message number " + index + "</body>"
+                    "<active xmlns='http://jabber.org/protocol/chatstates'/>"
+                "</message>";
+        }
+    }
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    int stanzas = 100000;
+    size_t chunkSize = 4096;
+    if (argc > 1) {
+        stanzas = std::atoi(argv[1]);
+    }
+    if (argc > 2) {
+        chunkSize = static_cast<size_t>(std::atoi(argv[2]));
+    }
+    if (stanzas <= 0 || chunkSize == 0) {
+        std::cerr << "Usage: " << argv[0] << " [stanzas] [chunk size]" << std::endl;
+        return -1;
+    }
+
+    SafeByteArray data = createSafeByteArray(
+        "<stream:stream xmlns='jabber:client' xmlns:stream='http://etherx.jabber.org/streams' from='example.com' id='abc' version='1.0'>"
+        + createStanzas(stanzas));
+
+    FullPayloadParserFactoryCollection factories;
+    PlatformXMLParserFactory xmlParserFactory;
+    CountingXMPPParserClient client;
+    XMPPParser parser(&client, &factories, &xmlParserFactory);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t offset = 0; offset < data.size(); offset += chunkSize) {
+        size_t size = std::min(chunkSize, data.size() - offset);
+        if (!parser.parse(reinterpret_cast<const char*>(vecptr(data)) + offset, size)) {
+            std::cerr << "Parse error" << std::endl;
+            return -1;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << "Parsed " << client.elements << " stanzas (" << data.size() << " bytes) in " << seconds << "s: ";
+    std::cout << static_cast<double>(client.elements) / seconds << " stanzas/s" << std::endl;
+    return client.elements == static_cast<size_t>(stanzas) ? 0 : -1;
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,9 +8,11 @@
 
 #include <map>
 #include <set>
+#include <string>
 #include <vector>
 
 #include <boost/date_time/gregorian/gregorian_types.hpp>
+#include <boost/optional.hpp>
 
 #include <Swiften/Base/API.h>
 #include <Swiften/History/HistoryMessage.h>
@@ -19,6 +21,29 @@
 namespace Swift {
     typedef std::map<JID, std::set<boost::gregorian::date> > ContactsMap;
 
+    struct HistorySearchResult {
+        HistorySearchResult(const HistoryMessage& message, const std::string& snippet) : message(message), snippet(snippet) {}
+
+        HistoryMessage message;
+        // Part of the message around the matched keywords
+        std::string snippet;
+    };
+
+    /**
+     * A page of the messages of a conversation on a given date, in
+     * chronological order.
+     */
+    struct HistoryMessagePage {
+        std::vector<HistoryMessage> messages;
+        boost::gregorian::date date;
+        // IDs of the first and last messages, to request the adjacent pages
+        long long firstMessageID = 0;
+        long long lastMessageID = 0;
+        // Whether there are more messages past this page, in the requested
+        // direction
+        bool hasMore = false;
+    };
+
     class SWIFTEN_API HistoryStorage {
         /**
          * Messages are stored using localtime timestamps.
@@ -30,7 +55,35 @@ namespace Swift {
             virtual std::vector<HistoryMessage> getMessagesFromDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const = 0;
             virtual std::vector<HistoryMessage> getMessagesFromNextDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const = 0;
             virtual std::vector<HistoryMessage> getMessagesFromPreviousDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const = 0;
+            virtual boost::gregorian::date getNextDateWithLogs(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, bool reverseOrder) const = 0;
+
+            /**
+             * Returns at most pageSize messages from the given date, starting
+             * after the message with the given ID, or at the first message
+             * of the day if there is no ID.
+             */
+            virtual HistoryMessagePage getMessagesAfter(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, const boost::optional<long long>& afterMessageID, size_t pageSize) const = 0;
+
+            /**
+             * Returns at most pageSize messages from the given date, ending
+             * before the message with the given ID, or at the last message
+             * of the day if there is no ID.
+             */
+            virtual HistoryMessagePage getMessagesBefore(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, const boost::optional<long long>& beforeMessageID, size_t pageSize) const = 0;
+
+            /**
+             * Returns the dates of the conversations with each contact,
+             * keeping only the messages that contain the keyword (ignoring
+             * the case of ASCII letters) unless it is empty.
+             */
             virtual ContactsMap getContacts(const JID& selfJID, HistoryMessage::Type type, const std::string& keyword) const = 0;
+
+            /**
+             * Returns the messages containing all words of the keyword,
+             * best matches first. At most limit results are returned,
+             * starting from the result at the given offset.
+             */
+            virtual std::vector<HistorySearchResult> searchMessages(const JID& selfJID, HistoryMessage::Type type, const std::string& keyword, size_t offset, size_t limit) const = 0;
             virtual boost::posix_time::ptime getLastTimeStampFromMUC(const JID& selfJID, const JID& mucJID) const = 0;
     };
 }
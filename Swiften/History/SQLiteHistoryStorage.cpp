@@ -1,84 +1,339 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swiften/History/SQLiteHistoryStorage.h>
 
+#include <algorithm>
 #include <iostream>
+#include <sstream>
 
+#include <boost/algorithm/string/find.hpp>
+#include <boost/algorithm/string/replace.hpp>
 #include <boost/bind.hpp>
 #include <boost/date_time/gregorian/gregorian.hpp>
-#include <boost/lexical_cast.hpp>
 #include <boost/numeric/conversion/cast.hpp>
 
 #include <sqlite3.h>
 
 #include <Swiften/Base/Path.h>
 
-inline std::string getEscapedString(const std::string& s) {
-    std::string result(s);
+namespace {
+    // Resets a cached statement when it goes out of scope, so it doesn't keep
+    // a read transaction open.
+    class ScopedStatement {
+        public:
+            ScopedStatement(sqlite3_stmt* statement) : statement_(statement) {
+            }
 
-    size_t pos = result.find('\'');
-    while (pos != std::string::npos) {
-        result.insert(pos, "'");
-        pos = result.find('\'', pos + 2);
+            ~ScopedStatement() {
+                if (statement_) {
+                    sqlite3_reset(statement_);
+                    sqlite3_clear_bindings(statement_);
+                }
+            }
+
+            sqlite3_stmt* get() const {
+                return statement_;
+            }
+
+        private:
+            sqlite3_stmt* statement_;
+    };
+
+    std::string getColumnText(sqlite3_stmt* statement, int column) {
+        const unsigned char* text = sqlite3_column_text(statement, column);
+        return text ? std::string(reinterpret_cast<const char*>(text)) : std::string();
+    }
+
+    void bindText(sqlite3_stmt* statement, int parameter, const std::string& text) {
+        sqlite3_bind_text(statement, parameter, text.c_str(), boost::numeric_cast<int>(text.size()), SQLITE_TRANSIENT);
+    }
+
+    long long getSecondsSinceEpoch(const boost::posix_time::ptime& time) {
+        return (time - boost::posix_time::ptime(boost::gregorian::date(1970, 1, 1))).total_seconds();
+    }
+
+    boost::posix_time::ptime getTimeFromSecondsSinceEpoch(long long secondsSinceEpoch) {
+        return boost::posix_time::ptime(boost::gregorian::date(1970, 1, 1), boost::posix_time::seconds(static_cast<long>(secondsSinceEpoch)));
+    }
+
+    // Parameters: ?1 type, ?2 self ID, ?3 contact ID, ?4 contact resource
+    std::string getConversationCondition(const Swift::JID& contactJID) {
+        if (contactJID.isBare()) {
+            // match only bare jid
+            return "type=?1 AND ((fromBare=?2 AND toBare=?3) OR (fromBare=?3 AND toBare=?2))";
+        }
+        else {
+            // match resource too
+            return "type=?1 AND ((fromBare=?2 AND toBare=?3 AND toResource=?4) OR (fromBare=?3 AND fromResource=?4 AND toBare=?2))";
+        }
+    }
+
+    // Turns the words of a keyword into an FTS5 query matching messages that
+    // contain all words, or words starting with them.
+    std::string getSearchQuery(const std::string& keyword) {
+        std::string query;
+        std::istringstream words(keyword);
+        for (std::string word; words >> word; ) {
+            if (!query.empty()) {
+                query += " ";
+            }
+            query += "\"" + boost::replace_all_copy(word, "\"", "\"\"") + "\"*";
+        }
+        return query;
+    }
+
+    // Returns the part of the message around the first occurrence of the
+    // keyword, for when there is no search index to create snippets.
+    std::string getSnippet(const std::string& message, const std::string& keyword) {
+        static const size_t SNIPPET_CONTEXT_SIZE = 40;
+        size_t position = boost::algorithm::ifind_first(message, keyword).begin() - message.begin();
+        if (position >= message.size()) {
+            position = 0;
+        }
+        size_t start = position > SNIPPET_CONTEXT_SIZE ? position - SNIPPET_CONTEXT_SIZE : 0;
+        size_t end = std::min(message.size(), position + keyword.size() + SNIPPET_CONTEXT_SIZE);
+        // Don't cut UTF-8 sequences
+        while (start > 0 && (static_cast<unsigned char>(message[start]) & 0xC0) == 0x80) {
+            --start;
+        }
+        while (end < message.size() && (static_cast<unsigned char>(message[end]) & 0xC0) == 0x80) {
+            ++end;
+        }
+        return (start > 0 ? "..." : "") + message.substr(start, end - start) + (end < message.size() ? "..." : "");
+    }
+
+    void bindConversation(sqlite3_stmt* statement, const Swift::JID& contactJID, Swift::HistoryMessage::Type type, long long selfID, long long contactID) {
+        sqlite3_bind_int(statement, 1, type);
+        sqlite3_bind_int64(statement, 2, selfID);
+        sqlite3_bind_int64(statement, 3, contactID);
+        if (!contactJID.isBare()) {
+            bindText(statement, 4, contactJID.getResource());
+        }
     }
-    return result;
 }
 
 namespace Swift {
 
-SQLiteHistoryStorage::SQLiteHistoryStorage(const boost::filesystem::path& file) : db_(nullptr) {
-    thread_ = new std::thread(boost::bind(&SQLiteHistoryStorage::run, this));
-
+SQLiteHistoryStorage::SQLiteHistoryStorage(const boost::filesystem::path& file) : db_(nullptr), hasSearchIndex_(false), writingMessages_(false), stopping_(false), thread_(nullptr) {
     sqlite3_open(pathToString(file).c_str(), &db_);
     if (!db_) {
         std::cerr << "Error opening database " << pathToString(file) << std::endl;
     }
 
-    char* errorMessage;
-    int result = sqlite3_exec(db_, "CREATE TABLE IF NOT EXISTS messages('message' STRING, 'fromBare' INTEGER, 'fromResource' STRING, 'toBare' INTEGER, 'toResource' STRING, 'type' INTEGER, 'time' INTEGER, 'offset' INTEGER)", nullptr, nullptr, &errorMessage);
-    if (result != SQLITE_OK) {
-        std::cerr << "SQL Error: " << errorMessage << std::endl;
-        sqlite3_free(errorMessage);
+    // All queries share this connection, so reads and writes are serialised
+    // by dbMutex_ anyway. WAL mode only lets other connections read the
+    // database while a batch is written, and is ignored by SQLite versions
+    // without it (before 3.7.0).
+    execute("PRAGMA journal_mode=WAL");
+    execute("PRAGMA synchronous=NORMAL");
+
+    execute("CREATE TABLE IF NOT EXISTS messages('id' INTEGER PRIMARY KEY, 'message' STRING, 'fromBare' INTEGER, 'fromResource' STRING, 'toBare' INTEGER, 'toResource' STRING, 'type' INTEGER, 'time' INTEGER, 'offset' INTEGER)");
+    addMessageIDs();
+    execute("CREATE TABLE IF NOT EXISTS jids('id' INTEGER PRIMARY KEY ASC AUTOINCREMENT, 'jid' STRING UNIQUE NOT NULL)");
+    execute("CREATE INDEX IF NOT EXISTS messages_conversation ON messages('fromBare', 'toBare', 'time')");
+    execute("CREATE INDEX IF NOT EXISTS messages_recipient ON messages('toBare', 'time')");
+    hasSearchIndex_ = createSearchIndex();
+
+    thread_ = new std::thread(boost::bind(&SQLiteHistoryStorage::run, this));
+}
+
+SQLiteHistoryStorage::~SQLiteHistoryStorage() {
+    {
+        std::lock_guard<std::mutex> lock(pendingMessagesMutex_);
+        stopping_ = true;
+    }
+    pendingMessagesCondition_.notify_all();
+    thread_->join();
+    delete thread_;
+
+    for (const auto& statement : statements_) {
+        sqlite3_finalize(statement.second);
     }
+    sqlite3_close(db_);
+}
 
-    result = sqlite3_exec(db_, "CREATE TABLE IF NOT EXISTS jids('id' INTEGER PRIMARY KEY ASC AUTOINCREMENT, 'jid' STRING UNIQUE NOT NULL)", nullptr, nullptr, &errorMessage);
+void SQLiteHistoryStorage::execute(const char* statement) {
+    char* errorMessage = nullptr;
+    int result = sqlite3_exec(db_, statement, nullptr, nullptr, &errorMessage);
     if (result != SQLITE_OK) {
-        std::cerr << "SQL Error: " << errorMessage << std::endl;
+        std::cerr << "SQL Error: " << (errorMessage ? errorMessage : sqlite3_errmsg(db_)) << std::endl;
         sqlite3_free(errorMessage);
     }
 }
 
-SQLiteHistoryStorage::~SQLiteHistoryStorage() {
-    sqlite3_close(db_);
-    delete thread_;
+sqlite3_stmt* SQLiteHistoryStorage::getStatement(const std::string& query) const {
+    auto i = statements_.find(query);
+    if (i != statements_.end()) {
+        return i->second;
+    }
+    sqlite3_stmt* statement = nullptr;
+    int r = sqlite3_prepare_v2(db_, query.c_str(), boost::numeric_cast<int>(query.size()), &statement, nullptr);
+    if (r != SQLITE_OK) {
+        std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+        sqlite3_finalize(statement);
+        return nullptr;
+    }
+    statements_[query] = statement;
+    return statement;
+}
+
+void SQLiteHistoryStorage::addMessageIDs() {
+    // The search index and the message pages refer to messages by rowid,
+    // which VACUUM may change unless it is an INTEGER PRIMARY KEY. Older
+    // databases don't have one, so copy their messages into a table that
+    // does, keeping the rowids.
+    if (sqlite3_exec(db_, "SELECT id FROM messages LIMIT 1", nullptr, nullptr, nullptr) == SQLITE_OK) {
+        return;
+    }
+    execute("BEGIN TRANSACTION");
+    execute("CREATE TEMP TABLE messages_migration AS SELECT rowid AS id, message, fromBare, fromResource, toBare, toResource, type, time, offset FROM messages");
+    execute("DROP TABLE messages");
+    execute("CREATE TABLE messages('id' INTEGER PRIMARY KEY, 'message' STRING, 'fromBare' INTEGER, 'fromResource' STRING, 'toBare' INTEGER, 'toResource' STRING, 'type' INTEGER, 'time' INTEGER, 'offset' INTEGER)");
+    execute("INSERT INTO messages SELECT * FROM messages_migration ORDER BY id");
+    execute("DROP TABLE messages_migration");
+    execute("COMMIT TRANSACTION");
+}
+
+bool SQLiteHistoryStorage::createSearchIndex() {
+    // The index is kept up to date by writeMessages() rather than by
+    // triggers, so that the database can still be written with an SQLite
+    // without FTS5. The last indexed message is stored, to detect when the
+    // index needs to be rebuilt because of that.
+    if (sqlite3_exec(db_, "CREATE VIRTUAL TABLE IF NOT EXISTS messages_fts USING fts5(message, content='messages')", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    // Creating the table succeeds without FTS5 when an SQLite with FTS5
+    // already created it, so check that it can actually be searched
+    if (sqlite3_exec(db_, "SELECT rowid FROM messages_fts WHERE messages_fts MATCH 'swift' LIMIT 1", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    execute("CREATE TABLE IF NOT EXISTS messages_fts_state('id' INTEGER PRIMARY KEY, 'lastIndexedMessage' INTEGER)");
+
+    long long lastMessage = 0;
+    {
+        ScopedStatement statement(getStatement("SELECT max(rowid) FROM messages"));
+        if (statement.get() && sqlite3_step(statement.get()) == SQLITE_ROW) {
+            lastMessage = sqlite3_column_int64(statement.get(), 0);
+        }
+    }
+    boost::optional<long long> lastIndexedMessage;
+    {
+        ScopedStatement statement(getStatement("SELECT lastIndexedMessage FROM messages_fts_state WHERE id=1"));
+        if (statement.get() && sqlite3_step(statement.get()) == SQLITE_ROW) {
+            lastIndexedMessage = sqlite3_column_int64(statement.get(), 0);
+        }
+    }
+    if (!lastIndexedMessage || *lastIndexedMessage != lastMessage) {
+        execute("BEGIN TRANSACTION");
+        execute("INSERT INTO messages_fts(messages_fts) VALUES('rebuild')");
+        execute("INSERT OR REPLACE INTO messages_fts_state(id, lastIndexedMessage) SELECT 1, IFNULL(max(rowid), 0) FROM messages");
+        execute("COMMIT TRANSACTION");
+    }
+    return true;
 }
 
 void SQLiteHistoryStorage::addMessage(const HistoryMessage& message) {
-    int secondsSinceEpoch = (message.getTime() - boost::posix_time::ptime(boost::gregorian::date(1970, 1, 1))).total_seconds();
-
-    std::string statement = std::string("INSERT INTO messages('message', 'fromBare', 'fromResource', 'toBare', 'toResource', 'type', 'time', 'offset') VALUES(") +
-                    "'" + getEscapedString(message.getMessage()) + "', " +
-                    boost::lexical_cast<std::string>(getIDForJID(message.getFromJID().toBare())) + ", '" +
-                    getEscapedString(message.getFromJID().getResource()) + "', " +
-                    boost::lexical_cast<std::string>(getIDForJID(message.getToJID().toBare())) + ", '" +
-                    getEscapedString(message.getToJID().getResource()) + "', " +
-                    boost::lexical_cast<std::string>(message.getType()) + ", " +
-                    boost::lexical_cast<std::string>(secondsSinceEpoch) + ", " +
-                    boost::lexical_cast<std::string>(message.getOffset()) + ")";
-    char* errorMessage;
-    int result = sqlite3_exec(db_, statement.c_str(), nullptr, nullptr, &errorMessage);
-    if (result != SQLITE_OK) {
-        std::cerr << "SQL Error: " << errorMessage << std::endl;
-        sqlite3_free(errorMessage);
+    {
+        std::lock_guard<std::mutex> lock(pendingMessagesMutex_);
+        pendingMessages_.push_back(message);
+    }
+    pendingMessagesCondition_.notify_all();
+}
+
+void SQLiteHistoryStorage::run() {
+    std::vector<HistoryMessage> messages;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(pendingMessagesMutex_);
+            writingMessages_ = false;
+            pendingMessagesCondition_.notify_all();
+            while (!stopping_ && pendingMessages_.empty()) {
+                pendingMessagesCondition_.wait(lock);
+            }
+            if (pendingMessages_.empty()) {
+                return;
+            }
+            messages.swap(pendingMessages_);
+            writingMessages_ = true;
+        }
+        writeMessages(messages);
+        messages.clear();
+    }
+}
+
+void SQLiteHistoryStorage::waitForPendingMessages() const {
+    std::unique_lock<std::mutex> lock(pendingMessagesMutex_);
+    while (writingMessages_ || !pendingMessages_.empty()) {
+        pendingMessagesCondition_.wait(lock);
+    }
+}
+
+void SQLiteHistoryStorage::writeMessages(const std::vector<HistoryMessage>& messages) {
+    std::lock_guard<std::recursive_mutex> lock(dbMutex_);
+    execute("BEGIN TRANSACTION");
+    bool indexed = true;
+    for (const auto& message : messages) {
+        long long fromID = getIDForJID(message.getFromJID().toBare());
+        long long toID = getIDForJID(message.getToJID().toBare());
+
+        ScopedStatement statement(getStatement("INSERT INTO messages('message', 'fromBare', 'fromResource', 'toBare', 'toResource', 'type', 'time', 'offset') VALUES(?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8)"));
+        if (!statement.get()) {
+            rollbackMessages(messages);
+            return;
+        }
+        bindText(statement.get(), 1, message.getMessage());
+        sqlite3_bind_int64(statement.get(), 2, fromID);
+        bindText(statement.get(), 3, message.getFromJID().getResource());
+        sqlite3_bind_int64(statement.get(), 4, toID);
+        bindText(statement.get(), 5, message.getToJID().getResource());
+        sqlite3_bind_int(statement.get(), 6, message.getType());
+        sqlite3_bind_int64(statement.get(), 7, getSecondsSinceEpoch(message.getTime()));
+        sqlite3_bind_int(statement.get(), 8, message.getOffset());
+        if (sqlite3_step(statement.get()) != SQLITE_DONE) {
+            std::cerr << "SQL Error: " << sqlite3_errmsg(db_) << std::endl;
+            rollbackMessages(messages);
+            return;
+        }
+
+        if (hasSearchIndex_) {
+            ScopedStatement indexStatement(getStatement("INSERT INTO messages_fts(rowid, message) VALUES(?1, ?2)"));
+            if (indexStatement.get()) {
+                sqlite3_bind_int64(indexStatement.get(), 1, sqlite3_last_insert_rowid(db_));
+                bindText(indexStatement.get(), 2, message.getMessage());
+                if (sqlite3_step(indexStatement.get()) != SQLITE_DONE) {
+                    std::cerr << "SQL Error: " << sqlite3_errmsg(db_) << std::endl;
+                    indexed = false;
+                }
+            }
+            else {
+                indexed = false;
+            }
+        }
+    }
+    // Leave the index marked as out of date when a message is missing from
+    // it, so that it gets rebuilt the next time the database is opened
+    if (hasSearchIndex_ && indexed) {
+        execute("UPDATE messages_fts_state SET lastIndexedMessage=(SELECT IFNULL(max(rowid), 0) FROM messages) WHERE id=1");
     }
+    execute("COMMIT TRANSACTION");
+}
+
+void SQLiteHistoryStorage::rollbackMessages(const std::vector<HistoryMessage>& messages) {
+    // Don't commit part of a batch; the JIDs added in the transaction are
+    // gone as well, so their cached IDs can't be used anymore.
+    std::cerr << "Error writing " << messages.size() << " messages to the history" << std::endl;
+    execute("ROLLBACK TRANSACTION");
+    idsByJID_.clear();
+    jidsByID_.clear();
 }
 
 std::vector<HistoryMessage> SQLiteHistoryStorage::getMessagesFromDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const {
-    sqlite3_stmt* selectStatement;
+    waitForPendingMessages();
+    std::lock_guard<std::recursive_mutex> lock(dbMutex_);
 
     boost::optional<long long> selfID = getIDFromJID(selfJID.toBare());
     boost::optional<long long> contactID = getIDFromJID(contactJID.toBare());
@@ -88,75 +343,65 @@ std::vector<HistoryMessage> SQLiteHistoryStorage::getMessagesFromDate(const JID&
         return std::vector<HistoryMessage>();
     }
 
-    std::string selectQuery = "SELECT * FROM messages WHERE (type=" + boost::lexical_cast<std::string>(type);
-    if (contactJID.isBare()) {
-        // match only bare jid
-        selectQuery += " AND ((fromBare=" + boost::lexical_cast<std::string>(*selfID) + " AND toBare=" +
-                boost::lexical_cast<std::string>(*contactID) + ") OR (fromBare=" +
-                boost::lexical_cast<std::string>(*contactID) + " AND toBare=" + boost::lexical_cast<std::string>(*selfID) + ")))";
-    }
-    else {
-        // match resource too
-        selectQuery += " AND ((fromBare=" + boost::lexical_cast<std::string>(*selfID) + " AND (toBare=" +
-                boost::lexical_cast<std::string>(*contactID) +" AND toResource='" +
-                getEscapedString(contactJID.getResource()) + "')) OR ((fromBare=" +
-                boost::lexical_cast<std::string>(*contactID) + " AND fromResource='" +
-                getEscapedString(contactJID.getResource()) + "') AND toBare=" +
-                boost::lexical_cast<std::string>(*selfID) + ")))";
-    }
-
+    std::string selectQuery = "SELECT message, fromBare, fromResource, toBare, toResource, type, time, offset FROM messages WHERE " + getConversationCondition(contactJID);
     if (!date.is_not_a_date()) {
-        int lowerBound = (boost::posix_time::ptime(date) - boost::posix_time::ptime(boost::gregorian::date(1970, 1, 1))).total_seconds();
-        int upperBound = lowerBound + 86400;
-
-        selectQuery += " AND (time>=" + boost::lexical_cast<std::string>(lowerBound) +
-                " AND time<" + boost::lexical_cast<std::string>(upperBound) + ")";
+        selectQuery += " AND time>=?5 AND time<?6";
     }
+    selectQuery += " ORDER BY rowid";
 
-    int r = sqlite3_prepare(db_, selectQuery.c_str(), boost::numeric_cast<int>(selectQuery.size()), &selectStatement, nullptr);
-    if (r != SQLITE_OK) {
-        std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+    ScopedStatement selectStatement(getStatement(selectQuery));
+    if (!selectStatement.get()) {
+        return std::vector<HistoryMessage>();
+    }
+    bindConversation(selectStatement.get(), contactJID, type, *selfID, *contactID);
+    if (!date.is_not_a_date()) {
+        long long lowerBound = getSecondsSinceEpoch(boost::posix_time::ptime(date));
+        sqlite3_bind_int64(selectStatement.get(), 5, lowerBound);
+        sqlite3_bind_int64(selectStatement.get(), 6, lowerBound + 86400);
     }
-    r = sqlite3_step(selectStatement);
 
     // Retrieve result
     std::vector<HistoryMessage> result;
+    int r = sqlite3_step(selectStatement.get());
     while (r == SQLITE_ROW) {
-        std::string message(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 0)));
+        result.push_back(getMessageFromRow(selectStatement.get()));
+        r = sqlite3_step(selectStatement.get());
+    }
+    if (r != SQLITE_DONE) {
+        std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+    }
 
-        // fromJID
-        boost::optional<JID> fromJID(getJIDFromID(sqlite3_column_int(selectStatement, 1)));
-        std::string fromResource(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 2)));
-        if (fromJID) {
-            fromJID = boost::optional<JID>(JID(fromJID->getNode(), fromJID->getDomain(), fromResource));
-        }
+    return result;
+}
 
-        // toJID
-        boost::optional<JID> toJID(getJIDFromID(sqlite3_column_int(selectStatement, 3)));
-        std::string toResource(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 4)));
-        if (toJID) {
-            toJID = boost::optional<JID>(JID(toJID->getNode(), toJID->getDomain(), toResource));
-        }
+// Columns: message, fromBare, fromResource, toBare, toResource, type, time, offset
+HistoryMessage SQLiteHistoryStorage::getMessageFromRow(sqlite3_stmt* statement) const {
+    std::string message(getColumnText(statement, 0));
 
-        // message type
-        HistoryMessage::Type type = static_cast<HistoryMessage::Type>(sqlite3_column_int(selectStatement, 5));
+    // fromJID
+    boost::optional<JID> fromJID(getJIDFromID(sqlite3_column_int64(statement, 1)));
+    std::string fromResource(getColumnText(statement, 2));
+    if (fromJID) {
+        fromJID = boost::optional<JID>(JID(fromJID->getNode(), fromJID->getDomain(), fromResource));
+    }
 
-        // timestamp
-        int secondsSinceEpoch(sqlite3_column_int(selectStatement, 6));
-        boost::posix_time::ptime time(boost::gregorian::date(1970, 1, 1), boost::posix_time::seconds(secondsSinceEpoch));
+    // toJID
+    boost::optional<JID> toJID(getJIDFromID(sqlite3_column_int64(statement, 3)));
+    std::string toResource(getColumnText(statement, 4));
+    if (toJID) {
+        toJID = boost::optional<JID>(JID(toJID->getNode(), toJID->getDomain(), toResource));
+    }
 
-        // offset from utc
-        int offset = sqlite3_column_int(selectStatement, 7);
+    // message type
+    HistoryMessage::Type type = static_cast<HistoryMessage::Type>(sqlite3_column_int(statement, 5));
 
-        result.push_back(HistoryMessage(message, (fromJID ? *fromJID : JID()), (toJID ? *toJID : JID()), type, time, offset));
-        r = sqlite3_step(selectStatement);
-    }
-    if (r != SQLITE_DONE) {
-        std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
-    }
-    sqlite3_finalize(selectStatement);
+    // timestamp
+    boost::posix_time::ptime time(getTimeFromSecondsSinceEpoch(sqlite3_column_int64(statement, 6)));
 
-    return result;
+    // offset from utc
+    int offset = sqlite3_column_int(statement, 7);
+
+    return HistoryMessage(message, (fromJID ? *fromJID : JID()), (toJID ? *toJID : JID()), type, time, offset);
 }
 
 long long SQLiteHistoryStorage::getIDForJID(const JID& jid) {
@@ -170,51 +415,68 @@ long long SQLiteHistoryStorage::getIDForJID(const JID& jid) {
 }
 
 long long SQLiteHistoryStorage::addJID(const JID& jid) {
-    std::string statement = std::string("INSERT INTO jids('jid') VALUES('") + getEscapedString(jid.toString()) + "')";
-    char* errorMessage;
-    int result = sqlite3_exec(db_, statement.c_str(), nullptr, nullptr, &errorMessage);
-    if (result != SQLITE_OK) {
-        std::cerr << "SQL Error: " << errorMessage << std::endl;
-        sqlite3_free(errorMessage);
-    }
-    return sqlite3_last_insert_rowid(db_);
+    std::string jidString = jid.toString();
+    ScopedStatement statement(getStatement("INSERT INTO jids('jid') VALUES(?1)"));
+    if (!statement.get()) {
+        return 0;
+    }
+    bindText(statement.get(), 1, jidString);
+    if (sqlite3_step(statement.get()) != SQLITE_DONE) {
+        std::cerr << "SQL Error: " << sqlite3_errmsg(db_) << std::endl;
+    }
+    long long id = sqlite3_last_insert_rowid(db_);
+    idsByJID_[jidString] = id;
+    jidsByID_.insert(std::make_pair(id, jid));
+    return id;
 }
 
 boost::optional<JID> SQLiteHistoryStorage::getJIDFromID(long long id) const {
+    auto cached = jidsByID_.find(id);
+    if (cached != jidsByID_.end()) {
+        return cached->second;
+    }
+
     boost::optional<JID> result;
-    sqlite3_stmt* selectStatement;
-    std::string selectQuery("SELECT jid FROM jids WHERE id=" + boost::lexical_cast<std::string>(id));
-    int r = sqlite3_prepare(db_, selectQuery.c_str(), boost::numeric_cast<int>(selectQuery.size()), &selectStatement, nullptr);
-    if (r != SQLITE_OK) {
-        std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+    ScopedStatement selectStatement(getStatement("SELECT jid FROM jids WHERE id=?1"));
+    if (!selectStatement.get()) {
+        return result;
     }
-    r = sqlite3_step(selectStatement);
-    if (r == SQLITE_ROW) {
-        result = boost::optional<JID>(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 0)));
+    sqlite3_bind_int64(selectStatement.get(), 1, id);
+    if (sqlite3_step(selectStatement.get()) == SQLITE_ROW) {
+        std::string jid(getColumnText(selectStatement.get(), 0));
+        result = boost::optional<JID>(JID(jid));
+        jidsByID_.insert(std::make_pair(id, *result));
+        idsByJID_[jid] = id;
     }
-    sqlite3_finalize(selectStatement);
     return result;
 }
 
 boost::optional<long long> SQLiteHistoryStorage::getIDFromJID(const JID& jid) const {
+    std::string jidString = jid.toString();
+    auto cached = idsByJID_.find(jidString);
+    if (cached != idsByJID_.end()) {
+        return cached->second;
+    }
+
     boost::optional<long long> result;
-    sqlite3_stmt* selectStatement;
-    std::string selectQuery("SELECT id FROM jids WHERE jid='" + jid.toString() + "'");
-    long long r = sqlite3_prepare(db_, selectQuery.c_str(), boost::numeric_cast<int>(selectQuery.size()), &selectStatement, nullptr);
-    if (r != SQLITE_OK) {
-        std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+    ScopedStatement selectStatement(getStatement("SELECT id FROM jids WHERE jid=?1"));
+    if (!selectStatement.get()) {
+        return result;
     }
-    r = sqlite3_step(selectStatement);
-    if (r == SQLITE_ROW) {
-        result = boost::optional<long long>(sqlite3_column_int(selectStatement, 0));
+    bindText(selectStatement.get(), 1, jidString);
+    if (sqlite3_step(selectStatement.get()) == SQLITE_ROW) {
+        result = boost::optional<long long>(sqlite3_column_int64(selectStatement.get(), 0));
+        idsByJID_[jidString] = *result;
+        jidsByID_.insert(std::make_pair(*result, jid));
     }
-    sqlite3_finalize(selectStatement);
     return result;
 }
 
 ContactsMap SQLiteHistoryStorage::getContacts(const JID& selfJID, HistoryMessage::Type type, const std::string& keyword) const {
+    waitForPendingMessages();
+    std::lock_guard<std::recursive_mutex> lock(dbMutex_);
+
     ContactsMap result;
-    sqlite3_stmt* selectStatement;
 
     // get id
     boost::optional<long long> id = getIDFromJID(selfJID);
@@ -222,32 +484,37 @@ ContactsMap SQLiteHistoryStorage::getContacts(const JID& selfJID, HistoryMessage
         return result;
     }
 
-    // get contacts
-    std::string query = "SELECT DISTINCT messages.'fromBare', messages.'fromResource', messages.'toBare', messages.'toResource', messages.'time' "
-        "FROM messages WHERE (type="
-        + boost::lexical_cast<std::string>(type) + " AND (toBare="
-        + boost::lexical_cast<std::string>(*id) + " OR fromBare=" + boost::lexical_cast<std::string>(*id) + "))";
-
-    // match keyword
-    if (getEscapedString(keyword).length()) {
-        query += " AND message LIKE '%" + getEscapedString(keyword) + "%'";
+    // get contacts, with one row per contact and day
+    std::string query = "SELECT DISTINCT messages.'fromBare', messages.'fromResource', messages.'toBare', messages.'toResource', messages.'time'/86400 ";
+    if (keyword.empty()) {
+        query += "FROM messages WHERE (type=?1 AND (toBare=?2 OR fromBare=?2))";
+    }
+    else {
+        // The keyword is matched anywhere in the message, like new messages
+        // are matched by the history view, so the search index (which only
+        // matches the start of words) isn't used here.
+        query += "FROM messages WHERE (type=?1 AND (toBare=?2 OR fromBare=?2)) AND message LIKE ?3";
     }
 
-    int r = sqlite3_prepare(db_, query.c_str(), boost::numeric_cast<int>(query.size()), &selectStatement, nullptr);
-    if (r != SQLITE_OK) {
-        std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+    ScopedStatement selectStatement(getStatement(query));
+    if (!selectStatement.get()) {
+        return result;
+    }
+    sqlite3_bind_int(selectStatement.get(), 1, type);
+    sqlite3_bind_int64(selectStatement.get(), 2, *id);
+    if (!keyword.empty()) {
+        bindText(selectStatement.get(), 3, "%" + keyword + "%");
     }
 
-    r = sqlite3_step(selectStatement);
+    int r = sqlite3_step(selectStatement.get());
     while (r == SQLITE_ROW) {
-        int fromBareID = sqlite3_column_int(selectStatement, 0);
-        std::string fromResource(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 1)));
-        int toBareID = sqlite3_column_int(selectStatement, 2);
-        std::string toResource(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 3)));
+        long long fromBareID = sqlite3_column_int64(selectStatement.get(), 0);
+        std::string fromResource(getColumnText(selectStatement.get(), 1));
+        long long toBareID = sqlite3_column_int64(selectStatement.get(), 2);
+        std::string toResource(getColumnText(selectStatement.get(), 3));
         std::string resource;
 
-        int secondsSinceEpoch(sqlite3_column_int(selectStatement, 4));
-        boost::posix_time::ptime time(boost::gregorian::date(1970, 1, 1), boost::posix_time::seconds(secondsSinceEpoch));
+        boost::gregorian::date date(boost::gregorian::date(1970, 1, 1) + boost::gregorian::days(static_cast<long>(sqlite3_column_int64(selectStatement.get(), 4))));
 
         boost::optional<JID> contactJID;
 
@@ -261,27 +528,28 @@ ContactsMap SQLiteHistoryStorage::getContacts(const JID& selfJID, HistoryMessage
         }
 
         // check if it is a MUC contact (from a private conversation)
-        if (type == HistoryMessage::PrivateMessage) {
+        if (type == HistoryMessage::PrivateMessage && contactJID) {
             contactJID = boost::optional<JID>(JID(contactJID->getNode(), contactJID->getDomain(), resource));
         }
 
         if (contactJID) {
-            result[*contactJID].insert(time.date());
+            result[*contactJID].insert(date);
         }
 
-        r = sqlite3_step(selectStatement);
+        r = sqlite3_step(selectStatement.get());
     }
 
     if (r != SQLITE_DONE) {
         std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
     }
-    sqlite3_finalize(selectStatement);
 
     return result;
 }
 
 boost::gregorian::date SQLiteHistoryStorage::getNextDateWithLogs(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, bool reverseOrder) const {
-    sqlite3_stmt* selectStatement;
+    waitForPendingMessages();
+    std::lock_guard<std::recursive_mutex> lock(dbMutex_);
+
     boost::optional<long long> selfID = getIDFromJID(selfJID.toBare());
     boost::optional<long long> contactID = getIDFromJID(contactJID.toBare());
 
@@ -290,39 +558,18 @@ boost::gregorian::date SQLiteHistoryStorage::getNextDateWithLogs(const JID& self
         return boost::gregorian::date(boost::gregorian::not_a_date_time);
     }
 
-    std::string selectQuery = "SELECT time FROM messages WHERE (type=" + boost::lexical_cast<std::string>(type);
-    if (contactJID.isBare()) {
-        // match only bare jid
-        selectQuery += " AND ((fromBare=" + boost::lexical_cast<std::string>(*selfID) + " AND toBare=" +
-                boost::lexical_cast<std::string>(*contactID) + ") OR (fromBare=" +
-                boost::lexical_cast<std::string>(*contactID) + " AND toBare=" + boost::lexical_cast<std::string>(*selfID) + ")))";
-    }
-    else {
-        // match resource too
-        selectQuery += " AND ((fromBare=" + boost::lexical_cast<std::string>(*selfID) + " AND (toBare=" +
-                boost::lexical_cast<std::string>(*contactID) +" AND toResource='" +
-                getEscapedString(contactJID.getResource()) + "')) OR ((fromBare=" +
-                boost::lexical_cast<std::string>(*contactID) + " AND fromResource='" +
-                getEscapedString(contactJID.getResource()) + "') AND toBare=" +
-                boost::lexical_cast<std::string>(*selfID) + ")))";
-    }
-
-    int timeStamp = (boost::posix_time::ptime(date) - boost::posix_time::ptime(boost::gregorian::date(1970, 1, 1))).total_seconds() + (reverseOrder ? 0 : 86400);
-
-    selectQuery += " AND time" + (reverseOrder ? std::string("<") : std::string(">")) + boost::lexical_cast<std::string>(timeStamp);
-    selectQuery += " ORDER BY time " + (reverseOrder ? std::string("DESC") : std::string("ASC")) + " LIMIT 1";
+    std::string selectQuery = "SELECT time FROM messages WHERE " + getConversationCondition(contactJID);
+    selectQuery += reverseOrder ? " AND time<?5 ORDER BY time DESC LIMIT 1" : " AND time>?5 ORDER BY time ASC LIMIT 1";
 
-    int r = sqlite3_prepare(db_, selectQuery.c_str(), boost::numeric_cast<int>(selectQuery.size()), &selectStatement, nullptr);
-    if (r != SQLITE_OK) {
-        std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+    ScopedStatement selectStatement(getStatement(selectQuery));
+    if (!selectStatement.get()) {
+        return boost::gregorian::date(boost::gregorian::not_a_date_time);
     }
+    bindConversation(selectStatement.get(), contactJID, type, *selfID, *contactID);
+    sqlite3_bind_int64(selectStatement.get(), 5, getSecondsSinceEpoch(boost::posix_time::ptime(date)) + (reverseOrder ? 0 : 86400));
 
-    r = sqlite3_step(selectStatement);
-    if (r == SQLITE_ROW) {
-        int secondsSinceEpoch(sqlite3_column_int(selectStatement, 0));
-        boost::posix_time::ptime time(boost::gregorian::date(1970, 1, 1), boost::posix_time::seconds(secondsSinceEpoch));
-        std::cout << "next day is: " << time.date() << "\n";
-        return time.date();
+    if (sqlite3_step(selectStatement.get()) == SQLITE_ROW) {
+        return getTimeFromSecondsSinceEpoch(sqlite3_column_int64(selectStatement.get(), 0)).date();
     }
 
     return boost::gregorian::date(boost::gregorian::not_a_date_time);
@@ -348,7 +595,89 @@ std::vector<HistoryMessage> SQLiteHistoryStorage::getMessagesFromPreviousDate(co
     return getMessagesFromDate(selfJID, contactJID, type, previousDate);
 }
 
+HistoryMessagePage SQLiteHistoryStorage::getMessagesAfter(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, const boost::optional<long long>& afterMessageID, size_t pageSize) const {
+    return getMessagePage(selfJID, contactJID, type, date, afterMessageID, false, pageSize);
+}
+
+HistoryMessagePage SQLiteHistoryStorage::getMessagesBefore(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, const boost::optional<long long>& beforeMessageID, size_t pageSize) const {
+    return getMessagePage(selfJID, contactJID, type, date, beforeMessageID, true, pageSize);
+}
+
+HistoryMessagePage SQLiteHistoryStorage::getMessagePage(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, const boost::optional<long long>& messageID, bool reverseOrder, size_t pageSize) const {
+    HistoryMessagePage page;
+    page.date = date;
+    if (pageSize == 0) {
+        return page;
+    }
+
+    waitForPendingMessages();
+    std::lock_guard<std::recursive_mutex> lock(dbMutex_);
+
+    boost::optional<long long> selfID = getIDFromJID(selfJID.toBare());
+    boost::optional<long long> contactID = getIDFromJID(contactJID.toBare());
+
+    if (!selfID || !contactID) {
+        // JIDs missing from the database
+        return page;
+    }
+
+    // Pages are delimited by rowid instead of an offset, so that fetching a
+    // page doesn't scan the preceding ones.
+    std::string selectQuery = "SELECT message, fromBare, fromResource, toBare, toResource, type, time, offset, rowid FROM messages WHERE " + getConversationCondition(contactJID);
+    if (!date.is_not_a_date()) {
+        selectQuery += " AND time>=?5 AND time<?6";
+    }
+    if (messageID) {
+        selectQuery += reverseOrder ? " AND rowid<?7" : " AND rowid>?7";
+    }
+    selectQuery += reverseOrder ? " ORDER BY rowid DESC LIMIT ?8" : " ORDER BY rowid ASC LIMIT ?8";
+
+    ScopedStatement selectStatement(getStatement(selectQuery));
+    if (!selectStatement.get()) {
+        return page;
+    }
+    bindConversation(selectStatement.get(), contactJID, type, *selfID, *contactID);
+    if (!date.is_not_a_date()) {
+        long long lowerBound = getSecondsSinceEpoch(boost::posix_time::ptime(date));
+        sqlite3_bind_int64(selectStatement.get(), 5, lowerBound);
+        sqlite3_bind_int64(selectStatement.get(), 6, lowerBound + 86400);
+    }
+    if (messageID) {
+        sqlite3_bind_int64(selectStatement.get(), 7, *messageID);
+    }
+    // Fetch one more message to know whether there is a next page
+    sqlite3_bind_int64(selectStatement.get(), 8, boost::numeric_cast<long long>(pageSize) + 1);
+
+    std::vector<long long> ids;
+    int r = sqlite3_step(selectStatement.get());
+    while (r == SQLITE_ROW) {
+        if (page.messages.size() == pageSize) {
+            page.hasMore = true;
+            break;
+        }
+        page.messages.push_back(getMessageFromRow(selectStatement.get()));
+        ids.push_back(sqlite3_column_int64(selectStatement.get(), 8));
+        r = sqlite3_step(selectStatement.get());
+    }
+    if (r != SQLITE_ROW && r != SQLITE_DONE) {
+        std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+    }
+
+    if (reverseOrder) {
+        std::reverse(page.messages.begin(), page.messages.end());
+        std::reverse(ids.begin(), ids.end());
+    }
+    if (!ids.empty()) {
+        page.firstMessageID = ids.front();
+        page.lastMessageID = ids.back();
+    }
+    return page;
+}
+
 boost::posix_time::ptime SQLiteHistoryStorage::getLastTimeStampFromMUC(const JID& selfJID, const JID& mucJID) const {
+    waitForPendingMessages();
+    std::lock_guard<std::recursive_mutex> lock(dbMutex_);
+
     boost::optional<long long> selfID = getIDFromJID(selfJID.toBare());
     boost::optional<long long> mucID = getIDFromJID(mucJID.toBare());
 
@@ -357,22 +686,16 @@ boost::posix_time::ptime SQLiteHistoryStorage::getLastTimeStampFromMUC(const JID
         return boost::posix_time::ptime(boost::posix_time::not_a_date_time);
     }
 
-
-    sqlite3_stmt* selectStatement;
-    std::string selectQuery = "SELECT messages.'time', messages.'offset' from messages WHERE type=1 AND (toBare=" +
-                boost::lexical_cast<std::string>(*selfID) + " AND fromBare=" +
-                boost::lexical_cast<std::string>(*mucID) + ") ORDER BY time DESC LIMIT 1";
-
-    int r = sqlite3_prepare(db_, selectQuery.c_str(), boost::numeric_cast<int>(selectQuery.size()), &selectStatement, nullptr);
-    if (r != SQLITE_OK) {
-        std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+    ScopedStatement selectStatement(getStatement("SELECT messages.'time', messages.'offset' from messages WHERE type=1 AND (toBare=?1 AND fromBare=?2) ORDER BY time DESC LIMIT 1"));
+    if (!selectStatement.get()) {
+        return boost::posix_time::ptime(boost::posix_time::not_a_date_time);
     }
+    sqlite3_bind_int64(selectStatement.get(), 1, *selfID);
+    sqlite3_bind_int64(selectStatement.get(), 2, *mucID);
 
-    r = sqlite3_step(selectStatement);
-    if (r == SQLITE_ROW) {
-        int secondsSinceEpoch(sqlite3_column_int(selectStatement, 0));
-        boost::posix_time::ptime time(boost::gregorian::date(1970, 1, 1), boost::posix_time::seconds(secondsSinceEpoch));
-        int offset = sqlite3_column_int(selectStatement, 1);
+    if (sqlite3_step(selectStatement.get()) == SQLITE_ROW) {
+        boost::posix_time::ptime time(getTimeFromSecondsSinceEpoch(sqlite3_column_int64(selectStatement.get(), 0)));
+        int offset = sqlite3_column_int(selectStatement.get(), 1);
 
         return time - boost::posix_time::hours(offset);
     }
@@ -380,7 +703,55 @@ boost::posix_time::ptime SQLiteHistoryStorage::getLastTimeStampFromMUC(const JID
     return boost::posix_time::ptime(boost::posix_time::not_a_date_time);
 }
 
-void SQLiteHistoryStorage::run() {
+std::vector<HistorySearchResult> SQLiteHistoryStorage::searchMessages(const JID& selfJID, HistoryMessage::Type type, const std::string& keyword, size_t offset, size_t limit) const {
+    waitForPendingMessages();
+    std::lock_guard<std::recursive_mutex> lock(dbMutex_);
+
+    std::vector<HistorySearchResult> result;
+    boost::optional<long long> id = getIDFromJID(selfJID);
+    if (!id || limit == 0) {
+        return result;
+    }
+
+    std::string query;
+    std::string searchQuery = getSearchQuery(keyword);
+    if (searchQuery.empty()) {
+        return result;
+    }
+    if (hasSearchIndex_) {
+        query = "SELECT messages.message, fromBare, fromResource, toBare, toResource, type, time, offset, snippet(messages_fts, 0, '', '', '...', 16) "
+            "FROM messages_fts JOIN messages ON messages.rowid=messages_fts.rowid "
+            "WHERE messages_fts MATCH ?3 AND (type=?1 AND (toBare=?2 OR fromBare=?2)) "
+            "ORDER BY messages_fts.rank LIMIT ?4 OFFSET ?5";
+    }
+    else {
+        // Without an index, the most recent matches come first
+        query = "SELECT message, fromBare, fromResource, toBare, toResource, type, time, offset "
+            "FROM messages WHERE (type=?1 AND (toBare=?2 OR fromBare=?2)) AND message LIKE ?3 "
+            "ORDER BY time DESC LIMIT ?4 OFFSET ?5";
+    }
+
+    ScopedStatement selectStatement(getStatement(query));
+    if (!selectStatement.get()) {
+        return result;
+    }
+    sqlite3_bind_int(selectStatement.get(), 1, type);
+    sqlite3_bind_int64(selectStatement.get(), 2, *id);
+    bindText(selectStatement.get(), 3, hasSearchIndex_ ? searchQuery : "%" + keyword + "%");
+    sqlite3_bind_int64(selectStatement.get(), 4, boost::numeric_cast<long long>(limit));
+    sqlite3_bind_int64(selectStatement.get(), 5, boost::numeric_cast<long long>(offset));
+
+    int r = sqlite3_step(selectStatement.get());
+    while (r == SQLITE_ROW) {
+        HistoryMessage message = getMessageFromRow(selectStatement.get());
+        std::string snippet = hasSearchIndex_ ? getColumnText(selectStatement.get(), 8) : getSnippet(message.getMessage(), keyword);
+        result.push_back(HistorySearchResult(message, snippet));
+        r = sqlite3_step(selectStatement.get());
+    }
+    if (r != SQLITE_DONE) {
+        std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+    }
+    return result;
 }
 
 }
@@ -1,12 +1,18 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include <boost/filesystem/path.hpp>
 #include <boost/optional.hpp>
@@ -15,8 +21,18 @@
 #include <Swiften/History/HistoryStorage.h>
 
 struct sqlite3;
+struct sqlite3_stmt;
 
 namespace Swift {
+    /**
+     * Stores the history in an SQLite database.
+     *
+     * Added messages are written on a background thread, in one transaction
+     * per batch. Queries first wait for the pending messages to be written.
+     *
+     * When SQLite is built with FTS5, messages are indexed for keyword
+     * searches. Otherwise, searches scan all messages.
+     */
     class SWIFTEN_API SQLiteHistoryStorage : public HistoryStorage {
         public:
             SQLiteHistoryStorage(const boost::filesystem::path& file);
@@ -27,11 +43,24 @@ namespace Swift {
             std::vector<HistoryMessage> getMessagesFromDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const;
             std::vector<HistoryMessage> getMessagesFromNextDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const;
             std::vector<HistoryMessage> getMessagesFromPreviousDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const;
+            boost::gregorian::date getNextDateWithLogs(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, bool reverseOrder) const;
+            HistoryMessagePage getMessagesAfter(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, const boost::optional<long long>& afterMessageID, size_t pageSize) const;
+            HistoryMessagePage getMessagesBefore(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, const boost::optional<long long>& beforeMessageID, size_t pageSize) const;
             boost::posix_time::ptime getLastTimeStampFromMUC(const JID& selfJID, const JID& mucJID) const;
+            std::vector<HistorySearchResult> searchMessages(const JID& selfJID, HistoryMessage::Type type, const std::string& keyword, size_t offset, size_t limit) const;
 
         private:
             void run();
-            boost::gregorian::date getNextDateWithLogs(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, bool reverseOrder) const;
+            void writeMessages(const std::vector<HistoryMessage>& messages);
+            void rollbackMessages(const std::vector<HistoryMessage>& messages);
+            void waitForPendingMessages() const;
+            void execute(const char* statement);
+            sqlite3_stmt* getStatement(const std::string& query) const;
+            void addMessageIDs();
+            bool createSearchIndex();
+            HistoryMessage getMessageFromRow(sqlite3_stmt* statement) const;
+
+            HistoryMessagePage getMessagePage(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, const boost::optional<long long>& messageID, bool reverseOrder, size_t pageSize) const;
             long long getIDForJID(const JID&);
             long long addJID(const JID&);
 
@@ -39,6 +68,18 @@ namespace Swift {
             boost::optional<long long> getIDFromJID(const JID& jid) const;
 
             sqlite3* db_;
+            bool hasSearchIndex_;
+            // Protects the database, the statements and the JID caches
+            mutable std::recursive_mutex dbMutex_;
+            mutable std::map<std::string, sqlite3_stmt*> statements_;
+            mutable std::unordered_map<std::string, long long> idsByJID_;
+            mutable std::unordered_map<long long, JID> jidsByID_;
+
+            mutable std::mutex pendingMessagesMutex_;
+            mutable std::condition_variable pendingMessagesCondition_;
+            std::vector<HistoryMessage> pendingMessages_;
+            bool writingMessages_;
+            bool stopping_;
             std::thread* thread_;
     };
 }
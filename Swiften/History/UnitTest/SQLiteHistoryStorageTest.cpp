@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <sqlite3.h>
+
+#include <Swiften/Base/Path.h>
+#include <Swiften/History/SQLiteHistoryStorage.h>
+
+using namespace Swift;
+
+class SQLiteHistoryStorageTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(SQLiteHistoryStorageTest);
+        CPPUNIT_TEST(testGetMessagesFromDate_ReturnsAddedMessages);
+        CPPUNIT_TEST(testGetMessagesFromDate_AfterClosing);
+        CPPUNIT_TEST(testGetMessagesFromDate_DifferentConversations);
+        CPPUNIT_TEST(testGetMessagesAfter_Paging);
+        CPPUNIT_TEST(testGetMessagesAfter_DifferentConversations);
+        CPPUNIT_TEST(testGetMessagesAfter_DatabaseWithoutMessageIDs);
+        CPPUNIT_TEST(testGetNextDateWithLogs_Repeated);
+        CPPUNIT_TEST(testGetContacts_MatchesPartOfWords);
+        CPPUNIT_TEST(testSearchMessages);
+        CPPUNIT_TEST(testSearchMessages_MatchesAllWords);
+        CPPUNIT_TEST(testSearchMessages_MessagesAddedWithoutSearchIndex);
+        CPPUNIT_TEST(testSearchMessages_SearchIndexUnavailable);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            file_ = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("sqlite_history_storage_test_%%%%%%%%%%%%%%%%.db");
+            self_ = JID("me@example.com");
+            alice_ = JID("alice@example.com/home");
+            time_ = boost::posix_time::time_from_string("2017-03-14 12:00:00");
+        }
+
+        void tearDown() {
+            boost::filesystem::remove(file_);
+            boost::filesystem::remove(pathToString(file_) + "-wal");
+            boost::filesystem::remove(pathToString(file_) + "-shm");
+        }
+
+        void testGetMessagesFromDate_ReturnsAddedMessages() {
+            std::unique_ptr<SQLiteHistoryStorage> testling(new SQLiteHistoryStorage(file_));
+            addMessages(*testling, 500);
+
+            // Queries wait for the messages still being written
+            std::vector<HistoryMessage> messages = testling->getMessagesFromDate(self_, alice_.toBare(), HistoryMessage::Chat, time_.date());
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(500), messages.size());
+            for (size_t i = 0; i < messages.size(); i++) {
+                CPPUNIT_ASSERT_EQUAL(std::to_string(i), messages[i].getMessage());
+            }
+
+            testling->addMessage(HistoryMessage("500", alice_, self_, HistoryMessage::Chat, time_));
+            messages = testling->getMessagesFromDate(self_, alice_.toBare(), HistoryMessage::Chat, time_.date());
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(501), messages.size());
+            CPPUNIT_ASSERT_EQUAL(std::string("500"), messages.back().getMessage());
+        }
+
+        void testGetMessagesFromDate_AfterClosing() {
+            {
+                SQLiteHistoryStorage storage(file_);
+                addMessages(storage, 500);
+            }
+
+            std::unique_ptr<SQLiteHistoryStorage> testling(new SQLiteHistoryStorage(file_));
+            std::vector<HistoryMessage> messages = testling->getMessagesFromDate(self_, alice_.toBare(), HistoryMessage::Chat, time_.date());
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(500), messages.size());
+            CPPUNIT_ASSERT_EQUAL(std::string("499"), messages.back().getMessage());
+        }
+
+        void testGetMessagesFromDate_DifferentConversations() {
+            std::unique_ptr<SQLiteHistoryStorage> testling(new SQLiteHistoryStorage(file_));
+            JID bob("bob@example.com/work");
+            testling->addMessage(HistoryMessage("alice", alice_, self_, HistoryMessage::Chat, time_));
+            testling->addMessage(HistoryMessage("bob", bob, self_, HistoryMessage::Chat, time_));
+            testling->addMessage(HistoryMessage("alice elsewhere", JID("alice@example.com/work"), self_, HistoryMessage::Chat, time_));
+
+            // The cached statements are reused with other parameters
+            std::vector<HistoryMessage> aliceMessages = testling->getMessagesFromDate(self_, alice_, HistoryMessage::Chat, time_.date());
+            std::vector<HistoryMessage> bobMessages = testling->getMessagesFromDate(self_, bob, HistoryMessage::Chat, time_.date());
+            std::vector<HistoryMessage> allAliceMessages = testling->getMessagesFromDate(self_, alice_.toBare(), HistoryMessage::Chat, time_.date());
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), aliceMessages.size());
+            CPPUNIT_ASSERT_EQUAL(std::string("alice"), aliceMessages[0].getMessage());
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), bobMessages.size());
+            CPPUNIT_ASSERT_EQUAL(std::string("bob"), bobMessages[0].getMessage());
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), allAliceMessages.size());
+        }
+
+        void testGetMessagesAfter_Paging() {
+            std::unique_ptr<SQLiteHistoryStorage> testling(new SQLiteHistoryStorage(file_));
+            addMessages(*testling, 250);
+
+            std::vector<std::string> messages;
+            boost::optional<long long> lastMessageID;
+            for (int i = 0; i < 3; i++) {
+                HistoryMessagePage page = testling->getMessagesAfter(self_, alice_.toBare(), HistoryMessage::Chat, time_.date(), lastMessageID, 100);
+                for (const auto& message : page.messages) {
+                    messages.push_back(message.getMessage());
+                }
+                CPPUNIT_ASSERT_EQUAL(i < 2, page.hasMore);
+                lastMessageID = page.lastMessageID;
+            }
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(250), messages.size());
+            for (size_t i = 0; i < messages.size(); i++) {
+                CPPUNIT_ASSERT_EQUAL(std::to_string(i), messages[i]);
+            }
+        }
+
+        void testGetMessagesAfter_DifferentConversations() {
+            std::unique_ptr<SQLiteHistoryStorage> testling(new SQLiteHistoryStorage(file_));
+            JID bob("bob@example.com/work");
+            testling->addMessage(HistoryMessage("alice", alice_, self_, HistoryMessage::Chat, time_));
+            testling->addMessage(HistoryMessage("bob", bob, self_, HistoryMessage::Chat, time_));
+            testling->addMessage(HistoryMessage("alice elsewhere", JID("alice@example.com/work"), self_, HistoryMessage::Chat, time_));
+
+            // The same query is reused with other parameters
+            HistoryMessagePage alicePage = testling->getMessagesAfter(self_, alice_, HistoryMessage::Chat, time_.date(), boost::optional<long long>(), 10);
+            HistoryMessagePage bobPage = testling->getMessagesAfter(self_, bob, HistoryMessage::Chat, time_.date(), boost::optional<long long>(), 10);
+            HistoryMessagePage allAlicePage = testling->getMessagesAfter(self_, alice_.toBare(), HistoryMessage::Chat, time_.date(), boost::optional<long long>(), 10);
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), alicePage.messages.size());
+            CPPUNIT_ASSERT_EQUAL(std::string("alice"), alicePage.messages[0].getMessage());
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), bobPage.messages.size());
+            CPPUNIT_ASSERT_EQUAL(std::string("bob"), bobPage.messages[0].getMessage());
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), allAlicePage.messages.size());
+        }
+
+        void testGetMessagesAfter_DatabaseWithoutMessageIDs() {
+            executeStatement(
+                "CREATE TABLE messages('message' STRING, 'fromBare' INTEGER, 'fromResource' STRING, 'toBare' INTEGER, 'toResource' STRING, 'type' INTEGER, 'time' INTEGER, 'offset' INTEGER);"
+                "CREATE TABLE jids('id' INTEGER PRIMARY KEY ASC AUTOINCREMENT, 'jid' STRING UNIQUE NOT NULL);"
+                "INSERT INTO jids(id, jid) VALUES(1, 'me@example.com');"
+                "INSERT INTO jids(id, jid) VALUES(2, 'alice@example.com');"
+                "INSERT INTO messages(rowid, message, fromBare, fromResource, toBare, toResource, type, time, offset) VALUES(3, 'Would you like some tea?', 2, 'home', 1, '', 0, 1489492800, 0);"
+                "INSERT INTO messages(rowid, message, fromBare, fromResource, toBare, toResource, type, time, offset) VALUES(7, 'There is no room', 1, '', 2, 'home', 0, 1489492860, 0);");
+
+            std::unique_ptr<SQLiteHistoryStorage> testling(new SQLiteHistoryStorage(file_));
+            testling->addMessage(HistoryMessage("The hatter is late for tea", alice_, self_, HistoryMessage::Chat, time_ + boost::posix_time::minutes(2)));
+            HistoryMessagePage page = testling->getMessagesAfter(self_, alice_.toBare(), HistoryMessage::Chat, time_.date(), boost::optional<long long>(3), 100);
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), page.messages.size());
+            CPPUNIT_ASSERT_EQUAL(std::string("There is no room"), page.messages[0].getMessage());
+            CPPUNIT_ASSERT_EQUAL(std::string("The hatter is late for tea"), page.messages[1].getMessage());
+            CPPUNIT_ASSERT_EQUAL(7LL, page.firstMessageID);
+            CPPUNIT_ASSERT_EQUAL(8LL, page.lastMessageID);
+            // The message IDs are kept by VACUUM now
+            executeStatement("SELECT id FROM messages");
+        }
+
+        void testGetNextDateWithLogs_Repeated() {
+            std::unique_ptr<SQLiteHistoryStorage> testling(new SQLiteHistoryStorage(file_));
+            for (int day = 0; day < 3; day++) {
+                testling->addMessage(HistoryMessage("tea", alice_, self_, HistoryMessage::Chat, time_ + boost::gregorian::days(day)));
+            }
+
+            // Results are only partly read, so the statement has to be reset
+            // before being reused
+            boost::gregorian::date date = time_.date();
+            date = testling->getNextDateWithLogs(self_, alice_.toBare(), HistoryMessage::Chat, date, false);
+            CPPUNIT_ASSERT_EQUAL(time_.date() + boost::gregorian::days(1), date);
+            date = testling->getNextDateWithLogs(self_, alice_.toBare(), HistoryMessage::Chat, date, false);
+            CPPUNIT_ASSERT_EQUAL(time_.date() + boost::gregorian::days(2), date);
+            date = testling->getNextDateWithLogs(self_, alice_.toBare(), HistoryMessage::Chat, date, false);
+            CPPUNIT_ASSERT(date.is_not_a_date());
+        }
+
+        void testGetContacts_MatchesPartOfWords() {
+            std::unique_ptr<SQLiteHistoryStorage> testling(new SQLiteHistoryStorage(file_));
+            testling->addMessage(HistoryMessage("The hatter is late for tea", alice_, self_, HistoryMessage::Chat, time_));
+
+            ContactsMap contacts = testling->getContacts(self_, HistoryMessage::Chat, "ATTER");
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), contacts.size());
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), contacts[alice_.toBare()].count(time_.date()));
+            CPPUNIT_ASSERT(testling->getContacts(self_, HistoryMessage::Chat, "coffee").empty());
+        }
+
+        void testSearchMessages() {
+            std::unique_ptr<SQLiteHistoryStorage> testling(new SQLiteHistoryStorage(file_));
+            testling->addMessage(HistoryMessage("Would you like some tea?", alice_, self_, HistoryMessage::Chat, time_));
+            testling->addMessage(HistoryMessage("There is no room", self_, alice_, HistoryMessage::Chat, time_ + boost::posix_time::minutes(1)));
+
+            std::vector<HistorySearchResult> results = testling->searchMessages(self_, HistoryMessage::Chat, "te", 0, 10);
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), results.size());
+            CPPUNIT_ASSERT_EQUAL(std::string("Would you like some tea?"), results[0].message.getMessage());
+            CPPUNIT_ASSERT_EQUAL(alice_, results[0].message.getFromJID());
+        }
+
+        void testSearchMessages_MatchesAllWords() {
+            if (!hasFullTextSearch()) {
+                return;
+            }
+            std::unique_ptr<SQLiteHistoryStorage> testling(new SQLiteHistoryStorage(file_));
+            testling->addMessage(HistoryMessage("The hatter is late for tea", alice_, self_, HistoryMessage::Chat, time_));
+            testling->addMessage(HistoryMessage("The hatter is mad", alice_, self_, HistoryMessage::Chat, time_));
+
+            // Only the search index matches words that aren't next to each
+            // other in the message
+            std::vector<HistorySearchResult> results = testling->searchMessages(self_, HistoryMessage::Chat, "tea hatter", 0, 10);
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), results.size());
+            CPPUNIT_ASSERT_EQUAL(std::string("The hatter is late for tea"), results[0].message.getMessage());
+        }
+
+        void testSearchMessages_MessagesAddedWithoutSearchIndex() {
+            if (!hasFullTextSearch()) {
+                return;
+            }
+            {
+                SQLiteHistoryStorage storage(file_);
+                storage.addMessage(HistoryMessage("The hatter is late for tea", alice_, self_, HistoryMessage::Chat, time_));
+            }
+            // Messages written by an SQLite without FTS5 aren't indexed
+            executeStatement("INSERT INTO messages_fts(messages_fts) VALUES('delete-all'); UPDATE messages_fts_state SET lastIndexedMessage=0");
+
+            std::unique_ptr<SQLiteHistoryStorage> testling(new SQLiteHistoryStorage(file_));
+            std::vector<HistorySearchResult> results = testling->searchMessages(self_, HistoryMessage::Chat, "tea hatter", 0, 10);
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), results.size());
+        }
+
+        void testSearchMessages_SearchIndexUnavailable() {
+            createUnavailableSearchIndex();
+            std::unique_ptr<SQLiteHistoryStorage> testling(new SQLiteHistoryStorage(file_));
+            testling->addMessage(HistoryMessage("Would you like some tea?", alice_, self_, HistoryMessage::Chat, time_));
+            testling->addMessage(HistoryMessage("The hatter is late for tea", alice_, self_, HistoryMessage::Chat, time_ + boost::posix_time::minutes(1)));
+
+            std::vector<HistorySearchResult> results = testling->searchMessages(self_, HistoryMessage::Chat, "tea", 0, 10);
+
+            // Without an index, the most recent matches come first
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), results.size());
+            CPPUNIT_ASSERT_EQUAL(std::string("The hatter is late for tea"), results[0].message.getMessage());
+            CPPUNIT_ASSERT_EQUAL(std::string("Would you like some tea?"), results[1].message.getMessage());
+            CPPUNIT_ASSERT_EQUAL(std::string("The hatter is late for tea"), results[0].snippet);
+            CPPUNIT_ASSERT(testling->searchMessages(self_, HistoryMessage::Chat, "tea hatter", 0, 10).empty());
+        }
+
+    private:
+        void addMessages(SQLiteHistoryStorage& storage, int count) {
+            for (int i = 0; i < count; i++) {
+                storage.addMessage(HistoryMessage(std::to_string(i), i % 2 ? self_ : alice_, i % 2 ? alice_ : self_, HistoryMessage::Chat, time_ + boost::posix_time::seconds(i)));
+            }
+        }
+
+        void executeStatement(const std::string& statement) {
+            sqlite3* db = nullptr;
+            CPPUNIT_ASSERT_EQUAL(SQLITE_OK, sqlite3_open(pathToString(file_).c_str(), &db));
+            CPPUNIT_ASSERT_EQUAL(SQLITE_OK, sqlite3_exec(db, statement.c_str(), nullptr, nullptr, nullptr));
+            sqlite3_close(db);
+        }
+
+        // Whether the SQLite library can create the search index (FTS5), which
+        // some tests rely on
+        static bool hasFullTextSearch() {
+            sqlite3* db = nullptr;
+            sqlite3_open(":memory:", &db);
+            bool result = sqlite3_exec(db, "CREATE VIRTUAL TABLE test USING fts5(message)", nullptr, nullptr, nullptr) == SQLITE_OK;
+            sqlite3_close(db);
+            return result;
+        }
+
+        // Creates a search index like an SQLite with FTS5 would, but with a
+        // module that isn't available, so that it exists but can't be used.
+        void createUnavailableSearchIndex() {
+            executeStatement(
+                "CREATE TABLE placeholder(id INTEGER);"
+                "PRAGMA writable_schema=ON;"
+                "INSERT INTO sqlite_master(type, name, tbl_name, rootpage, sql) VALUES('table', 'messages_fts', 'messages_fts', 0, 'CREATE VIRTUAL TABLE messages_fts USING unavailable_fts(message)');"
+                "PRAGMA writable_schema=OFF;");
+        }
+
+    private:
+        boost::filesystem::path file_;
+        JID self_;
+        JID alice_;
+        boost::posix_time::ptime time_;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SQLiteHistoryStorageTest);
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -11,12 +11,16 @@
 #include <vector>
 
 #ifdef SWIFTEN_CACHE_JID_PREP
+#include <array>
+#include <functional>
 #include <mutex>
-#include <unordered_map>
 #endif
 
 #include <boost/optional.hpp>
 
+#ifdef SWIFTEN_CACHE_JID_PREP
+#include <Swiften/Base/LRUCache.h>
+#endif
 #include <Swiften/Base/String.h>
 #include <Swiften/IDN/IDNConverter.h>
 #include <Swiften/JID/JID.h>
@@ -29,12 +33,75 @@
 using namespace Swift;
 
 #ifdef SWIFTEN_CACHE_JID_PREP
-typedef std::unordered_map<std::string, std::string> PrepCache;
+namespace {
+    /**
+     * A bounded cache of prepared JID parts. The cache is split in shards
+     * with their own lock and LRU list, so that threads constructing JIDs
+     * rarely contend.
+     */
+    class PrepCache {
+        public:
+            /**
+             * Returns the prepared version of s, calling prepare on a cache
+             * miss. Exceptions thrown by prepare are passed on, and the result
+             * is not cached.
+             */
+            std::string get(const std::string& s, const std::function<std::string (const std::string&)>& prepare) {
+                Shard& shard = shards_[std::hash<std::string>()(s) % ShardCount];
+                {
+                    std::lock_guard<std::mutex> lock(shard.mutex);
+                    boost::optional<std::string> prepared = shard.cache.get(s);
+                    if (prepared) {
+                        ++shard.hits;
+                        return *prepared;
+                    }
+                    ++shard.misses;
+                }
+                std::string prepared = prepare(s);
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                shard.cache.insert(s, prepared);
+                return prepared;
+            }
+
+            void addStatistics(JID::PrepCacheStatistics& statistics) {
+                for (auto& shard : shards_) {
+                    std::lock_guard<std::mutex> lock(shard.mutex);
+                    statistics.hits += shard.hits;
+                    statistics.misses += shard.misses;
+                }
+            }
+
+        private:
+            static const size_t ShardCount = 16;
+            static const size_t ShardSize = 4096;
 
-static std::mutex namePrepCacheMutex;
-static PrepCache nodePrepCache;
-static PrepCache domainPrepCache;
-static PrepCache resourcePrepCache;
+            struct Shard {
+                Shard() : hits(0), misses(0) {}
+
+                std::mutex mutex;
+                LRUCache<std::string, std::string, ShardSize> cache;
+                size_t hits;
+                size_t misses;
+            };
+
+            std::array<Shard, ShardCount> shards_;
+    };
+
+    PrepCache& getNodePrepCache() {
+        static PrepCache cache;
+        return cache;
+    }
+
+    PrepCache& getDomainPrepCache() {
+        static PrepCache cache;
+        return cache;
+    }
+
+    PrepCache& getResourcePrepCache() {
+        static PrepCache cache;
+        return cache;
+    }
+}
 #endif
 
 static const std::vector<char> escapedChars = {' ', '"', '&', '\'', '/', '<', '>', '@', ':'};
@@ -65,19 +132,84 @@ static bool getEscapeSequenceValue(const std::string& sequence, unsigned char& v
     return (!s.fail() && !s.bad() && (value == 0x5C || std::find(escapedChars.begin(), escapedChars.end(), value) != escapedChars.end()));
 }
 
+/*
+ * The following checks recognize ASCII strings that the corresponding
+ * stringprep profile leaves unchanged, so the IDN converter can be skipped.
+ * Longer strings than the converter accepts are left to it to reject.
+ */
+static const size_t MAX_PREPARED_ASCII_SIZE = 1023;
+
+static bool isPreparedASCIINode(const std::string& node) {
+    if (node.size() > MAX_PREPARED_ASCII_SIZE) {
+        return false;
+    }
+    for (char c : node) {
+        if (c <= 0x20 || c >= 0x7F || (c >= 'A' && c <= 'Z') || std::string("\"&'/:<>@").find(c) != std::string::npos) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool isPreparedASCIIResource(const std::string& resource) {
+    if (resource.size() > MAX_PREPARED_ASCII_SIZE) {
+        return false;
+    }
+    for (char c : resource) {
+        if (c < 0x20 || c >= 0x7F) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Only accepts lowercase LDH labels, which are also valid for IDNA with the
+ * STD3 ASCII rules.
+ */
+static bool isPreparedASCIIDomain(const std::string& domain) {
+    if (domain.size() > MAX_PREPARED_ASCII_SIZE) {
+        return false;
+    }
+    size_t labelStart = 0;
+    for (size_t i = 0; i <= domain.size(); ++i) {
+        if (i == domain.size() || domain[i] == '.') {
+            size_t labelSize = i - labelStart;
+            if (labelSize == 0 || labelSize > 63 || domain[labelStart] == '-' || domain[i - 1] == '-') {
+                return false;
+            }
+            labelStart = i + 1;
+        }
+        else {
+            char c = domain[i];
+            if (!((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-')) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void combineHash(size_t& seed, size_t value) {
+    seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
 namespace Swift {
 
-JID::JID(const char* jid) : valid_(true) {
+JID::JID(const char* jid) : valid_(true), hasResource_(false) {
     assert(jid);
     initializeFromString(std::string(jid));
+    updateHashes();
 }
 
-JID::JID(const std::string& jid) : valid_(true) {
+JID::JID(const std::string& jid) : valid_(true), hasResource_(false) {
     initializeFromString(jid);
+    updateHashes();
 }
 
 JID::JID(const std::string& node, const std::string& domain) : valid_(true), hasResource_(false) {
     nameprepAndSetComponents(node, domain, "");
+    updateHashes();
 }
 
 JID::JID(const std::string& node, const std::string& domain, const std::string& resource) : valid_(true), hasResource_(true) {
@@ -85,6 +217,7 @@ JID::JID(const std::string& node, const std::string& domain, const std::string&
         valid_ = false;
     }
     nameprepAndSetComponents(node, domain, resource);
+    updateHashes();
 }
 
 void JID::initializeFromString(const std::string& jid) {
@@ -115,63 +248,38 @@ void JID::initializeFromString(const std::string& jid) {
 
 
 void JID::nameprepAndSetComponents(const std::string& node, const std::string& domain, const std::string& resource) {
-    if (domain.empty() || !idnConverter->getIDNAEncoded(domain)) {
+    if (hasResource_ && resource.empty()) {
         valid_ = false;
         return;
     }
 
-    if (hasResource_ && resource.empty()) {
+    bool domainPrepared = isPreparedASCIIDomain(domain);
+    if (!domainPrepared && (domain.empty() || !idnConverter->getIDNAEncoded(domain))) {
         valid_ = false;
         return;
     }
+
+    try {
 #ifndef SWIFTEN_CACHE_JID_PREP
-    node_ = idnConverter->getStringPrepared(node, IDNConverter::XMPPNodePrep);
-    domain_ = idnConverter->getStringPrepared(domain, IDNConverter::NamePrep);
-    resource_ = idnConverter->getStringPrepared(resource, IDNConverter::XMPPResourcePrep);
+        node_ = isPreparedASCIINode(node) ? node : idnConverter->getStringPrepared(node, IDNConverter::XMPPNodePrep);
+        domain_ = domainPrepared ? domain : idnConverter->getStringPrepared(domain, IDNConverter::NamePrep);
+        resource_ = isPreparedASCIIResource(resource) ? resource : idnConverter->getStringPrepared(resource, IDNConverter::XMPPResourcePrep);
 #else
-    std::unique_lock<std::mutex> lock(namePrepCacheMutex);
-
-    std::pair<PrepCache::iterator, bool> r;
-
-    r = nodePrepCache.insert(std::make_pair(node, std::string()));
-    if (r.second) {
-        try {
-            r.first->second = idnConverter->getStringPrepared(node, IDNConverter::XMPPNodePrep);
-        }
-        catch (...) {
-            nodePrepCache.erase(r.first);
-            valid_ = false;
-            return;
-        }
-    }
-    node_ = r.first->second;
-
-    r = domainPrepCache.insert(std::make_pair(domain, std::string()));
-    if (r.second) {
-        try {
-            r.first->second = idnConverter->getStringPrepared(domain, IDNConverter::NamePrep);
-        }
-        catch (...) {
-            domainPrepCache.erase(r.first);
-            valid_ = false;
-            return;
-        }
+        node_ = isPreparedASCIINode(node) ? node : getNodePrepCache().get(node, [](const std::string& s) {
+            return idnConverter->getStringPrepared(s, IDNConverter::XMPPNodePrep);
+        });
+        domain_ = domainPrepared ? domain : getDomainPrepCache().get(domain, [](const std::string& s) {
+            return idnConverter->getStringPrepared(s, IDNConverter::NamePrep);
+        });
+        resource_ = isPreparedASCIIResource(resource) ? resource : getResourcePrepCache().get(resource, [](const std::string& s) {
+            return idnConverter->getStringPrepared(s, IDNConverter::XMPPResourcePrep);
+        });
+#endif
     }
-    domain_ = r.first->second;
-
-    r = resourcePrepCache.insert(std::make_pair(resource, std::string()));
-    if (r.second) {
-        try {
-            r.first->second = idnConverter->getStringPrepared(resource, IDNConverter::XMPPResourcePrep);
-        }
-        catch (...) {
-            resourcePrepCache.erase(r.first);
-            valid_ = false;
-            return;
-        }
+    catch (...) {
+        valid_ = false;
+        return;
     }
-    resource_ = r.first->second;
-#endif
 
     if (domain_.empty()) {
         valid_ = false;
@@ -191,17 +299,28 @@ std::string JID::toString() const {
     return string;
 }
 
+void JID::updateHashes() {
+    // Only hash what compare() looks at, so that equal JIDs get equal hashes
+    std::hash<std::string> hashString;
+    bareHash_ = hashString(node_);
+    combineHash(bareHash_, hashString(domain_));
+    hash_ = bareHash_;
+    if (hasResource_) {
+        combineHash(hash_, hashString(resource_));
+    }
+}
+
 int JID::compare(const Swift::JID& o, CompareType compareType) const {
-    if (node_ < o.node_) { return -1; }
-    if (node_ > o.node_) { return 1; }
-    if (domain_ < o.domain_) { return -1; }
-    if (domain_ > o.domain_) { return 1; }
+    int result = node_.compare(o.node_);
+    if (result != 0) { return result < 0 ? -1 : 1; }
+    result = domain_.compare(o.domain_);
+    if (result != 0) { return result < 0 ? -1 : 1; }
     if (compareType == WithResource) {
         if (hasResource_ != o.hasResource_) {
             return hasResource_ ? 1 : -1;
         }
-        if (resource_ < o.resource_) { return -1; }
-        if (resource_ > o.resource_) { return 1; }
+        result = resource_.compare(o.resource_);
+        if (result != 0) { return result < 0 ? -1 : 1; }
     }
     return 0;
 }
@@ -254,6 +373,16 @@ void JID::setIDNConverter(IDNConverter* converter) {
     idnConverter = converter;
 }
 
+JID::PrepCacheStatistics JID::getPrepCacheStatistics() {
+    PrepCacheStatistics statistics;
+#ifdef SWIFTEN_CACHE_JID_PREP
+    getNodePrepCache().addStatistics(statistics);
+    getDomainPrepCache().addStatistics(statistics);
+    getResourcePrepCache().addStatistics(statistics);
+#endif
+    return statistics;
+}
+
 std::ostream& operator<<(std::ostream& os, const JID& j) {
     os << j.toString();
     return os;
@@ -1,11 +1,13 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <cstddef>
+#include <functional>
 #include <iosfwd>
 #include <string>
 
@@ -33,6 +35,13 @@ namespace Swift {
                 WithResource, WithoutResource
             };
 
+            struct PrepCacheStatistics {
+                PrepCacheStatistics() : hits(0), misses(0) {}
+
+                size_t hits;
+                size_t misses;
+            };
+
             /**
              * Create a JID from its String representation.
              *
@@ -132,6 +141,7 @@ namespace Swift {
                 JID result(*this);
                 result.hasResource_ = false;
                 result.resource_ = "";
+                result.hash_ = bareHash_;
                 return result;
             }
 
@@ -146,11 +156,25 @@ namespace Swift {
             std::string toString() const;
 
             bool equals(const JID& o, CompareType compareType) const {
+                if (getHash(compareType) != o.getHash(compareType)) {
+                    return false;
+                }
                 return compare(o, compareType) == 0;
             }
 
             int compare(const JID& o, CompareType compareType) const;
 
+            /**
+             * Returns a hash of the JID, computed when the JID is constructed.
+             *
+             * JIDs that are equal with the given compare type have the same hash.
+             * The hash of a bare JID is the same as the hash of any of its full
+             * JIDs with compare type WithoutResource.
+             */
+            size_t getHash(CompareType compareType = WithResource) const {
+                return compareType == WithResource ? hash_ : bareHash_;
+            }
+
             operator std::string() const {
                 return toString();
             }
@@ -162,11 +186,11 @@ namespace Swift {
             SWIFTEN_API friend std::ostream& operator<<(std::ostream& os, const Swift::JID& j);
 
             friend bool operator==(const Swift::JID& a, const Swift::JID& b) {
-                return a.compare(b, Swift::JID::WithResource) == 0;
+                return a.equals(b, Swift::JID::WithResource);
             }
 
             friend bool operator!=(const Swift::JID& a, const Swift::JID& b) {
-                return a.compare(b, Swift::JID::WithResource) != 0;
+                return !a.equals(b, Swift::JID::WithResource);
             }
 
             /**
@@ -182,9 +206,17 @@ namespace Swift {
              */
             static void setIDNConverter(IDNConverter*);
 
+            /**
+             * Returns the number of hits and misses of the cache of stringprepped
+             * JID parts. Parts that are already prepared ASCII bypass the cache,
+             * and are not counted.
+             */
+            static PrepCacheStatistics getPrepCacheStatistics();
+
         private:
             void nameprepAndSetComponents(const std::string& node, const std::string& domain, const std::string& resource);
             void initializeFromString(const std::string&);
+            void updateHashes();
 
         private:
             bool valid_;
@@ -192,7 +224,18 @@ namespace Swift {
             std::string domain_;
             bool hasResource_;
             std::string resource_;
+            size_t bareHash_;
+            size_t hash_;
     };
 
     SWIFTEN_API std::ostream& operator<<(std::ostream& os, const Swift::JID& j);
 }
+
+namespace std {
+    template<>
+    struct hash<Swift::JID> {
+        size_t operator()(const Swift::JID& jid) const {
+            return jid.getHash();
+        }
+    };
+}
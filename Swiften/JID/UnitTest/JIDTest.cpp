@@ -1,9 +1,11 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
+#include <unordered_set>
+
 #include <cppunit/extensions/HelperMacros.h>
 #include <cppunit/extensions/TestFactoryRegistry.h>
 
@@ -62,6 +64,13 @@ class JIDTest : public CppUnit::TestFixture
         CPPUNIT_TEST(testGetEscapedNode_BackslashAtEnd);
         CPPUNIT_TEST(testGetUnescapedNode);
         CPPUNIT_TEST(testGetUnescapedNode_XEP106Examples);
+        CPPUNIT_TEST(testConstructorWithString_PreparedASCII);
+        CPPUNIT_TEST(testConstructorWithString_DomainWithInvalidLabel);
+        CPPUNIT_TEST(testConstructorWithString_PreparedASCIITooLong);
+        CPPUNIT_TEST(testGetPrepCacheStatistics);
+        CPPUNIT_TEST(testGetHash_EqualJIDs);
+        CPPUNIT_TEST(testGetHash_ToBare);
+        CPPUNIT_TEST(testStdHash_UnorderedSet);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -425,6 +434,78 @@ class JIDTest : public CppUnit::TestFixture
             CPPUNIT_ASSERT_EQUAL(std::string("c:\\cool stuff"), JID("c\\3a\\cool\\20stuff@example.com").getUnescapedNode());
             CPPUNIT_ASSERT_EQUAL(std::string("c:\\5commas"), JID("c\\3a\\5c5commas@example.com").getUnescapedNode());
         }
+
+        void testConstructorWithString_PreparedASCII() {
+            JID testling("alice_1+x@wonder-land.example.com/Tea Party!");
+
+            CPPUNIT_ASSERT(testling.isValid());
+            CPPUNIT_ASSERT_EQUAL(std::string("alice_1+x"), testling.getNode());
+            CPPUNIT_ASSERT_EQUAL(std::string("wonder-land.example.com"), testling.getDomain());
+            CPPUNIT_ASSERT_EQUAL(std::string("Tea Party!"), testling.getResource());
+        }
+
+        void testConstructorWithString_DomainWithInvalidLabel() {
+            CPPUNIT_ASSERT(!JID("alice@-wonderland.lit").isValid());
+            CPPUNIT_ASSERT(!JID("alice@wonderland..lit").isValid());
+            CPPUNIT_ASSERT(!JID("alice@" + std::string(64, 'a') + ".lit").isValid());
+        }
+
+        void testConstructorWithString_PreparedASCIITooLong() {
+            std::string domain;
+            while (domain.size() < 1024) {
+                domain += std::string(63, 'a') + ".";
+            }
+            domain += "lit";
+
+            CPPUNIT_ASSERT(JID(std::string(1023, 'a') + "@wonderland.lit/" + std::string(1023, 'a')).isValid());
+            CPPUNIT_ASSERT(!JID(std::string(1024, 'a') + "@wonderland.lit").isValid());
+            CPPUNIT_ASSERT(!JID("alice@wonderland.lit/" + std::string(1024, 'a')).isValid());
+            CPPUNIT_ASSERT(!JID("alice@" + domain).isValid());
+        }
+
+        void testGetPrepCacheStatistics() {
+            JID::PrepCacheStatistics before = JID::getPrepCacheStatistics();
+
+            JID("PrepCacheTest@PrepCacheTest.lit/resource");
+            JID::PrepCacheStatistics afterFirst = JID::getPrepCacheStatistics();
+            JID("PrepCacheTest@PrepCacheTest.lit/resource");
+            JID::PrepCacheStatistics afterSecond = JID::getPrepCacheStatistics();
+
+            CPPUNIT_ASSERT_EQUAL(before.hits, afterFirst.hits);
+            CPPUNIT_ASSERT_EQUAL(before.misses + 2, afterFirst.misses);
+            CPPUNIT_ASSERT_EQUAL(afterFirst.hits + 2, afterSecond.hits);
+            CPPUNIT_ASSERT_EQUAL(afterFirst.misses, afterSecond.misses);
+        }
+
+        void testGetHash_EqualJIDs() {
+            JID testling1("Foo@Bar.com/Resource");
+            JID testling2("foo", "bar.com", "Resource");
+
+            CPPUNIT_ASSERT_EQUAL(testling1.getHash(), testling2.getHash());
+            CPPUNIT_ASSERT_EQUAL(testling1.getHash(JID::WithoutResource), JID("foo@bar.com/other").getHash(JID::WithoutResource));
+            CPPUNIT_ASSERT(testling1.getHash() != JID("foo@bar.com/other").getHash());
+            CPPUNIT_ASSERT(testling1 != JID("foo@bar.com/other"));
+            CPPUNIT_ASSERT(testling1.equals(JID("foo@bar.com/other"), JID::WithoutResource));
+        }
+
+        void testGetHash_ToBare() {
+            JID testling("foo@bar.com/resource");
+
+            CPPUNIT_ASSERT_EQUAL(JID("foo@bar.com").getHash(), testling.toBare().getHash());
+            CPPUNIT_ASSERT_EQUAL(testling.getHash(JID::WithoutResource), testling.toBare().getHash());
+            CPPUNIT_ASSERT_EQUAL(testling.getHash(), testling.toBare().withResource("resource").getHash());
+        }
+
+        void testStdHash_UnorderedSet() {
+            std::unordered_set<JID> jids;
+            jids.insert(JID("foo@bar.com/resource"));
+            jids.insert(JID("Foo@Bar.com/resource"));
+            jids.insert(JID("foo@bar.com"));
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), jids.size());
+            CPPUNIT_ASSERT(jids.find(JID("foo@bar.com/resource").toBare()) != jids.end());
+            CPPUNIT_ASSERT(jids.find(JID("foo@bar.com/other")) == jids.end());
+        }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(JIDTest);
@@ -42,7 +42,10 @@ BOSHConnection::BOSHConnection(const URL& boshURL, Connector::ref connector, XML
       connectionReady_(false)
 {
     if (boshURL_.getScheme() == "https") {
-        tlsLayer_ = std::make_shared<TLSLayer>(tlsContextFactory, tlsOptions);
+        // Let all connections to the same HTTP server resume each other's TLS sessions
+        TLSOptions connectionTLSOptions = tlsOptions;
+        connectionTLSOptions.sessionCacheKey = "https:" + boshURL_.getHost() + ":" + std::to_string(URL::getPortOrDefaultPort(boshURL_));
+        tlsLayer_ = std::make_shared<TLSLayer>(tlsContextFactory, connectionTLSOptions);
         // The following dummyLayer_ is needed as the TLSLayer will pass the decrypted data to its parent layer.
         // The dummyLayer_ will serve as the parent layer.
         dummyLayer_ = std::make_shared<DummyStreamLayer>(tlsLayer_.get());
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -10,49 +10,54 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <boost/asio/placeholders.hpp>
 #include <boost/asio/write.hpp>
 #include <boost/bind.hpp>
 #include <boost/numeric/conversion/cast.hpp>
 
-#include <Swiften/Base/Algorithm.h>
 #include <Swiften/Base/ByteArray.h>
 #include <Swiften/Base/Log.h>
-#include <Swiften/Base/SafeAllocator.h>
 #include <Swiften/Base/sleep.h>
 #include <Swiften/EventLoop/EventLoop.h>
 #include <Swiften/Network/HostAddressPort.h>
 
 namespace Swift {
 
-static const size_t BUFFER_SIZE = 4096;
-
 // -----------------------------------------------------------------------------
 
-// A reference-counted non-modifiable buffer class.
-class SharedBuffer {
+// A reference-counted sequence of non-modifiable buffers, which is written
+// with a single gather write.
+class SharedBufferSequence {
     public:
-        SharedBuffer(const SafeByteArray& data) :
-                data_(new std::vector<char, SafeAllocator<char> >(data.begin(), data.end())),
-                buffer_(boost::asio::buffer(*data_)) {
+        SharedBufferSequence(std::vector< std::shared_ptr<SafeByteArray> > data) : data_(std::make_shared<Data>()) {
+            data_->buffers.reserve(data.size());
+            for (const auto& buffer : data) {
+                data_->buffers.push_back(boost::asio::buffer(*buffer));
+            }
+            data_->data.swap(data);
         }
 
         // ConstBufferSequence requirements.
         typedef boost::asio::const_buffer value_type;
-        typedef const boost::asio::const_buffer* const_iterator;
-        const boost::asio::const_buffer* begin() const { return &buffer_; }
-        const boost::asio::const_buffer* end() const { return &buffer_ + 1; }
+        typedef std::vector<boost::asio::const_buffer>::const_iterator const_iterator;
+        const_iterator begin() const { return data_->buffers.begin(); }
+        const_iterator end() const { return data_->buffers.end(); }
 
     private:
-        std::shared_ptr< std::vector<char, SafeAllocator<char> > > data_;
-        boost::asio::const_buffer buffer_;
+        struct Data {
+            std::vector< std::shared_ptr<SafeByteArray> > data;
+            std::vector<boost::asio::const_buffer> buffers;
+        };
+        std::shared_ptr<Data> data_;
 };
 
 // -----------------------------------------------------------------------------
 
 BoostConnection::BoostConnection(std::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop) :
-    eventLoop(eventLoop), ioService(ioService), socket_(*ioService), writing_(false), closeSocketAfterNextWrite_(false) {
+    eventLoop(eventLoop), ioService(ioService), socket_(*ioService), readBufferPool_(ReadBufferPool::create()), writing_(false), closeSocketAfterNextWrite_(false) {
 }
 
 BoostConnection::~BoostConnection() {
@@ -92,18 +97,20 @@ void BoostConnection::closeSocket() {
 }
 
 void BoostConnection::write(const SafeByteArray& data) {
+    std::shared_ptr<SafeByteArray> buffer = std::make_shared<SafeByteArray>(data);
     std::lock_guard<std::mutex> lock(writeMutex_);
+    writeQueue_.push_back(buffer);
     if (!writing_) {
         writing_ = true;
-        doWrite(data);
-    }
-    else {
-        append(writeQueue_, data);
+        doWrite();
     }
 }
 
-void BoostConnection::doWrite(const SafeByteArray& data) {
-    boost::asio::async_write(socket_, SharedBuffer(data),
+void BoostConnection::doWrite() {
+    // Everything queued while the previous write was in progress goes out in a single write
+    std::vector< std::shared_ptr<SafeByteArray> > data;
+    data.swap(writeQueue_);
+    boost::asio::async_write(socket_, SharedBufferSequence(std::move(data)),
             boost::bind(&BoostConnection::handleDataWritten, shared_from_this(), boost::asio::placeholders::error));
 }
 
@@ -119,7 +126,7 @@ void BoostConnection::handleConnectFinished(const boost::system::error_code& err
 }
 
 void BoostConnection::doRead() {
-    readBuffer_ = std::make_shared<SafeByteArray>(BUFFER_SIZE);
+    readBuffer_ = readBufferPool_->getBuffer();
     std::lock_guard<std::mutex> lock(readCloseMutex_);
     socket_.async_read_some(
             boost::asio::buffer(*readBuffer_),
@@ -129,6 +136,7 @@ void BoostConnection::doRead() {
 void BoostConnection::handleSocketRead(const boost::system::error_code& error, size_t bytesTransferred) {
     SWIFT_LOG(debug) << "Socket read " << error << std::endl;
     if (!error) {
+        readBufferPool_->handleRead(bytesTransferred, readBuffer_->size());
         readBuffer_->resize(bytesTransferred);
         eventLoop->postEvent(boost::bind(boost::ref(onDataRead), readBuffer_), shared_from_this());
         doRead();
@@ -161,12 +169,15 @@ void BoostConnection::handleDataWritten(const boost::system::error_code& error)
             }
         }
         else {
-            doWrite(writeQueue_);
-            writeQueue_.clear();
+            doWrite();
         }
     }
 }
 
+ReadBufferPool::Statistics BoostConnection::getReadStatistics() const {
+    return readBufferPool_->getStatistics();
+}
+
 HostAddressPort BoostConnection::getLocalAddress() const {
     return HostAddressPort(socket_.local_endpoint());
 }
@@ -8,6 +8,7 @@
 
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/ip/tcp.hpp>
@@ -16,6 +17,7 @@
 #include <Swiften/Base/SafeByteArray.h>
 #include <Swiften/EventLoop/EventOwner.h>
 #include <Swiften/Network/Connection.h>
+#include <Swiften/Network/ReadBufferPool.h>
 #include <Swiften/TLS/Certificate.h>
 #include <Swiften/TLS/CertificateVerificationError.h>
 #include <Swiften/TLS/CertificateWithKey.h>
@@ -45,6 +47,12 @@ namespace Swift {
             virtual HostAddressPort getLocalAddress() const;
             virtual HostAddressPort getRemoteAddress() const;
 
+            /**
+             * Returns counters about the reads on this connection, for tuning
+             * the read buffer sizes.
+             */
+            ReadBufferPool::Statistics getReadStatistics() const;
+
             bool setClientCertificate(CertificateWithKey::ref cert);
 
             Certificate::ref getPeerCertificate() const;
@@ -58,17 +66,18 @@ namespace Swift {
             void handleSocketRead(const boost::system::error_code& error, size_t bytesTransferred);
             void handleDataWritten(const boost::system::error_code& error);
             void doRead();
-            void doWrite(const SafeByteArray& data);
+            void doWrite();
             void closeSocket();
 
         private:
             EventLoop* eventLoop;
             std::shared_ptr<boost::asio::io_service> ioService;
             boost::asio::ip::tcp::socket socket_;
+            std::shared_ptr<ReadBufferPool> readBufferPool_;
             std::shared_ptr<SafeByteArray> readBuffer_;
             std::mutex writeMutex_;
             bool writing_;
-            SafeByteArray writeQueue_;
+            std::vector< std::shared_ptr<SafeByteArray> > writeQueue_;
             bool closeSocketAfterNextWrite_;
             std::mutex readCloseMutex_;
     };
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/Network/ReadBufferPool.h>
+
+#include <algorithm>
+
+#include <Swiften/Base/SafeAllocator.h>
+
+namespace Swift {
+
+// Buffers kept for reuse. Each connection only has a few reads in flight.
+static const size_t MAX_FREE_BUFFERS = 4;
+
+// Shrink the buffer after this many consecutive reads that used less than a quarter of it.
+static const int SMALL_READS_BEFORE_SHRINKING = 8;
+
+const size_t ReadBufferPool::MinimumBufferSize;
+const size_t ReadBufferPool::MaximumBufferSize;
+
+ReadBufferPool::ReadBufferPool() : bufferSize_(MinimumBufferSize), smallReads_(0), reads_(0), bytesRead_(0) {
+}
+
+std::shared_ptr<SafeByteArray> ReadBufferPool::getBuffer() {
+    size_t size = bufferSize_;
+    std::unique_ptr<SafeByteArray> buffer;
+    {
+        std::lock_guard<std::mutex> lock(freeBuffersMutex_);
+        if (!freeBuffers_.empty()) {
+            buffer = std::move(freeBuffers_.back());
+            freeBuffers_.pop_back();
+        }
+    }
+    if (buffer) {
+        buffer->resize(size);
+    }
+    else {
+        buffer.reset(new SafeByteArray(size));
+    }
+    std::shared_ptr<ReadBufferPool> pool = shared_from_this();
+    return std::shared_ptr<SafeByteArray>(buffer.release(), [pool](SafeByteArray* buffer) {
+        pool->recycle(buffer);
+    });
+}
+
+void ReadBufferPool::handleRead(size_t bytesRead, size_t bufferSize) {
+    ++reads_;
+    bytesRead_ += bytesRead;
+
+    if (bytesRead >= bufferSize) {
+        smallReads_ = 0;
+        bufferSize_ = std::min(bufferSize * 2, MaximumBufferSize);
+    }
+    else if (bytesRead < bufferSize / 4) {
+        if (++smallReads_ >= SMALL_READS_BEFORE_SHRINKING) {
+            smallReads_ = 0;
+            bufferSize_ = std::max(bufferSize / 2, MinimumBufferSize);
+        }
+    }
+    else {
+        smallReads_ = 0;
+    }
+}
+
+ReadBufferPool::Statistics ReadBufferPool::getStatistics() const {
+    Statistics statistics;
+    statistics.reads = reads_;
+    statistics.bytesRead = bytesRead_;
+    statistics.bufferSize = bufferSize_;
+    return statistics;
+}
+
+void ReadBufferPool::recycle(SafeByteArray* buffer) {
+    std::unique_ptr<SafeByteArray> ownedBuffer(buffer);
+    // Don't hold on to buffers that are bigger than what we read into now
+    if (ownedBuffer->capacity() > bufferSize_) {
+        return;
+    }
+    // Don't keep the data that was read into the buffer around while it is unused
+    ownedBuffer->resize(ownedBuffer->capacity());
+    secureZeroMemory(reinterpret_cast<char*>(vecptr(*ownedBuffer)), ownedBuffer->size());
+    std::lock_guard<std::mutex> lock(freeBuffersMutex_);
+    if (freeBuffers_.size() < MAX_FREE_BUFFERS) {
+        freeBuffers_.push_back(std::move(ownedBuffer));
+    }
+}
+
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/Base/SafeByteArray.h>
+
+namespace Swift {
+    /**
+     * Provides the buffers a connection reads into, and picks their size.
+     *
+     * The buffer size grows (up to \ref MaximumBufferSize) while reads fill
+     * the whole buffer, and shrinks back (down to \ref MinimumBufferSize) when
+     * reads stay small. Buffers are recycled once the last reference to them
+     * is dropped, so receivers can keep them as long as they need.
+     *
+     * This class is thread-safe.
+     */
+    class SWIFTEN_API ReadBufferPool : public boost::noncopyable, public std::enable_shared_from_this<ReadBufferPool> {
+        public:
+            struct Statistics {
+                Statistics() : reads(0), bytesRead(0), bufferSize(0) {}
+
+                /** The number of reads done so far. */
+                std::uint64_t reads;
+                /** The total number of bytes read so far. */
+                std::uint64_t bytesRead;
+                /** The size of the next buffer. */
+                size_t bufferSize;
+            };
+
+            static const size_t MinimumBufferSize = 4096;
+            static const size_t MaximumBufferSize = 65536;
+
+            static std::shared_ptr<ReadBufferPool> create() {
+                return std::shared_ptr<ReadBufferPool>(new ReadBufferPool());
+            }
+
+            /**
+             * Returns a buffer of the current buffer size to read into.
+             */
+            std::shared_ptr<SafeByteArray> getBuffer();
+
+            /**
+             * Records that a read returned \p bytesRead bytes into a buffer of
+             * \p bufferSize bytes, and adapts the size of the next buffer.
+             * Reads have to be reported one at a time.
+             */
+            void handleRead(size_t bytesRead, size_t bufferSize);
+
+            size_t getBufferSize() const {
+                return bufferSize_;
+            }
+
+            /**
+             * Returns the read counters. Sampling them periodically gives the
+             * reads per second and bytes per read.
+             */
+            Statistics getStatistics() const;
+
+        private:
+            ReadBufferPool();
+
+            void recycle(SafeByteArray* buffer);
+
+        private:
+            std::atomic<size_t> bufferSize_;
+            int smallReads_;
+            std::atomic<std::uint64_t> reads_;
+            std::atomic<std::uint64_t> bytesRead_;
+            std::mutex freeBuffersMutex_;
+            std::vector< std::unique_ptr<SafeByteArray> > freeBuffers_;
+    };
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <algorithm>
+#include <memory>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Network/ReadBufferPool.h>
+
+using namespace Swift;
+
+class ReadBufferPoolTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(ReadBufferPoolTest);
+        CPPUNIT_TEST(testGetBuffer);
+        CPPUNIT_TEST(testHandleRead_FullReadsGrowBuffer);
+        CPPUNIT_TEST(testHandleRead_SmallReadsShrinkBuffer);
+        CPPUNIT_TEST(testHandleRead_MediumReadsKeepBufferSize);
+        CPPUNIT_TEST(testGetBuffer_RecyclesReleasedBuffer);
+        CPPUNIT_TEST(testGetBuffer_KeepsBufferInUse);
+        CPPUNIT_TEST(testGetBuffer_ClearsRecycledBuffer);
+        CPPUNIT_TEST(testGetStatistics);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            testling_ = ReadBufferPool::create();
+        }
+
+        void testGetBuffer() {
+            std::shared_ptr<SafeByteArray> buffer = testling_->getBuffer();
+
+            CPPUNIT_ASSERT_EQUAL(ReadBufferPool::MinimumBufferSize, buffer->size());
+        }
+
+        void testHandleRead_FullReadsGrowBuffer() {
+            for (int i = 0; i < 10; ++i) {
+                size_t size = testling_->getBufferSize();
+                testling_->handleRead(size, size);
+            }
+
+            CPPUNIT_ASSERT_EQUAL(ReadBufferPool::MaximumBufferSize, testling_->getBufferSize());
+        }
+
+        void testHandleRead_SmallReadsShrinkBuffer() {
+            testling_->handleRead(4096, 4096);
+            testling_->handleRead(8192, 8192);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(16384), testling_->getBufferSize());
+
+            for (int i = 0; i < 7; ++i) {
+                testling_->handleRead(100, 16384);
+            }
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(16384), testling_->getBufferSize());
+
+            testling_->handleRead(100, 16384);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(8192), testling_->getBufferSize());
+
+            for (int i = 0; i < 100; ++i) {
+                testling_->handleRead(100, testling_->getBufferSize());
+            }
+            CPPUNIT_ASSERT_EQUAL(ReadBufferPool::MinimumBufferSize, testling_->getBufferSize());
+        }
+
+        void testHandleRead_MediumReadsKeepBufferSize() {
+            testling_->handleRead(4096, 4096);
+            for (int i = 0; i < 7; ++i) {
+                testling_->handleRead(100, 8192);
+            }
+            testling_->handleRead(4000, 8192);
+            for (int i = 0; i < 7; ++i) {
+                testling_->handleRead(100, 8192);
+            }
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(8192), testling_->getBufferSize());
+        }
+
+        void testGetBuffer_RecyclesReleasedBuffer() {
+            std::shared_ptr<SafeByteArray> buffer = testling_->getBuffer();
+            const SafeByteArray* bufferAddress = buffer.get();
+            buffer->resize(10);
+            buffer.reset();
+
+            buffer = testling_->getBuffer();
+
+            CPPUNIT_ASSERT(bufferAddress == buffer.get());
+            CPPUNIT_ASSERT_EQUAL(ReadBufferPool::MinimumBufferSize, buffer->size());
+        }
+
+        void testGetBuffer_KeepsBufferInUse() {
+            std::shared_ptr<SafeByteArray> buffer1 = testling_->getBuffer();
+            std::shared_ptr<SafeByteArray> buffer2 = testling_->getBuffer();
+
+            CPPUNIT_ASSERT(buffer1.get() != buffer2.get());
+        }
+
+        void testGetBuffer_ClearsRecycledBuffer() {
+            std::shared_ptr<SafeByteArray> buffer = testling_->getBuffer();
+            std::fill(buffer->begin(), buffer->end(), 'x');
+            buffer->resize(10);
+            buffer.reset();
+
+            buffer = testling_->getBuffer();
+
+            CPPUNIT_ASSERT(std::all_of(buffer->begin(), buffer->end(), [](unsigned char c) { return c == 0; }));
+        }
+
+        void testGetStatistics() {
+            testling_->handleRead(4096, 4096);
+            testling_->handleRead(100, 8192);
+
+            ReadBufferPool::Statistics statistics = testling_->getStatistics();
+            CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(2), statistics.reads);
+            CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(4196), statistics.bytesRead);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(8192), statistics.bufferSize);
+        }
+
+    private:
+        std::shared_ptr<ReadBufferPool> testling_;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ReadBufferPoolTest);
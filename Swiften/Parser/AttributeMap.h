@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -44,6 +44,14 @@ namespace Swift {
 
             void addAttribute(const std::string& name, const std::string& ns, const std::string& value);
 
+            /**
+             * Removes all attributes, keeping the allocated storage around
+             * for reuse.
+             */
+            void clear() {
+                attributes.clear();
+            }
+
             const std::vector<Entry>& getEntries() const {
                 return attributes;
             }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2016 Isode Limited.
+ * Copyright (c) 2011-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -127,9 +127,9 @@ BOSHBodyExtractor::BOSHBodyExtractor(XMLParserFactory* parserFactory, const Byte
     // Parse the body element
     BOSHBodyParserClient parserClient(this);
     std::shared_ptr<XMLParser> parser(parserFactory->createXMLParser(&parserClient));
-    if (!parser->parse(std::string(
+    if (!parser->parse(
             reinterpret_cast<const char*>(vecptr(data)),
-            boost::numeric_cast<size_t>(std::distance(data.begin(), i))))) {
+            boost::numeric_cast<size_t>(std::distance(data.begin(), i)))) {
         /* TODO: This needs to be only validating the BOSH <body> element, so that XMPP parsing errors are caught at
            the correct higher layer */
         body = boost::optional<BOSHBody>();
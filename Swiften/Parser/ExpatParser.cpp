@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,6 +7,7 @@
 #include <Swiften/Parser/ExpatParser.h>
 
 #include <cassert>
+#include <cstring>
 #include <memory>
 #include <string>
 
@@ -14,7 +15,7 @@
 
 #include <boost/numeric/conversion/cast.hpp>
 
-#include <Swiften/Base/String.h>
+#include <Swiften/Parser/XMLNameTable.h>
 #include <Swiften/Parser/XMLParserClient.h>
 
 #pragma clang diagnostic ignored "-Wdisabled-macro-expansion"
@@ -23,76 +24,102 @@ namespace Swift {
 
 static const char NAMESPACE_SEPARATOR = '\x01';
 
+namespace {
+    struct ParserState {
+        XML_Parser parser_;
+        XMLParserClient* client_;
+        XMLNameTable names_;
+        AttributeMap attributes_;
+        std::string characterData_;
+        std::string elementFallback_;
+        std::string nsFallback_;
+        std::string attributeFallback_;
+        std::string attributeNSFallback_;
+    };
+}
+
 struct ExpatParser::Private {
-    XML_Parser parser_;
+    ParserState state_;
 };
 
-static void handleStartElement(void* parser, const XML_Char* name, const XML_Char** attributes) {
-    std::pair<std::string,std::string> nsTagPair = String::getSplittedAtFirst(name, NAMESPACE_SEPARATOR);
-    if (nsTagPair.second == "") {
-        nsTagPair.second = nsTagPair.first;
-        nsTagPair.first = "";
+/**
+ * Splits a name of the form "namespace<separator>name" (or just "name") as
+ * reported by Expat, and looks up both parts in the name table.
+ */
+static void splitName(ParserState* p, const XML_Char* qualifiedName, const std::string** name, std::string& nameFallback, const std::string** ns, std::string& nsFallback) {
+    const char* separator = std::strchr(qualifiedName, NAMESPACE_SEPARATOR);
+    if (separator) {
+        *ns = &p->names_.intern(qualifiedName, static_cast<size_t>(separator - qualifiedName), nsFallback);
+        *name = &p->names_.intern(separator + 1, std::strlen(separator + 1), nameFallback);
+    }
+    else {
+        *ns = &p->names_.intern(qualifiedName, 0, nsFallback);
+        *name = &p->names_.intern(qualifiedName, std::strlen(qualifiedName), nameFallback);
     }
-    AttributeMap attributeValues;
+}
+
+static void handleStartElement(void* data, const XML_Char* qualifiedName, const XML_Char** attributes) {
+    ParserState* p = static_cast<ParserState*>(data);
+    const std::string* name;
+    const std::string* ns;
+    p->attributes_.clear();
     const XML_Char** currentAttribute = attributes;
     while (*currentAttribute) {
-        std::pair<std::string,std::string> nsAttributePair = String::getSplittedAtFirst(*currentAttribute, NAMESPACE_SEPARATOR);
-        if (nsAttributePair.second == "") {
-            nsAttributePair.second = nsAttributePair.first;
-            nsAttributePair.first = "";
-        }
-        attributeValues.addAttribute(nsAttributePair.second, nsAttributePair.first, std::string(*(currentAttribute+1)));
+        splitName(p, *currentAttribute, &name, p->attributeFallback_, &ns, p->attributeNSFallback_);
+        p->attributes_.addAttribute(*name, *ns, std::string(*(currentAttribute+1)));
         currentAttribute += 2;
     }
-
-    static_cast<XMLParser*>(parser)->getClient()->handleStartElement(nsTagPair.second, nsTagPair.first, attributeValues);
+    splitName(p, qualifiedName, &name, p->elementFallback_, &ns, p->nsFallback_);
+    p->client_->handleStartElement(*name, *ns, p->attributes_);
 }
 
-static void handleEndElement(void* parser, const XML_Char* name) {
-    std::pair<std::string,std::string> nsTagPair = String::getSplittedAtFirst(name, NAMESPACE_SEPARATOR);
-    if (nsTagPair.second == "") {
-        nsTagPair.second = nsTagPair.first;
-        nsTagPair.first = "";
-    }
-    static_cast<XMLParser*>(parser)->getClient()->handleEndElement(nsTagPair.second, nsTagPair.first);
+static void handleEndElement(void* data, const XML_Char* qualifiedName) {
+    ParserState* p = static_cast<ParserState*>(data);
+    const std::string* name;
+    const std::string* ns;
+    splitName(p, qualifiedName, &name, p->elementFallback_, &ns, p->nsFallback_);
+    p->client_->handleEndElement(*name, *ns);
 }
 
-static void handleCharacterData(void* parser, const XML_Char* data, int len) {
+static void handleCharacterData(void* data, const XML_Char* characterData, int len) {
     assert(len >= 0);
-    static_cast<XMLParser*>(parser)->getClient()->handleCharacterData(std::string(data, static_cast<size_t>(len)));
+    ParserState* p = static_cast<ParserState*>(data);
+    p->characterData_.assign(characterData, static_cast<size_t>(len));
+    p->client_->handleCharacterData(p->characterData_);
 }
 
 static void handleXMLDeclaration(void*, const XML_Char*, const XML_Char*, int) {
 }
 
-static void handleEntityDeclaration(void* parser, const XML_Char*, int, const XML_Char*, int, const XML_Char*, const XML_Char*, const XML_Char*, const XML_Char*) {
-    static_cast<ExpatParser*>(parser)->stopParser();
+static void handleEntityDeclaration(void* data, const XML_Char*, int, const XML_Char*, int, const XML_Char*, const XML_Char*, const XML_Char*, const XML_Char*) {
+    XML_StopParser(static_cast<ParserState*>(data)->parser_, static_cast<XML_Bool>(0));
 }
 
 
 ExpatParser::ExpatParser(XMLParserClient* client) : XMLParser(client), p(new Private()) {
-    p->parser_ = XML_ParserCreateNS("UTF-8", NAMESPACE_SEPARATOR);
-    XML_SetUserData(p->parser_, this);
-    XML_SetElementHandler(p->parser_, handleStartElement, handleEndElement);
-    XML_SetCharacterDataHandler(p->parser_, handleCharacterData);
-    XML_SetXmlDeclHandler(p->parser_, handleXMLDeclaration);
-    XML_SetEntityDeclHandler(p->parser_, handleEntityDeclaration);
+    p->state_.parser_ = XML_ParserCreateNS("UTF-8", NAMESPACE_SEPARATOR);
+    p->state_.client_ = client;
+    XML_SetUserData(p->state_.parser_, &p->state_);
+    XML_SetElementHandler(p->state_.parser_, handleStartElement, handleEndElement);
+    XML_SetCharacterDataHandler(p->state_.parser_, handleCharacterData);
+    XML_SetXmlDeclHandler(p->state_.parser_, handleXMLDeclaration);
+    XML_SetEntityDeclHandler(p->state_.parser_, handleEntityDeclaration);
 }
 
 ExpatParser::~ExpatParser() {
-    XML_ParserFree(p->parser_);
+    XML_ParserFree(p->state_.parser_);
 }
 
-bool ExpatParser::parse(const std::string& data) {
-    bool success = XML_Parse(p->parser_, data.c_str(), boost::numeric_cast<int>(data.size()), false) == XML_STATUS_OK;
+bool ExpatParser::parse(const char* data, size_t size) {
+    bool success = XML_Parse(p->state_.parser_, data, boost::numeric_cast<int>(size), false) == XML_STATUS_OK;
     /*if (!success) {
-        std::cout << "ERROR: " << XML_ErrorString(XML_GetErrorCode(p->parser_)) << " while parsing " << data << std::endl;
+        std::cout << "ERROR: " << XML_ErrorString(XML_GetErrorCode(p->state_.parser_)) << " while parsing " << data << std::endl;
     }*/
     return success;
 }
 
 void ExpatParser::stopParser() {
-    XML_StopParser(p->parser_, static_cast<XML_Bool>(0));
+    XML_StopParser(p->state_.parser_, static_cast<XML_Bool>(0));
 }
 
 }
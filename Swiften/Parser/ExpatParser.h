@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -19,7 +19,8 @@ namespace Swift {
             ExpatParser(XMLParserClient* client);
             ~ExpatParser();
 
-            bool parse(const std::string& data);
+            using XMLParser::parse;
+            bool parse(const char* data, size_t size);
 
             void stopParser();
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include <Swiften/Base/API.h>
 #include <Swiften/Parser/PayloadParserFactory.h>
@@ -29,6 +30,13 @@ namespace Swift {
                 return (tag_.empty() ? true : element == tag_) && (xmlns_.empty() ? true : xmlns_ == ns);
             }
 
+            virtual std::vector<ElementKey> getElementKeys() const {
+                if (tag_.empty() && xmlns_.empty()) {
+                    return std::vector<ElementKey>();
+                }
+                return std::vector<ElementKey>(1, ElementKey(tag_, xmlns_));
+            }
+
             virtual PayloadParser* createPayloadParser() {
                 return new PARSER_TYPE(parsers_);
             }
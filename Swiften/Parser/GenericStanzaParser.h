@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -31,6 +31,11 @@ namespace Swift {
                 return stanza_;
             }
 
+            virtual void reset() {
+                StanzaParser::reset();
+                stanza_ = std::make_shared<STANZA_TYPE>();
+            }
+
         private:
             std::shared_ptr<STANZA_TYPE> stanza_;
     };
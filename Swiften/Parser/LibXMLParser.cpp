@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -16,41 +16,64 @@
 #include <libxml/parser.h>
 
 #include <Swiften/Base/Log.h>
+#include <Swiften/Parser/XMLNameTable.h>
 #include <Swiften/Parser/XMLParserClient.h>
 
 namespace Swift {
 
+namespace {
+    struct ParserState {
+        XMLParserClient* client_;
+        XMLNameTable names_;
+        AttributeMap attributes_;
+        std::string characterData_;
+        std::string elementFallback_;
+        std::string nsFallback_;
+        std::string attributeFallback_;
+        std::string attributeNSFallback_;
+    };
+}
+
 struct LibXMLParser::Private {
     xmlSAXHandler handler_;
     xmlParserCtxtPtr context_;
+    ParserState state_;
 };
 
-static void handleStartElement(void* parser, const xmlChar* name, const xmlChar*, const xmlChar* xmlns, int, const xmlChar**, int nbAttributes, int nbDefaulted, const xmlChar ** attributes) {
-    AttributeMap attributeValues;
+static const std::string& internName(ParserState* p, const xmlChar* name, std::string& fallback) {
+    if (!name) {
+        return p->names_.intern("", 0, fallback);
+    }
+    const char* data = reinterpret_cast<const char*>(name);
+    return p->names_.intern(data, std::strlen(data), fallback);
+}
+
+static void handleStartElement(void* data, const xmlChar* name, const xmlChar*, const xmlChar* xmlns, int, const xmlChar**, int nbAttributes, int nbDefaulted, const xmlChar ** attributes) {
+    ParserState* p = static_cast<ParserState*>(data);
+    p->attributes_.clear();
     if (nbDefaulted != 0) {
         // Just because i don't understand what this means yet :-)
         SWIFT_LOG(error) << "Unexpected nbDefaulted on XML element" << std::endl;
     }
     for (int i = 0; i < nbAttributes*5; i += 5) {
-        std::string attributeNS = "";
-        if (attributes[i+2]) {
-            attributeNS = std::string(reinterpret_cast<const char*>(attributes[i+2]));
-        }
-        attributeValues.addAttribute(
-                std::string(reinterpret_cast<const char*>(attributes[i])),
-                attributeNS,
+        p->attributes_.addAttribute(
+                internName(p, attributes[i], p->attributeFallback_),
+                internName(p, attributes[i+2], p->attributeNSFallback_),
                 std::string(reinterpret_cast<const char*>(attributes[i+3]),
                     boost::numeric_cast<size_t>(attributes[i+4]-attributes[i+3])));
     }
-    static_cast<XMLParser*>(parser)->getClient()->handleStartElement(reinterpret_cast<const char*>(name), (xmlns ? reinterpret_cast<const char*>(xmlns) : std::string()), attributeValues);
+    p->client_->handleStartElement(internName(p, name, p->elementFallback_), internName(p, xmlns, p->nsFallback_), p->attributes_);
 }
 
-static void handleEndElement(void *parser, const xmlChar* name, const xmlChar*, const xmlChar* xmlns) {
-    static_cast<XMLParser*>(parser)->getClient()->handleEndElement(reinterpret_cast<const char*>(name), (xmlns ? reinterpret_cast<const char*>(xmlns) : std::string()));
+static void handleEndElement(void* data, const xmlChar* name, const xmlChar*, const xmlChar* xmlns) {
+    ParserState* p = static_cast<ParserState*>(data);
+    p->client_->handleEndElement(internName(p, name, p->elementFallback_), internName(p, xmlns, p->nsFallback_));
 }
 
-static void handleCharacterData(void* parser, const xmlChar* data, int len) {
-    static_cast<XMLParser*>(parser)->getClient()->handleCharacterData(std::string(reinterpret_cast<const char*>(data), boost::numeric_cast<size_t>(len)));
+static void handleCharacterData(void* data, const xmlChar* characterData, int len) {
+    ParserState* p = static_cast<ParserState*>(data);
+    p->characterData_.assign(reinterpret_cast<const char*>(characterData), boost::numeric_cast<size_t>(len));
+    p->client_->handleCharacterData(p->characterData_);
 }
 
 static void handleError(void*, const char* /*m*/, ... ) {
@@ -82,7 +105,8 @@ LibXMLParser::LibXMLParser(XMLParserClient* client) : XMLParser(client), p(new P
     p->handler_.warning = &handleWarning;
     p->handler_.error = &handleError;
 
-    p->context_ = xmlCreatePushParserCtxt(&p->handler_, this, nullptr, 0, nullptr);
+    p->state_.client_ = client;
+    p->context_ = xmlCreatePushParserCtxt(&p->handler_, &p->state_, nullptr, 0, nullptr);
     xmlCtxtUseOptions(p->context_, XML_PARSE_NOENT);
     assert(p->context_);
 }
@@ -93,8 +117,8 @@ LibXMLParser::~LibXMLParser() {
     }
 }
 
-bool LibXMLParser::parse(const std::string& data) {
-    if (xmlParseChunk(p->context_, data.c_str(), boost::numeric_cast<int>(data.size()), false) == XML_ERR_OK) {
+bool LibXMLParser::parse(const char* data, size_t size) {
+    if (xmlParseChunk(p->context_, data, boost::numeric_cast<int>(size), false) == XML_ERR_OK) {
         return true;
     }
     xmlError* error = xmlCtxtGetLastError(p->context_);
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -22,7 +22,8 @@ namespace Swift {
             LibXMLParser(XMLParserClient* client);
             virtual ~LibXMLParser();
 
-            bool parse(const std::string& data);
+            using XMLParser::parse;
+            bool parse(const char* data, size_t size);
 
         private:
             static bool initialized;
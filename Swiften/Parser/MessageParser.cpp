@@ -12,7 +12,12 @@ namespace Swift {
 
 MessageParser::MessageParser(PayloadParserFactoryCollection* factories) :
         GenericStanzaParser<Message>(factories) {
-    GenericStanzaParser<Message>::getStanzaGeneric()->setType(Message::Normal);
+    getStanzaGeneric()->setType(Message::Normal);
+}
+
+void MessageParser::reset() {
+    GenericStanzaParser<Message>::reset();
+    getStanzaGeneric()->setType(Message::Normal);
 }
 
 void MessageParser::handleStanzaAttributes(const AttributeMap& attributes) {
@@ -15,6 +15,8 @@ namespace Swift {
         public:
             MessageParser(PayloadParserFactoryCollection* factories);
 
+            virtual void reset();
+
         private:
             virtual void handleStanzaAttributes(const AttributeMap&);
     };
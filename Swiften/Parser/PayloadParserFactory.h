@@ -1,11 +1,15 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include <Swiften/Base/API.h>
 #include <Swiften/Parser/AttributeMap.h>
 
@@ -17,6 +21,12 @@ namespace Swift {
      * A factory for PayloadParsers.
      */
     class SWIFTEN_API PayloadParserFactory {
+        public:
+            /**
+             * An (element, namespace) pair. An empty element or namespace matches any element or namespace.
+             */
+            typedef std::pair<std::string, std::string> ElementKey;
+
         public:
             virtual ~PayloadParserFactory();
 
@@ -25,6 +35,14 @@ namespace Swift {
              */
             virtual bool canParse(const std::string& element, const std::string& ns, const AttributeMap& attributes) const = 0;
 
+            /**
+             * Returns the elements this factory can parse, if canParse() only depends on the element and namespace.
+             *
+             * This allows a PayloadParserFactoryCollection to find the factory without calling canParse().
+             * Factories that return no keys (the default) are asked through canParse() for every element.
+             */
+            virtual std::vector<ElementKey> getElementKeys() const;
+
             /**
              * Creates a new payload parser.
              */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,8 +8,6 @@
 
 #include <algorithm>
 
-#include <boost/bind.hpp>
-
 #include <Swiften/Parser/PayloadParserFactory.h>
 
 namespace Swift {
@@ -22,21 +20,75 @@ PayloadParserFactoryCollection::~PayloadParserFactoryCollection() {
 
 void PayloadParserFactoryCollection::addFactory(PayloadParserFactory* factory) {
     factories_.push_back(factory);
+    indexFactory(factories_.size() - 1);
 }
 
 void PayloadParserFactoryCollection::removeFactory(PayloadParserFactory* factory) {
     factories_.erase(std::remove(factories_.begin(), factories_.end(), factory), factories_.end());
+    rebuildIndex();
 }
 
 void PayloadParserFactoryCollection::setDefaultFactory(PayloadParserFactory* factory) {
     defaultFactory_ = factory;
 }
 
+void PayloadParserFactoryCollection::indexFactory(size_t index) {
+    std::vector<PayloadParserFactory::ElementKey> keys = factories_[index]->getElementKeys();
+    if (keys.empty()) {
+        unindexedFactories_.push_back(index);
+        return;
+    }
+    for (const auto& key : keys) {
+        if (key.first.empty() && key.second.empty()) {
+            unindexedFactories_.push_back(index);
+        }
+        else if (key.first.empty()) {
+            anyElementIndex_[key.second] = index;
+        }
+        else if (key.second.empty()) {
+            anyNamespaceIndex_[key.first] = index;
+        }
+        else {
+            elementIndex_[key.second][key.first] = index;
+        }
+    }
+}
+
+void PayloadParserFactoryCollection::rebuildIndex() {
+    elementIndex_.clear();
+    anyNamespaceIndex_.clear();
+    anyElementIndex_.clear();
+    unindexedFactories_.clear();
+    for (size_t i = 0; i < factories_.size(); ++i) {
+        indexFactory(i);
+    }
+}
+
+static void updateMatch(const std::unordered_map<std::string, size_t>& index, const std::string& key, bool& found, size_t& match) {
+    std::unordered_map<std::string, size_t>::const_iterator i = index.find(key);
+    if (i != index.end() && (!found || i->second > match)) {
+        found = true;
+        match = i->second;
+    }
+}
+
 PayloadParserFactory* PayloadParserFactoryCollection::getPayloadParserFactory(const std::string& element, const std::string& ns, const AttributeMap& attributes) {
-    std::vector<PayloadParserFactory*>::reverse_iterator i = std::find_if(
-            factories_.rbegin(), factories_.rend(),
-            boost::bind(&PayloadParserFactory::canParse, _1, element, ns, attributes));
-    return (i != factories_.rend() ? *i : defaultFactory_);
+    // The most recently added factory that can parse the element wins.
+    bool found = false;
+    size_t match = 0;
+    std::unordered_map<std::string, NameIndex>::const_iterator namespaceIndex = elementIndex_.find(ns);
+    if (namespaceIndex != elementIndex_.end()) {
+        updateMatch(namespaceIndex->second, element, found, match);
+    }
+    updateMatch(anyNamespaceIndex_, element, found, match);
+    updateMatch(anyElementIndex_, ns, found, match);
+
+    for (std::vector<size_t>::const_reverse_iterator i = unindexedFactories_.rbegin(); i != unindexedFactories_.rend() && (!found || *i > match); ++i) {
+        if (factories_[*i]->canParse(element, ns, attributes)) {
+            return factories_[*i];
+        }
+    }
+    return (found ? factories_[match] : defaultFactory_);
 }
 
 }
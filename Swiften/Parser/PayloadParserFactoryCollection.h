@@ -1,11 +1,13 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <Swiften/Base/API.h>
@@ -26,7 +28,27 @@ namespace Swift {
             PayloadParserFactory* getPayloadParserFactory(const std::string& element, const std::string& ns, const AttributeMap& attributes);
 
         private:
+            void indexFactory(size_t index);
+            void rebuildIndex();
+
+        private:
+            typedef std::unordered_map<std::string, size_t> NameIndex;
+
             std::vector<PayloadParserFactory*> factories_;
             PayloadParserFactory* defaultFactory_;
+
+            /**
+             * Indexes of the factories in factories_ that can parse an element
+             * based on its name and namespace only. Each entry holds the index of the
+             * most recently added factory for that key.
+             */
+            std::unordered_map<std::string, NameIndex> elementIndex_;
+            NameIndex anyNamespaceIndex_;
+            NameIndex anyElementIndex_;
+
+            /**
+             * Indexes of the factories that need to be asked through canParse().
+             */
+            std::vector<size_t> unindexedFactories_;
     };
 }
@@ -22,6 +22,16 @@ namespace Swift {
                      || element == "paused" || element == "inactive" || element == "gone");
             }
 
+            virtual std::vector<ElementKey> getElementKeys() const {
+                std::vector<ElementKey> keys;
+                keys.push_back(ElementKey("active", "http://jabber.org/protocol/chatstates"));
+                keys.push_back(ElementKey("composing", "http://jabber.org/protocol/chatstates"));
+                keys.push_back(ElementKey("paused", "http://jabber.org/protocol/chatstates"));
+                keys.push_back(ElementKey("inactive", "http://jabber.org/protocol/chatstates"));
+                keys.push_back(ElementKey("gone", "http://jabber.org/protocol/chatstates"));
+                return keys;
+            }
+
             virtual PayloadParser* createPayloadParser() {
                 return new ChatStateParser();
             }
@@ -27,6 +27,13 @@ namespace Swift {
                     (element == "active" || element == "inactive");
             }
 
+            virtual std::vector<ElementKey> getElementKeys() const {
+                std::vector<ElementKey> keys;
+                keys.push_back(ElementKey("active", "urn:xmpp:csi:0"));
+                keys.push_back(ElementKey("inactive", "urn:xmpp:csi:0"));
+                return keys;
+            }
+
             virtual PayloadParser* createPayloadParser() {
                 return new ClientStateParser();
             }
@@ -26,6 +26,10 @@ namespace Swift {
                 return ns == "urn:xmpp:receipts" && element == "received";
             }
 
+            virtual std::vector<ElementKey> getElementKeys() const {
+                return std::vector<ElementKey>(1, ElementKey("received", "urn:xmpp:receipts"));
+            }
+
             virtual PayloadParser* createPayloadParser() {
                 return new DeliveryReceiptParser();
             }
@@ -26,6 +26,10 @@ namespace Swift {
                 return ns == "urn:xmpp:receipts" && element == "request";
             }
 
+            virtual std::vector<ElementKey> getElementKeys() const {
+                return std::vector<ElementKey>(1, ElementKey("request", "urn:xmpp:receipts"));
+            }
+
             virtual PayloadParser* createPayloadParser() {
                 return new DeliveryReceiptRequestParser();
             }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2015 Isode Limited.
+ * Copyright (c) 2011-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -22,6 +22,10 @@ namespace Swift {
                 return element == "error";
             }
 
+            virtual std::vector<ElementKey> getElementKeys() const {
+                return std::vector<ElementKey>(1, ElementKey("error", ""));
+            }
+
             virtual PayloadParser* createPayloadParser() {
                 return new ErrorParser(factories);
             }
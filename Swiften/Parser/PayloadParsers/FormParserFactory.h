@@ -20,6 +20,10 @@ namespace Swift {
                 return ns == "jabber:x:data";
             }
 
+            virtual std::vector<ElementKey> getElementKeys() const {
+                return std::vector<ElementKey>(1, ElementKey("", "jabber:x:data"));
+            }
+
             virtual PayloadParser* createPayloadParser() {
                 return new FormParser();
             }
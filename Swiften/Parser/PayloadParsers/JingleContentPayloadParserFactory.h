@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (c) 2015 Isode Limited.
+ * Copyright (c) 2015-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -29,6 +29,10 @@ namespace Swift {
                 return element == "content" && ns == "urn:xmpp:jingle:1";
             }
 
+            virtual std::vector<ElementKey> getElementKeys() const {
+                return std::vector<ElementKey>(1, ElementKey("content", "urn:xmpp:jingle:1"));
+            }
+
             virtual PayloadParser* createPayloadParser() {
                 return new JingleContentPayloadParser(factories);
             }
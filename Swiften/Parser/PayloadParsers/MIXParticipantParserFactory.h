@@ -20,6 +20,10 @@ namespace Swift {
                 return element == "participant" && ns == "urn:xmpp:mix:0";
             }
 
+            virtual std::vector<ElementKey> getElementKeys() const {
+                return std::vector<ElementKey>(1, ElementKey("participant", "urn:xmpp:mix:0"));
+            }
+
             virtual PayloadParser* createPayloadParser() {
                 return new MIXParticipantParser();
             }
@@ -26,6 +26,10 @@ namespace Swift {
                 return element == "mix" && ns == "urn:xmpp:mix:0";
             }
 
+            virtual std::vector<ElementKey> getElementKeys() const override {
+                return std::vector<ElementKey>(1, ElementKey("mix", "urn:xmpp:mix:0"));
+            }
+
             virtual PayloadParser* createPayloadParser() override {
                 return new MIXPayloadParser();
             }
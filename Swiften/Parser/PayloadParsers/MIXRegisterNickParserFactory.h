@@ -20,6 +20,10 @@ namespace Swift {
                 return element == "register" && ns == "urn:xmpp:mix:0";
             }
 
+            virtual std::vector<ElementKey> getElementKeys() const override {
+                return std::vector<ElementKey>(1, ElementKey("register", "urn:xmpp:mix:0"));
+            }
+
             virtual PayloadParser* createPayloadParser() override {
                 return new MIXRegisterNickParser();
             }
@@ -26,6 +26,10 @@ namespace Swift {
                 return element == "setnick" && ns == "urn:xmpp:mix:0";
             }
 
+            virtual std::vector<ElementKey> getElementKeys() const override {
+                return std::vector<ElementKey>(1, ElementKey("setnick", "urn:xmpp:mix:0"));
+            }
+
             virtual PayloadParser* createPayloadParser() override {
                 return new MIXSetNickParser();
             }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2015 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -20,6 +20,10 @@ namespace Swift {
                 return element == "x" && ns == "http://jabber.org/protocol/muc#user";
             }
 
+            virtual std::vector<ElementKey> getElementKeys() const {
+                return std::vector<ElementKey>(1, ElementKey("x", "http://jabber.org/protocol/muc#user"));
+            }
+
             virtual PayloadParser* createPayloadParser() {
                 return new MUCUserPayloadParser(factories);
             }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2015 Isode Limited.
+ * Copyright (c) 2013-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -21,6 +21,10 @@ namespace Swift {
                 return ns == "http://jabber.org/protocol/pubsub#errors";
             }
 
+            virtual std::vector<ElementKey> getElementKeys() const {
+                return std::vector<ElementKey>(1, ElementKey("", "http://jabber.org/protocol/pubsub#errors"));
+            }
+
             virtual PayloadParser* createPayloadParser() {
                 return new PubSubErrorParser();
             }
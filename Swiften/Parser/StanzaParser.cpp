@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -24,6 +24,11 @@ StanzaParser::StanzaParser(PayloadParserFactoryCollection* factories) :
 StanzaParser::~StanzaParser() {
 }
 
+void StanzaParser::reset() {
+    currentDepth_ = 0;
+    currentPayloadParser_.reset();
+}
+
 void StanzaParser::handleStartElement(const std::string& element, const std::string& ns, const AttributeMap& attributes) {
     if (inStanza()) {
         if (!inPayload()) {
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -36,6 +36,12 @@ namespace Swift {
                 return std::dynamic_pointer_cast<Stanza>(getElement());
             }
 
+            /**
+             * Prepares the parser for parsing a new stanza, so that the
+             * parser object can be reused.
+             */
+            virtual void reset();
+
         private:
             bool inPayload() const {
                 return currentDepth_ > 1;
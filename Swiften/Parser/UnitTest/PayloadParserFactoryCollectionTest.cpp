@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -20,6 +20,12 @@ class PayloadParserFactoryCollectionTest : public CppUnit::TestFixture
         CPPUNIT_TEST(testGetPayloadParserFactory_TwoMatchingFactories);
         CPPUNIT_TEST(testGetPayloadParserFactory_MatchWithDefaultFactory);
         CPPUNIT_TEST(testGetPayloadParserFactory_NoMatchWithDefaultFactory);
+        CPPUNIT_TEST(testGetPayloadParserFactory_IndexedFactory);
+        CPPUNIT_TEST(testGetPayloadParserFactory_IndexedFactoryAnyNamespace);
+        CPPUNIT_TEST(testGetPayloadParserFactory_IndexedFactoryAnyElement);
+        CPPUNIT_TEST(testGetPayloadParserFactory_LastAddedIndexedFactoryWins);
+        CPPUNIT_TEST(testGetPayloadParserFactory_LastAddedUnindexedFactoryWins);
+        CPPUNIT_TEST(testGetPayloadParserFactory_RemovedIndexedFactory);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -88,6 +94,78 @@ class PayloadParserFactoryCollectionTest : public CppUnit::TestFixture
             CPPUNIT_ASSERT(factory == &factory2);
         }
 
+        void testGetPayloadParserFactory_IndexedFactory() {
+            PayloadParserFactoryCollection testling;
+            DummyIndexedFactory factory1("foo", "ns1");
+            testling.addFactory(&factory1);
+            DummyIndexedFactory factory2("foo", "ns2");
+            testling.addFactory(&factory2);
+
+            CPPUNIT_ASSERT(testling.getPayloadParserFactory("foo", "ns1", AttributeMap()) == &factory1);
+            CPPUNIT_ASSERT(testling.getPayloadParserFactory("foo", "ns2", AttributeMap()) == &factory2);
+            CPPUNIT_ASSERT(!testling.getPayloadParserFactory("foo", "ns3", AttributeMap()));
+            CPPUNIT_ASSERT(!testling.getPayloadParserFactory("bar", "ns1", AttributeMap()));
+        }
+
+        void testGetPayloadParserFactory_IndexedFactoryAnyNamespace() {
+            PayloadParserFactoryCollection testling;
+            DummyIndexedFactory factory("foo", "");
+            testling.addFactory(&factory);
+
+            CPPUNIT_ASSERT(testling.getPayloadParserFactory("foo", "ns1", AttributeMap()) == &factory);
+            CPPUNIT_ASSERT(testling.getPayloadParserFactory("foo", "", AttributeMap()) == &factory);
+            CPPUNIT_ASSERT(!testling.getPayloadParserFactory("bar", "ns1", AttributeMap()));
+        }
+
+        void testGetPayloadParserFactory_IndexedFactoryAnyElement() {
+            PayloadParserFactoryCollection testling;
+            DummyIndexedFactory factory("", "ns1");
+            testling.addFactory(&factory);
+
+            CPPUNIT_ASSERT(testling.getPayloadParserFactory("foo", "ns1", AttributeMap()) == &factory);
+            CPPUNIT_ASSERT(!testling.getPayloadParserFactory("foo", "ns2", AttributeMap()));
+        }
+
+        void testGetPayloadParserFactory_LastAddedIndexedFactoryWins() {
+            PayloadParserFactoryCollection testling;
+            DummyFactory factory1("foo");
+            testling.addFactory(&factory1);
+            DummyIndexedFactory factory2("foo", "");
+            testling.addFactory(&factory2);
+            DummyIndexedFactory factory3("foo", "ns1");
+            testling.addFactory(&factory3);
+
+            CPPUNIT_ASSERT(testling.getPayloadParserFactory("foo", "ns1", AttributeMap()) == &factory3);
+            CPPUNIT_ASSERT(testling.getPayloadParserFactory("foo", "ns2", AttributeMap()) == &factory2);
+        }
+
+        void testGetPayloadParserFactory_LastAddedUnindexedFactoryWins() {
+            PayloadParserFactoryCollection testling;
+            DummyIndexedFactory factory1("foo", "ns1");
+            testling.addFactory(&factory1);
+            DummyFactory factory2("foo");
+            testling.addFactory(&factory2);
+            DummyIndexedFactory factory3("bar", "ns1");
+            testling.addFactory(&factory3);
+
+            CPPUNIT_ASSERT(testling.getPayloadParserFactory("foo", "ns1", AttributeMap()) == &factory2);
+            CPPUNIT_ASSERT(testling.getPayloadParserFactory("bar", "ns1", AttributeMap()) == &factory3);
+        }
+
+        void testGetPayloadParserFactory_RemovedIndexedFactory() {
+            PayloadParserFactoryCollection testling;
+            DummyIndexedFactory factory1("foo", "ns1");
+            testling.addFactory(&factory1);
+            DummyIndexedFactory factory2("foo", "ns1");
+            testling.addFactory(&factory2);
+            DummyIndexedFactory factory3("bar", "ns1");
+            testling.addFactory(&factory3);
+
+            testling.removeFactory(&factory2);
+
+            CPPUNIT_ASSERT(testling.getPayloadParserFactory("foo", "ns1", AttributeMap()) == &factory1);
+            CPPUNIT_ASSERT(testling.getPayloadParserFactory("bar", "ns1", AttributeMap()) == &factory3);
+        }
 
     private:
         struct DummyFactory : public PayloadParserFactory {
@@ -98,6 +176,20 @@ class PayloadParserFactoryCollectionTest : public CppUnit::TestFixture
             virtual PayloadParser* createPayloadParser() { return nullptr; }
             std::string element;
         };
+
+        struct DummyIndexedFactory : public PayloadParserFactory {
+            DummyIndexedFactory(const std::string& element, const std::string& ns) : element(element), ns(ns) {}
+            virtual bool canParse(const std::string&, const std::string&, const AttributeMap&) const {
+                CPPUNIT_FAIL("Indexed factories should not be asked");
+                return false;
+            }
+            virtual std::vector<ElementKey> getElementKeys() const {
+                return std::vector<ElementKey>(1, ElementKey(element, ns));
+            }
+            virtual PayloadParser* createPayloadParser() { return nullptr; }
+            std::string element;
+            std::string ns;
+        };
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(PayloadParserFactoryCollectionTest);
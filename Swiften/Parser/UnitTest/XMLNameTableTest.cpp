@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <string>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Parser/XMLNameTable.h>
+
+using namespace Swift;
+
+class XMLNameTableTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(XMLNameTableTest);
+        CPPUNIT_TEST(testIntern);
+        CPPUNIT_TEST(testIntern_ReturnsSameString);
+        CPPUNIT_TEST(testIntern_EmptyName);
+        CPPUNIT_TEST(testIntern_Grow);
+        CPPUNIT_TEST(testIntern_Full);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void testIntern() {
+            XMLNameTable testling;
+            std::string fallback;
+
+            CPPUNIT_ASSERT_EQUAL(std::string("message"), testling.intern("message", 7, fallback));
+            CPPUNIT_ASSERT_EQUAL(std::string("body"), testling.intern("bodyfoo", 4, fallback));
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), testling.getSize());
+        }
+
+        void testIntern_ReturnsSameString() {
+            XMLNameTable testling;
+            std::string fallback;
+
+            const std::string& first = testling.intern("jabber:client", 13, fallback);
+            std::string name("jabber:client");
+            const std::string& second = testling.intern(name.c_str(), name.size(), fallback);
+
+            CPPUNIT_ASSERT_EQUAL(&first, &second);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), testling.getSize());
+        }
+
+        void testIntern_EmptyName() {
+            XMLNameTable testling;
+            std::string fallback;
+
+            CPPUNIT_ASSERT_EQUAL(std::string(), testling.intern("", 0, fallback));
+        }
+
+        void testIntern_Grow() {
+            XMLNameTable testling;
+            std::string fallback;
+
+            const std::string& first = testling.intern("presence", 8, fallback);
+            for (int i = 0; i < 500; ++i) {
+                std::string name = "name" + std::to_string(i);
+                testling.intern(name.c_str(), name.size(), fallback);
+            }
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(501), testling.getSize());
+            CPPUNIT_ASSERT_EQUAL(&first, &testling.intern("presence", 8, fallback));
+            CPPUNIT_ASSERT_EQUAL(std::string("name123"), testling.intern("name123", 7, fallback));
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(501), testling.getSize());
+        }
+
+        void testIntern_Full() {
+            XMLNameTable testling(1);
+            std::string fallback;
+
+            const std::string& first = testling.intern("iq", 2, fallback);
+            const std::string& second = testling.intern("query", 5, fallback);
+
+            CPPUNIT_ASSERT_EQUAL(std::string("iq"), first);
+            CPPUNIT_ASSERT_EQUAL(std::string("query"), second);
+            CPPUNIT_ASSERT_EQUAL(static_cast<const std::string*>(&fallback), &second);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), testling.getSize());
+        }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(XMLNameTableTest);
@@ -31,6 +31,7 @@ class XMLParserTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testParse_InvalidXML);
         CPPUNIT_TEST(testParse_InErrorState);
         CPPUNIT_TEST(testParse_Incremental);
+        CPPUNIT_TEST(testParse_IncrementalFromBuffer);
         CPPUNIT_TEST(testParse_WhitespaceInAttribute);
         CPPUNIT_TEST(testParse_AttributeWithoutNamespace);
         CPPUNIT_TEST(testParse_AttributeWithNamespace);
@@ -217,6 +218,22 @@ class XMLParserTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(std::string("iq"), client_.events[1].data);
         }
 
+        void testParse_IncrementalFromBuffer() {
+            ParserType testling(&client_);
+            const char data[] = { '<', 'i', 'q', '>', '<', '/', 'i', 'q', '>', 'X' };
+
+            CPPUNIT_ASSERT(testling.parse(data, 3));
+            CPPUNIT_ASSERT(testling.parse(data + 3, 6));
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), client_.events.size());
+
+            CPPUNIT_ASSERT_EQUAL(Client::StartElement, client_.events[0].type);
+            CPPUNIT_ASSERT_EQUAL(std::string("iq"), client_.events[0].data);
+
+            CPPUNIT_ASSERT_EQUAL(Client::EndElement, client_.events[1].type);
+            CPPUNIT_ASSERT_EQUAL(std::string("iq"), client_.events[1].data);
+        }
+
         void testParse_WhitespaceInAttribute() {
             ParserType testling(&client_);
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -10,10 +10,12 @@
 #include <cppunit/extensions/HelperMacros.h>
 #include <cppunit/extensions/TestFactoryRegistry.h>
 
+#include <Swiften/Elements/AuthFailure.h>
 #include <Swiften/Elements/IQ.h>
 #include <Swiften/Elements/Message.h>
 #include <Swiften/Elements/Presence.h>
 #include <Swiften/Elements/ProtocolHeader.h>
+#include <Swiften/Elements/StartTLSFailure.h>
 #include <Swiften/Elements/StreamFeatures.h>
 #include <Swiften/Elements/UnknownElement.h>
 #include <Swiften/Parser/ElementParser.h>
@@ -31,6 +33,8 @@ class XMPPParserTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testParse_Presence);
         CPPUNIT_TEST(testParse_IQ);
         CPPUNIT_TEST(testParse_Message);
+        CPPUNIT_TEST(testParse_ConsecutiveStanzas);
+        CPPUNIT_TEST(testParse_FailureInDifferentNamespaces);
         CPPUNIT_TEST(testParse_StreamFeatures);
         CPPUNIT_TEST(testParse_UnknownElement);
         CPPUNIT_TEST(testParse_StrayCharacterData);
@@ -104,6 +108,41 @@ class XMPPParserTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT(dynamic_cast<Message*>(client_.events[1].element.get()));
         }
 
+        void testParse_ConsecutiveStanzas() {
+            XMPPParser testling(&client_, &factories_, &xmlParserFactory_);
+
+            CPPUNIT_ASSERT(testling.parse("<stream:stream xmlns='jabber:client' xmlns:stream='http://etherx.jabber.org/streams'>"));
+            CPPUNIT_ASSERT(testling.parse("<message from='foo@bar.com/baz' id='a' type='chat'/>"));
+            CPPUNIT_ASSERT(testling.parse("<message id='b'/>"));
+
+            CPPUNIT_ASSERT_EQUAL(3, static_cast<int>(client_.events.size()));
+            std::shared_ptr<Message> message1 = std::dynamic_pointer_cast<Message>(client_.events[1].element);
+            std::shared_ptr<Message> message2 = std::dynamic_pointer_cast<Message>(client_.events[2].element);
+            CPPUNIT_ASSERT(message1);
+            CPPUNIT_ASSERT(message2);
+            CPPUNIT_ASSERT(message1 != message2);
+            CPPUNIT_ASSERT_EQUAL(std::string("a"), message1->getID());
+            CPPUNIT_ASSERT_EQUAL(Message::Chat, message1->getType());
+            CPPUNIT_ASSERT_EQUAL(JID("foo@bar.com/baz"), message1->getFrom());
+            CPPUNIT_ASSERT_EQUAL(std::string("b"), message2->getID());
+            CPPUNIT_ASSERT_EQUAL(Message::Normal, message2->getType());
+            CPPUNIT_ASSERT(!message2->getFrom().isValid());
+        }
+
+        void testParse_FailureInDifferentNamespaces() {
+            XMPPParser testling(&client_, &factories_, &xmlParserFactory_);
+
+            CPPUNIT_ASSERT(testling.parse("<stream:stream xmlns:stream='http://etherx.jabber.org/streams'>"));
+            CPPUNIT_ASSERT(testling.parse("<failure xmlns='urn:ietf:params:xml:ns:xmpp-tls'/>"));
+            CPPUNIT_ASSERT(testling.parse("<failure xmlns='urn:ietf:params:xml:ns:xmpp-sasl'/>"));
+            CPPUNIT_ASSERT(testling.parse("<failure xmlns='urn:example'/>"));
+
+            CPPUNIT_ASSERT_EQUAL(4, static_cast<int>(client_.events.size()));
+            CPPUNIT_ASSERT(std::dynamic_pointer_cast<StartTLSFailure>(client_.events[1].element));
+            CPPUNIT_ASSERT(std::dynamic_pointer_cast<AuthFailure>(client_.events[2].element));
+            CPPUNIT_ASSERT(std::dynamic_pointer_cast<UnknownElement>(client_.events[3].element));
+        }
+
         void testParse_StreamFeatures() {
             XMPPParser testling(&client_, &factories_, &xmlParserFactory_);
 
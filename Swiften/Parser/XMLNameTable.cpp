@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/Parser/XMLNameTable.h>
+
+#include <cstring>
+
+namespace Swift {
+
+static size_t hashName(const char* data, size_t size) {
+    // FNV-1a
+    size_t hash = 2166136261U;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+XMLNameTable::XMLNameTable(size_t maximumSize) : entries_(64), size_(0), maximumSize_(maximumSize) {
+}
+
+const std::string& XMLNameTable::intern(const char* data, size_t size, std::string& fallback) {
+    size_t hash = hashName(data, size);
+    size_t mask = entries_.size() - 1;
+    for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+        Entry& entry = entries_[i];
+        if (!entry.name) {
+            if (size_ >= maximumSize_) {
+                fallback.assign(data, size);
+                return fallback;
+            }
+            entry.hash = hash;
+            entry.name = std::unique_ptr<std::string>(new std::string(data, size));
+            const std::string& result = *entry.name;
+            ++size_;
+            // Keep the load factor below 1/2
+            if (2 * size_ > entries_.size()) {
+                grow();
+            }
+            return result;
+        }
+        if (entry.hash == hash && entry.name->size() == size && std::memcmp(entry.name->data(), data, size) == 0) {
+            return *entry.name;
+        }
+    }
+}
+
+void XMLNameTable::grow() {
+    std::vector<Entry> oldEntries(entries_.size() * 2);
+    oldEntries.swap(entries_);
+    size_t mask = entries_.size() - 1;
+    for (auto& oldEntry : oldEntries) {
+        if (oldEntry.name) {
+            size_t i = oldEntry.hash & mask;
+            while (entries_[i].name) {
+                i = (i + 1) & mask;
+            }
+            entries_[i].hash = oldEntry.hash;
+            entries_[i].name = std::move(oldEntry.name);
+        }
+    }
+}
+
+}
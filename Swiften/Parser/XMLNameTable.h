@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <Swiften/Base/API.h>
+
+namespace Swift {
+    /**
+     * A symbol table for the element names, attribute names and namespaces
+     * reported by an XML parser.
+     *
+     * Looking up a name that has been seen before does not allocate, and
+     * always returns a reference to the same string. Since the names come
+     * from the (untrusted) stream, the table stops growing once it holds
+     * \p maximumSize names; other names are then copied into the caller's
+     * \p fallback string.
+     */
+    class SWIFTEN_API XMLNameTable : public boost::noncopyable {
+        public:
+            XMLNameTable(size_t maximumSize = 1024);
+
+            const std::string& intern(const char* data, size_t size, std::string& fallback);
+
+            size_t getSize() const {
+                return size_;
+            }
+
+        private:
+            void grow();
+
+        private:
+            struct Entry {
+                Entry() : hash(0) {}
+
+                size_t hash;
+                std::unique_ptr<std::string> name;
+            };
+            std::vector<Entry> entries_;
+            size_t size_;
+            size_t maximumSize_;
+    };
+}
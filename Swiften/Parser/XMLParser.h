@@ -1,11 +1,12 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <cstddef>
 #include <string>
 
 #include <Swiften/Base/API.h>
@@ -18,7 +19,16 @@ namespace Swift {
             XMLParser(XMLParserClient* client);
             virtual ~XMLParser();
 
-            virtual bool parse(const std::string& data) = 0;
+            /**
+             * Feeds a chunk of raw (UTF-8) data to the parser.
+             * The data is not required to be null-terminated, and is not
+             * retained after this call returns.
+             */
+            virtual bool parse(const char* data, size_t size) = 0;
+
+            bool parse(const std::string& data) {
+                return parse(data.c_str(), data.size());
+            }
 
             XMLParserClient* getClient() const {
                 return client_;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,6 +8,9 @@
 
 #include <cassert>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <Swiften/Elements/ProtocolHeader.h>
 #include <Swiften/Parser/AuthChallengeParser.h>
@@ -59,11 +62,15 @@ XMPPParser::XMPPParser(
 }
 
 XMPPParser::~XMPPParser() {
-    delete currentElementParser_;
+    releaseElementParser();
 }
 
 bool XMPPParser::parse(const std::string& data) {
-    bool xmlParseResult = xmlParser_->parse(data);
+    return parse(data.c_str(), data.size());
+}
+
+bool XMPPParser::parse(const char* data, size_t size) {
+    bool xmlParseResult = xmlParser_->parse(data, size);
     return xmlParseResult && !parseErrorOccurred_;
 }
 
@@ -106,8 +113,7 @@ void XMPPParser::handleEndElement(const std::string& element, const std::string&
             currentElementParser_->handleEndElement(element, ns);
             if (level_ == StreamLevel) {
                 client_->handleElement(currentElementParser_->getElement());
-                delete currentElementParser_;
-                currentElementParser_ = nullptr;
+                releaseElementParser();
             }
         }
     }
@@ -125,79 +131,86 @@ void XMPPParser::handleCharacterData(const std::string& data) {
 }
 
 ElementParser* XMPPParser::createElementParser(const std::string& element, const std::string& ns) {
-    if (element == "presence") {
-        return new PresenceParser(payloadParserFactories_);
-    }
-    else if (element == "iq") {
-        return new IQParser(payloadParserFactories_);
-    }
-    else if (element == "message") {
-        return new MessageParser(payloadParserFactories_);
-    }
-    else if (element == "features"  && ns == "http://etherx.jabber.org/streams") {
-        return new StreamFeaturesParser();
-    }
-    else if (element == "error" && ns == "http://etherx.jabber.org/streams") {
-        return new StreamErrorParser();
-    }
-    else if (element == "auth") {
-        return new AuthRequestParser();
-    }
-    else if (element == "success") {
-        return new AuthSuccessParser();
-    }
-    else if (element == "failure" && ns == "urn:ietf:params:xml:ns:xmpp-sasl") {
-        return new AuthFailureParser();
-    }
-    else if (element == "challenge" && ns == "urn:ietf:params:xml:ns:xmpp-sasl") {
-        return new AuthChallengeParser();
-    }
-    else if (element == "response" && ns == "urn:ietf:params:xml:ns:xmpp-sasl") {
-        return new AuthResponseParser();
-    }
-    else if (element == "starttls") {
-        return new StartTLSParser();
-    }
-    else if (element == "failure" && ns == "urn:ietf:params:xml:ns:xmpp-tls") {
-        return new StartTLSFailureParser();
-    }
-    else if (element == "compress") {
-        return new CompressParser();
-    }
-    else if (element == "compressed") {
-        return new CompressedParser();
-    }
-    else if (element == "failure" && ns == "http://jabber.org/protocol/compress") {
-        return new CompressFailureParser();
-    }
-    else if (element == "proceed") {
-        return new TLSProceedParser();
+    // Maps an element name to the parsers for it, with the namespace they
+    // apply to. An empty namespace matches any namespace.
+    typedef std::vector<std::pair<std::string, ElementParserCreator> > NamespaceCreators;
+    static const std::unordered_map<std::string, NamespaceCreators> creators = {
+        {"presence", {{"", &XMPPParser::getPresenceParser}}},
+        {"iq", {{"", &XMPPParser::getIQParser}}},
+        {"message", {{"", &XMPPParser::getMessageParser}}},
+        {"features", {{"http://etherx.jabber.org/streams", &XMPPParser::createParser<StreamFeaturesParser>}}},
+        {"error", {{"http://etherx.jabber.org/streams", &XMPPParser::createParser<StreamErrorParser>}}},
+        {"auth", {{"", &XMPPParser::createParser<AuthRequestParser>}}},
+        {"success", {{"", &XMPPParser::createParser<AuthSuccessParser>}}},
+        {"failure", {
+            {"urn:ietf:params:xml:ns:xmpp-sasl", &XMPPParser::createParser<AuthFailureParser>},
+            {"urn:ietf:params:xml:ns:xmpp-tls", &XMPPParser::createParser<StartTLSFailureParser>},
+            {"http://jabber.org/protocol/compress", &XMPPParser::createParser<CompressFailureParser>}}},
+        {"challenge", {{"urn:ietf:params:xml:ns:xmpp-sasl", &XMPPParser::createParser<AuthChallengeParser>}}},
+        {"response", {{"urn:ietf:params:xml:ns:xmpp-sasl", &XMPPParser::createParser<AuthResponseParser>}}},
+        {"starttls", {{"", &XMPPParser::createParser<StartTLSParser>}}},
+        {"compress", {{"", &XMPPParser::createParser<CompressParser>}}},
+        {"compressed", {{"", &XMPPParser::createParser<CompressedParser>}}},
+        {"proceed", {{"", &XMPPParser::createParser<TLSProceedParser>}}},
+        {"enable", {{"urn:xmpp:sm:2", &XMPPParser::createParser<EnableStreamManagementParser>}}},
+        {"enabled", {{"urn:xmpp:sm:2", &XMPPParser::createParser<StreamManagementEnabledParser>}}},
+        {"failed", {{"urn:xmpp:sm:2", &XMPPParser::createParser<StreamManagementFailedParser>}}},
+        {"resume", {{"urn:xmpp:sm:2", &XMPPParser::createParser<StreamResumeParser>}}},
+        {"resumed", {{"urn:xmpp:sm:2", &XMPPParser::createParser<StreamResumedParser>}}},
+        {"a", {{"urn:xmpp:sm:2", &XMPPParser::createParser<StanzaAckParser>}}},
+        {"r", {{"urn:xmpp:sm:2", &XMPPParser::createParser<StanzaAckRequestParser>}}},
+        {"handshake", {{"", &XMPPParser::createParser<ComponentHandshakeParser>}}}
+    };
+
+    std::unordered_map<std::string, NamespaceCreators>::const_iterator i = creators.find(element);
+    if (i != creators.end()) {
+        for (const auto& creator : i->second) {
+            if (creator.first.empty() || creator.first == ns) {
+                return (this->*creator.second)();
+            }
+        }
     }
-    else if (element == "enable" && ns == "urn:xmpp:sm:2") {
-        return new EnableStreamManagementParser();
+    return new UnknownElementParser();
+}
+
+void XMPPParser::releaseElementParser() {
+    if (!currentElementParser_) {
+        return;
     }
-    else if (element == "enabled" && ns == "urn:xmpp:sm:2") {
-        return new StreamManagementEnabledParser();
+    if (currentElementParser_ == presenceParser_.get()) {
+        presenceParser_->reset();
     }
-    else if (element == "failed" && ns == "urn:xmpp:sm:2") {
-        return new StreamManagementFailedParser();
+    else if (currentElementParser_ == iqParser_.get()) {
+        iqParser_->reset();
     }
-    else if (element == "resume" && ns == "urn:xmpp:sm:2") {
-        return new StreamResumeParser();
+    else if (currentElementParser_ == messageParser_.get()) {
+        messageParser_->reset();
     }
-    else if (element == "resumed" && ns == "urn:xmpp:sm:2") {
-        return new StreamResumedParser();
+    else {
+        delete currentElementParser_;
     }
-    else if (element == "a" && ns == "urn:xmpp:sm:2") {
-        return new StanzaAckParser();
+    currentElementParser_ = nullptr;
+}
+
+ElementParser* XMPPParser::getPresenceParser() {
+    if (!presenceParser_) {
+        presenceParser_ = std::unique_ptr<PresenceParser>(new PresenceParser(payloadParserFactories_));
     }
-    else if (element == "r" && ns == "urn:xmpp:sm:2") {
-        return new StanzaAckRequestParser();
+    return presenceParser_.get();
+}
+
+ElementParser* XMPPParser::getIQParser() {
+    if (!iqParser_) {
+        iqParser_ = std::unique_ptr<IQParser>(new IQParser(payloadParserFactories_));
     }
-    else if (element == "handshake") {
-        return new ComponentHandshakeParser();
+    return iqParser_.get();
+}
+
+ElementParser* XMPPParser::getMessageParser() {
+    if (!messageParser_) {
+        messageParser_ = std::unique_ptr<MessageParser>(new MessageParser(payloadParserFactories_));
     }
-    return new UnknownElementParser();
+    return messageParser_.get();
 }
 
 }
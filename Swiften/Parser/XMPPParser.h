@@ -1,11 +1,12 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <cstddef>
 #include <memory>
 
 #include <boost/noncopyable.hpp>
@@ -20,6 +21,9 @@ namespace Swift {
     class XMLParserFactory;
     class ElementParser;
     class PayloadParserFactoryCollection;
+    class PresenceParser;
+    class IQParser;
+    class MessageParser;
 
     class SWIFTEN_API XMPPParser : public XMLParserClient, boost::noncopyable {
         public:
@@ -30,6 +34,7 @@ namespace Swift {
             virtual ~XMPPParser();
 
             bool parse(const std::string&);
+            bool parse(const char* data, size_t size);
 
         private:
             virtual void handleStartElement(
@@ -40,8 +45,19 @@ namespace Swift {
             virtual void handleCharacterData(const std::string& data);
 
             ElementParser* createElementParser(const std::string& element, const std::string& xmlns);
+            void releaseElementParser();
+
+            ElementParser* getPresenceParser();
+            ElementParser* getIQParser();
+            ElementParser* getMessageParser();
+
+            template<typename PARSER_TYPE>
+            ElementParser* createParser() {
+                return new PARSER_TYPE();
+            }
 
         private:
+            typedef ElementParser* (XMPPParser::*ElementParserCreator)();
             std::unique_ptr<XMLParser> xmlParser_;
             XMPPParserClient* client_;
             PayloadParserFactoryCollection* payloadParserFactories_;
@@ -53,5 +69,10 @@ namespace Swift {
             int level_;
             ElementParser* currentElementParser_;
             bool parseErrorOccurred_;
+
+            // Stanza parsers are reused for every stanza of their type
+            std::unique_ptr<PresenceParser> presenceParser_;
+            std::unique_ptr<IQParser> iqParser_;
+            std::unique_ptr<MessageParser> messageParser_;
     };
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -16,6 +16,25 @@
 
 namespace Swift {
 
+namespace {
+    /**
+     * Orders presences by priority, then by availability. Remaining ties are
+     * broken on the sender, so that the result does not depend on the order
+     * in which presences were received.
+     */
+    bool isHigherPriority(const Presence::ref& a, const Presence::ref& b) {
+        if (a->getPriority() != b->getPriority()) {
+            return a->getPriority() > b->getPriority();
+        }
+        int aAvailability = StatusShow::typeToAvailabilityOrdering(a->getShow());
+        int bAvailability = StatusShow::typeToAvailabilityOrdering(b->getShow());
+        if (aAvailability != bAvailability) {
+            return aAvailability > bAvailability;
+        }
+        return a->getFrom() < b->getFrom();
+    }
+}
+
 PresenceOracle::PresenceOracle(StanzaChannel* stanzaChannel, XMPPRoster* roster) : stanzaChannel_(stanzaChannel), xmppRoster_(roster) {
     stanzaChannel_->onPresenceReceived.connect(boost::bind(&PresenceOracle::handleIncomingPresence, this, _1));
     stanzaChannel_->onAvailableChanged.connect(boost::bind(&PresenceOracle::handleStanzaChannelAvailableChanged, this, _1));
@@ -47,20 +66,19 @@ void PresenceOracle::handleIncomingPresence(Presence::ref presence) {
             passedPresence->setFrom(bareJID);
             passedPresence->setStatus(presence->getStatus());
         }
-        PresenceMap jidMap = entries_[bareJID];
+        PresenceEntry& entry = entries_[bareJID];
         if (passedPresence->getFrom().isBare() && presence->getType() == Presence::Unavailable) {
             /* Have a bare-JID only presence of offline */
-            jidMap.clear();
+            clearPresences(entry);
         } else if (passedPresence->getType() == Presence::Available) {
             /* Don't have a bare-JID only offline presence once there are available presences */
-            jidMap.erase(bareJID);
+            removePresence(entry, bareJID);
         }
-        if (passedPresence->getType() == Presence::Unavailable && jidMap.size() > 1) {
-            jidMap.erase(passedPresence->getFrom());
+        if (passedPresence->getType() == Presence::Unavailable && entry.presences.size() > 1) {
+            removePresence(entry, passedPresence->getFrom());
         } else {
-            jidMap[passedPresence->getFrom()] = passedPresence;
+            setPresence(entry, passedPresence);
         }
-        entries_[bareJID] = jidMap;
         onPresenceChange(passedPresence);
     }
 }
@@ -71,9 +89,10 @@ void PresenceOracle::handleJIDRemoved(const JID& removedJID) {
     unavailablePresence->setType(Presence::Unavailable);
     unavailablePresence->setFrom(removedJID);
 
-    if (entries_.find(removedJID) != entries_.end()) {
-        entries_[removedJID].clear();
-        entries_[removedJID][removedJID] = unavailablePresence;
+    PresencesMap::iterator i = entries_.find(removedJID);
+    if (i != entries_.end()) {
+        clearPresences(i->second);
+        setPresence(i->second, unavailablePresence);
     }
 
     onPresenceChange(unavailablePresence);
@@ -84,9 +103,8 @@ Presence::ref PresenceOracle::getLastPresence(const JID& jid) const {
     if (i == entries_.end()) {
         return Presence::ref();
     }
-    PresenceMap presenceMap = i->second;
-    PresenceMap::const_iterator j = presenceMap.find(jid);
-    if (j != presenceMap.end()) {
+    PresenceMap::const_iterator j = i->second.presences.find(jid);
+    if (j != i->second.presences.end()) {
         return j->second;
     }
     else {
@@ -100,7 +118,7 @@ std::vector<Presence::ref> PresenceOracle::getAllPresence(const JID& bareJID) co
     if (i == entries_.end()) {
         return results;
     }
-    for (const auto& jidPresence : i->second) {
+    for (const auto& jidPresence : i->second.presences) {
         if (jidPresence.second) {
             results.push_back(jidPresence.second);
         }
@@ -198,17 +216,45 @@ Presence::ref PresenceOracle::getHighestPriorityPresence(const JID& bareJID) con
     if (i == entries_.end()) {
         return Presence::ref();
     }
-    Presence::ref highest;
-    for (const auto& jidPresence : i->second) {
-        Presence::ref current = jidPresence.second;
-        if (!highest
-                || current->getPriority() > highest->getPriority()
-                || (current->getPriority() == highest->getPriority()
-                        && StatusShow::typeToAvailabilityOrdering(current->getShow()) > StatusShow::typeToAvailabilityOrdering(highest->getShow()))) {
-            highest = current;
+    return i->second.highestPriorityPresence;
+}
+
+void PresenceOracle::setPresence(PresenceEntry& entry, Presence::ref presence) {
+    Presence::ref& current = entry.presences[presence->getFrom()];
+    bool replacesHighest = current && current == entry.highestPriorityPresence;
+    current = presence;
+    if (replacesHighest) {
+        updateHighestPriorityPresence(entry);
+    }
+    else if (!entry.highestPriorityPresence || isHigherPriority(presence, entry.highestPriorityPresence)) {
+        entry.highestPriorityPresence = presence;
+    }
+}
+
+void PresenceOracle::removePresence(PresenceEntry& entry, const JID& jid) {
+    PresenceMap::iterator i = entry.presences.find(jid);
+    if (i == entry.presences.end()) {
+        return;
+    }
+    bool removesHighest = i->second == entry.highestPriorityPresence;
+    entry.presences.erase(i);
+    if (removesHighest) {
+        updateHighestPriorityPresence(entry);
+    }
+}
+
+void PresenceOracle::clearPresences(PresenceEntry& entry) {
+    entry.presences.clear();
+    entry.highestPriorityPresence.reset();
+}
+
+void PresenceOracle::updateHighestPriorityPresence(PresenceEntry& entry) {
+    entry.highestPriorityPresence.reset();
+    for (const auto& jidPresence : entry.presences) {
+        if (!entry.highestPriorityPresence || isHigherPriority(jidPresence.second, entry.highestPriorityPresence)) {
+            entry.highestPriorityPresence = jidPresence.second;
         }
     }
-    return highest;
 }
 
 }
@@ -1,13 +1,13 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
-#include <map>
 #include <string>
+#include <unordered_map>
 
 #include <boost/signals2.hpp>
 
@@ -69,8 +69,24 @@ namespace Swift {
             void handleJIDRemoved(const JID& removedJID);
 
         private:
-            typedef std::map<JID, Presence::ref> PresenceMap;
-            typedef std::map<JID, PresenceMap> PresencesMap;
+            typedef std::unordered_map<JID, Presence::ref> PresenceMap;
+
+            /**
+             * The presences of all resources of a bare JID, together with the
+             * highest priority one, which is kept up to date on every change.
+             */
+            struct PresenceEntry {
+                PresenceMap presences;
+                Presence::ref highestPriorityPresence;
+            };
+            typedef std::unordered_map<JID, PresenceEntry> PresencesMap;
+
+            static void setPresence(PresenceEntry& entry, Presence::ref presence);
+            static void removePresence(PresenceEntry& entry, const JID& jid);
+            static void clearPresences(PresenceEntry& entry);
+            static void updateHighestPriorityPresence(PresenceEntry& entry);
+
+        private:
             PresencesMap entries_;
             StanzaChannel* stanzaChannel_;
             XMPPRoster* xmppRoster_;
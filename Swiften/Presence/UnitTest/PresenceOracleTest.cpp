@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -29,6 +29,8 @@ class PresenceOracleTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testHighestPresenceMultiple);
         CPPUNIT_TEST(testHighestPresenceGlobal);
         CPPUNIT_TEST(testHighestPresenceChangePriority);
+        CPPUNIT_TEST(testHighestPresenceEqualPriority);
+        CPPUNIT_TEST(testHighestPresenceJIDRemoved);
         CPPUNIT_TEST(testGetActivePresence);
         CPPUNIT_TEST_SUITE_END();
 
@@ -109,6 +111,34 @@ class PresenceOracleTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(fiveOn, oracle_->getHighestPriorityPresence(bareJID));
         }
 
+        void testHighestPresenceEqualPriority() {
+            JID bareJID("alice@wonderland.lit");
+            Presence::ref bertOn = makeOnline("bert", 5);
+            Presence::ref blahOn = makeOnline("blah", 5);
+            stanzaChannel_->onPresenceReceived(bertOn);
+            stanzaChannel_->onPresenceReceived(blahOn);
+            CPPUNIT_ASSERT_EQUAL(bertOn, oracle_->getHighestPriorityPresence(bareJID));
+            stanzaChannel_->onPresenceReceived(makeOffline("/bert"));
+            CPPUNIT_ASSERT_EQUAL(blahOn, oracle_->getHighestPriorityPresence(bareJID));
+            stanzaChannel_->onPresenceReceived(bertOn);
+            CPPUNIT_ASSERT_EQUAL(bertOn, oracle_->getHighestPriorityPresence(bareJID));
+        }
+
+        void testHighestPresenceJIDRemoved() {
+            JID bareJID("alice@wonderland.lit");
+            stanzaChannel_->onPresenceReceived(makeOnline("blah", 5));
+            stanzaChannel_->onPresenceReceived(makeOnline("bert", 10));
+
+            xmppRoster_->removeContact(bareJID);
+
+            Presence::ref highest = oracle_->getHighestPriorityPresence(bareJID);
+            CPPUNIT_ASSERT(highest);
+            CPPUNIT_ASSERT_EQUAL(Presence::Unavailable, highest->getType());
+            CPPUNIT_ASSERT_EQUAL(bareJID, highest->getFrom());
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), oracle_->getAllPresence(bareJID).size());
+            CPPUNIT_ASSERT_EQUAL(Presence::ref(), oracle_->getLastPresence(JID("alice@wonderland.lit/bert")));
+        }
+
         void testReceivePresence() {
             std::shared_ptr<Presence> sentPresence(createPresence(user1));
             stanzaChannel_->onPresenceReceived(sentPresence);
@@ -238,7 +268,7 @@ class PresenceOracleTest : public CppUnit::TestFixture {
         PresenceOracle* oracle_;
         SubscriptionManager* subscriptionManager_;
         DummyStanzaChannel* stanzaChannel_;
-        XMPPRoster* xmppRoster_;
+        XMPPRosterImpl* xmppRoster_;
         std::vector<Presence::ref> changes;
         std::vector<SubscriptionRequestInfo> subscriptionRequests;
         JID user1;
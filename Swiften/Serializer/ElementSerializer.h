@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,6 +7,9 @@
 #pragma once
 
 #include <memory>
+#include <typeindex>
+
+#include <boost/optional.hpp>
 
 #include <Swiften/Base/SafeByteArray.h>
 #include <Swiften/Elements/ToplevelElement.h>
@@ -18,5 +21,12 @@ namespace Swift {
 
             virtual SafeByteArray serialize(std::shared_ptr<ToplevelElement> element) const = 0;
             virtual bool canSerialize(std::shared_ptr<ToplevelElement> element) const = 0;
+
+            /**
+             * Returns the type of element this serializer handles, if it
+             * handles exactly one type. This is used to look up serializers
+             * without calling canSerialize() on each of them.
+             */
+            virtual boost::optional<std::type_index> getElementType() const;
     };
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <memory>
+#include <typeindex>
 
 #include <Swiften/Base/API.h>
 #include <Swiften/Serializer/ElementSerializer.h>
@@ -20,5 +21,9 @@ namespace Swift {
             virtual bool canSerialize(std::shared_ptr<ToplevelElement> element) const {
                 return !!std::dynamic_pointer_cast<T>(element);
             }
+
+            virtual boost::optional<std::type_index> getElementType() const {
+                return std::type_index(typeid(T));
+            }
     };
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,9 +7,12 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <typeindex>
 
 #include <Swiften/Base/API.h>
 #include <Swiften/Serializer/PayloadSerializer.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 namespace Swift {
     template<typename PAYLOAD_TYPE>
@@ -23,6 +26,30 @@ namespace Swift {
                 return !!std::dynamic_pointer_cast<PAYLOAD_TYPE>(element);
             }
 
+            virtual boost::optional<std::type_index> getPayloadType() const {
+                return std::type_index(typeid(PAYLOAD_TYPE));
+            }
+
+            virtual void writePayload(std::shared_ptr<Payload> element, XMLWriter& writer) const {
+                writePayloadGeneric(std::dynamic_pointer_cast<PAYLOAD_TYPE>(element), writer);
+            }
+
             virtual std::string serializePayload(std::shared_ptr<PAYLOAD_TYPE>) const = 0;
+
+            /**
+             * Serializers that write directly into an XMLWriter override this, and
+             * implement serializePayload() using serializeWithWriter().
+             */
+            virtual void writePayloadGeneric(std::shared_ptr<PAYLOAD_TYPE> payload, XMLWriter& writer) const {
+                writer.addRawText(serializePayload(payload));
+            }
+
+        protected:
+            std::string serializeWithWriter(std::shared_ptr<PAYLOAD_TYPE> payload) const {
+                std::string result;
+                XMLWriter writer(result);
+                writePayloadGeneric(payload, writer);
+                return result;
+            }
     };
 }
@@ -1,11 +1,13 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <typeindex>
+
 #include <Swiften/Base/API.h>
 #include <Swiften/Serializer/StanzaSerializer.h>
 
@@ -19,15 +21,19 @@ namespace Swift {
                 return dynamic_cast<STANZA_TYPE*>(element.get()) != nullptr;
             }
 
+            virtual boost::optional<std::type_index> getElementType() const {
+                return std::type_index(typeid(STANZA_TYPE));
+            }
+
             virtual void setStanzaSpecificAttributes(
                     std::shared_ptr<ToplevelElement> stanza,
-                    XMLElement& element) const {
+                    XMLWriter& element) const {
                 setStanzaSpecificAttributesGeneric(
                         std::dynamic_pointer_cast<STANZA_TYPE>(stanza), element);
             }
 
             virtual void setStanzaSpecificAttributesGeneric(
                     std::shared_ptr<STANZA_TYPE>,
-                    XMLElement&) const = 0;
+                    XMLWriter&) const = 0;
     };
 }
@@ -1,12 +1,12 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swiften/Serializer/MessageSerializer.h>
 
-#include <Swiften/Serializer/XML/XMLElement.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 namespace Swift {
 
@@ -16,7 +16,7 @@ MessageSerializer::MessageSerializer(PayloadSerializerCollection* payloadSeriali
 
 void MessageSerializer::setStanzaSpecificAttributesGeneric(
         std::shared_ptr<Message> message,
-        XMLElement& element) const {
+        XMLWriter& element) const {
     if (message->getType() == Message::Chat) {
         element.setAttribute("type", "chat");
     }
@@ -1,14 +1,24 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swiften/Serializer/PayloadSerializer.h>
 
+#include <Swiften/Serializer/XML/XMLWriter.h>
+
 namespace Swift {
 
 PayloadSerializer::~PayloadSerializer() {
 }
 
+boost::optional<std::type_index> PayloadSerializer::getPayloadType() const {
+    return boost::optional<std::type_index>();
+}
+
+void PayloadSerializer::writePayload(std::shared_ptr<Payload> payload, XMLWriter& writer) const {
+    writer.addRawText(serialize(payload));
+}
+
 }
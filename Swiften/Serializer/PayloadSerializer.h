@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,11 +8,15 @@
 
 #include <memory>
 #include <string>
+#include <typeindex>
+
+#include <boost/optional.hpp>
 
 #include <Swiften/Base/API.h>
 
 namespace Swift {
     class Payload;
+    class XMLWriter;
 
     class SWIFTEN_API PayloadSerializer {
         public:
@@ -20,5 +24,20 @@ namespace Swift {
 
             virtual bool canSerialize(std::shared_ptr<Payload>) const = 0;
             virtual std::string serialize(std::shared_ptr<Payload>) const = 0;
+
+            /**
+             * Returns the type of payload this serializer handles, if it
+             * handles exactly one type. This is used to look up serializers
+             * without calling canSerialize() on each of them.
+             */
+            virtual boost::optional<std::type_index> getPayloadType() const;
+
+            /**
+             * Serializes the payload directly into the output of \p writer.
+             *
+             * The default implementation adds the result of serialize(). Serializers
+             * can override this to avoid building the intermediate string.
+             */
+            virtual void writePayload(std::shared_ptr<Payload>, XMLWriter& writer) const;
     };
 }
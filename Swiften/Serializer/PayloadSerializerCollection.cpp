@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -22,17 +22,40 @@ PayloadSerializerCollection::~PayloadSerializerCollection() {
 
 void PayloadSerializerCollection::addSerializer(PayloadSerializer* serializer) {
     serializers_.push_back(serializer);
+    if (boost::optional<std::type_index> type = serializer->getPayloadType()) {
+        // Like the linear lookup, the first serializer registered for a type wins
+        typeIndex_.insert(std::make_pair(*type, serializer));
+    }
 }
 
 void PayloadSerializerCollection::removeSerializer(PayloadSerializer* serializer) {
     serializers_.erase(std::remove(serializers_.begin(), serializers_.end(), serializer), serializers_.end());
+    rebuildIndex();
 }
 
 PayloadSerializer* PayloadSerializerCollection::getPayloadSerializer(std::shared_ptr<Payload> payload) const {
+    if (!payload) {
+        return nullptr;
+    }
+    auto indexed = typeIndex_.find(std::type_index(typeid(*payload)));
+    if (indexed != typeIndex_.end()) {
+        return indexed->second;
+    }
+
+    // Fall back to serializers that handle base classes of the payload
     std::vector<PayloadSerializer*>::const_iterator i = std::find_if(
             serializers_.begin(), serializers_.end(),
             boost::bind(&PayloadSerializer::canSerialize, _1, payload));
     return (i != serializers_.end() ? *i : nullptr);
 }
 
+void PayloadSerializerCollection::rebuildIndex() {
+    typeIndex_.clear();
+    for (auto serializer : serializers_) {
+        if (boost::optional<std::type_index> type = serializer->getPayloadType()) {
+            typeIndex_.insert(std::make_pair(*type, serializer));
+        }
+    }
+}
+
 }
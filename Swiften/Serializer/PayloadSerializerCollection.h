@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,6 +7,8 @@
 #pragma once
 
 #include <memory>
+#include <typeindex>
+#include <unordered_map>
 #include <vector>
 
 #include <Swiften/Base/API.h>
@@ -24,7 +26,12 @@ namespace Swift {
             void removeSerializer(PayloadSerializer* factory);
             PayloadSerializer* getPayloadSerializer(std::shared_ptr<Payload>) const;
 
+        private:
+            void rebuildIndex();
+
         private:
             std::vector<PayloadSerializer*> serializers_;
+            // Serializers by the exact payload type they handle
+            std::unordered_map<std::type_index, PayloadSerializer*> typeIndex_;
     };
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -9,7 +9,7 @@
 #include <Swiften/Base/API.h>
 #include <Swiften/Elements/Body.h>
 #include <Swiften/Serializer/GenericPayloadSerializer.h>
-#include <Swiften/Serializer/XML/XMLTextNode.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 namespace Swift {
     class SWIFTEN_API BodySerializer : public GenericPayloadSerializer<Body> {
@@ -17,8 +17,11 @@ namespace Swift {
             BodySerializer() : GenericPayloadSerializer<Body>() {}
 
             virtual std::string serializePayload(std::shared_ptr<Body> body)  const {
-                XMLTextNode textNode(body->getText());
-                return "<body>" + textNode.serialize() + "</body>";
+                return serializeWithWriter(body);
+            }
+
+            virtual void writePayloadGeneric(std::shared_ptr<Body> body, XMLWriter& writer) const {
+                writer.addTextElement("body", body->getText());
             }
     };
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,7 +8,7 @@
 
 #include <memory>
 
-#include <Swiften/Serializer/XML/XMLElement.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 namespace Swift {
 
@@ -16,11 +16,15 @@ CapsInfoSerializer::CapsInfoSerializer() : GenericPayloadSerializer<CapsInfo>()
 }
 
 std::string CapsInfoSerializer::serializePayload(std::shared_ptr<CapsInfo> capsInfo)  const {
-    XMLElement capsElement("c", "http://jabber.org/protocol/caps");
-    capsElement.setAttribute("node", capsInfo->getNode());
-    capsElement.setAttribute("hash", capsInfo->getHash());
-    capsElement.setAttribute("ver", capsInfo->getVersion());
-    return capsElement.serialize();
+    return serializeWithWriter(capsInfo);
+}
+
+void CapsInfoSerializer::writePayloadGeneric(std::shared_ptr<CapsInfo> capsInfo, XMLWriter& writer) const {
+    writer.startElement("c", "http://jabber.org/protocol/caps");
+    writer.setAttribute("node", capsInfo->getNode());
+    writer.setAttribute("hash", capsInfo->getHash());
+    writer.setAttribute("ver", capsInfo->getVersion());
+    writer.endElement();
 }
 
 }
@@ -1,27 +1,31 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swiften/Serializer/PayloadSerializers/ChatStateSerializer.h>
 
+#include <Swiften/Serializer/XML/XMLWriter.h>
+
 namespace Swift {
 
 ChatStateSerializer::ChatStateSerializer() : GenericPayloadSerializer<ChatState>() {
 }
 
 std::string ChatStateSerializer::serializePayload(std::shared_ptr<ChatState> chatState)  const {
-    std::string result("<");
+    return serializeWithWriter(chatState);
+}
+
+void ChatStateSerializer::writePayloadGeneric(std::shared_ptr<ChatState> chatState, XMLWriter& writer) const {
     switch (chatState->getChatState()) {
-        case ChatState::Active: result += "active"; break;
-        case ChatState::Composing: result += "composing"; break;
-        case ChatState::Paused: result += "paused"; break;
-        case ChatState::Inactive: result += "inactive"; break;
-        case ChatState::Gone: result += "gone"; break;
+        case ChatState::Active: writer.startElement("active", "http://jabber.org/protocol/chatstates"); break;
+        case ChatState::Composing: writer.startElement("composing", "http://jabber.org/protocol/chatstates"); break;
+        case ChatState::Paused: writer.startElement("paused", "http://jabber.org/protocol/chatstates"); break;
+        case ChatState::Inactive: writer.startElement("inactive", "http://jabber.org/protocol/chatstates"); break;
+        case ChatState::Gone: writer.startElement("gone", "http://jabber.org/protocol/chatstates"); break;
     }
-    result += " xmlns=\"http://jabber.org/protocol/chatstates\"/>";
-    return result;
+    writer.endElement();
 }
 
 }
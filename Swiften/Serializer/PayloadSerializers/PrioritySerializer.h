@@ -1,16 +1,17 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
-#include <boost/lexical_cast.hpp>
+#include <string>
 
 #include <Swiften/Base/API.h>
 #include <Swiften/Elements/Priority.h>
 #include <Swiften/Serializer/GenericPayloadSerializer.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 namespace Swift {
     class SWIFTEN_API PrioritySerializer : public GenericPayloadSerializer<Priority> {
@@ -18,7 +19,11 @@ namespace Swift {
             PrioritySerializer() : GenericPayloadSerializer<Priority>() {}
 
             virtual std::string serializePayload(std::shared_ptr<Priority> priority)  const {
-                return "<priority>" + boost::lexical_cast<std::string>(priority->getPriority()) + "</priority>";
+                return serializeWithWriter(priority);
+            }
+
+            virtual void writePayloadGeneric(std::shared_ptr<Priority> priority, XMLWriter& writer) const {
+                writer.addTextElement("priority", std::to_string(priority->getPriority()));
             }
     };
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2016 Isode Limited.
+ * Copyright (c) 2013-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -9,8 +9,7 @@
 #include <memory>
 
 #include <Swiften/Serializer/PayloadSerializerCollection.h>
-#include <Swiften/Serializer/XML/XMLElement.h>
-#include <Swiften/Serializer/XML/XMLRawTextNode.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 using namespace Swift;
 
@@ -21,23 +20,25 @@ PubSubEventItemSerializer::~PubSubEventItemSerializer() {
 }
 
 std::string PubSubEventItemSerializer::serializePayload(std::shared_ptr<PubSubEventItem> payload) const {
+    return serializeWithWriter(payload);
+}
+
+void PubSubEventItemSerializer::writePayloadGeneric(std::shared_ptr<PubSubEventItem> payload, XMLWriter& writer) const {
     if (!payload) {
-        return "";
+        return;
     }
-    XMLElement element("item", "http://jabber.org/protocol/pubsub#event");
+    writer.startElement("item", "http://jabber.org/protocol/pubsub#event");
     if (payload->getNode()) {
-        element.setAttribute("node", *payload->getNode());
+        writer.setAttribute("node", *payload->getNode());
     }
     if (payload->getPublisher()) {
-        element.setAttribute("publisher", *payload->getPublisher());
-    }
-    for (const auto& item : payload->getData()) {
-        element.addNode(std::make_shared<XMLRawTextNode>(serializers->getPayloadSerializer(item)->serialize(item)));
+        writer.setAttribute("publisher", *payload->getPublisher());
     }
     if (payload->getID()) {
-        element.setAttribute("id", *payload->getID());
+        writer.setAttribute("id", *payload->getID());
     }
-    return element.serialize();
+    for (const auto& item : payload->getData()) {
+        serializers->getPayloadSerializer(item)->writePayload(item, writer);
+    }
+    writer.endElement();
 }
-
-
@@ -21,6 +21,7 @@ namespace Swift {
             virtual ~PubSubEventItemSerializer() override;
 
             virtual std::string serializePayload(std::shared_ptr<PubSubEventItem>) const override;
+            virtual void writePayloadGeneric(std::shared_ptr<PubSubEventItem>, XMLWriter&) const override;
 
         private:
             PayloadSerializerCollection* serializers;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2016 Isode Limited.
+ * Copyright (c) 2013-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -11,8 +11,7 @@
 #include <Swiften/Serializer/PayloadSerializerCollection.h>
 #include <Swiften/Serializer/PayloadSerializers/PubSubEventItemSerializer.h>
 #include <Swiften/Serializer/PayloadSerializers/PubSubEventRetractSerializer.h>
-#include <Swiften/Serializer/XML/XMLElement.h>
-#include <Swiften/Serializer/XML/XMLRawTextNode.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 using namespace Swift;
 
@@ -23,18 +22,22 @@ PubSubEventItemsSerializer::~PubSubEventItemsSerializer() {
 }
 
 std::string PubSubEventItemsSerializer::serializePayload(std::shared_ptr<PubSubEventItems> payload) const {
+    return serializeWithWriter(payload);
+}
+
+void PubSubEventItemsSerializer::writePayloadGeneric(std::shared_ptr<PubSubEventItems> payload, XMLWriter& writer) const {
     if (!payload) {
-        return "";
+        return;
     }
-    XMLElement element("items", "http://jabber.org/protocol/pubsub#event");
-    element.setAttribute("node", payload->getNode());
+    writer.startElement("items", "http://jabber.org/protocol/pubsub#event");
+    writer.setAttribute("node", payload->getNode());
+    PubSubEventItemSerializer itemSerializer(serializers);
     for (const auto& item : payload->getItems()) {
-        element.addNode(std::make_shared<XMLRawTextNode>(PubSubEventItemSerializer(serializers).serialize(item)));
+        itemSerializer.writePayload(item, writer);
     }
+    PubSubEventRetractSerializer retractSerializer(serializers);
     for (const auto& item : payload->getRetracts()) {
-        element.addNode(std::make_shared<XMLRawTextNode>(PubSubEventRetractSerializer(serializers).serialize(item)));
+        retractSerializer.writePayload(item, writer);
     }
-    return element.serialize();
+    writer.endElement();
 }
-
-
@@ -21,6 +21,7 @@ namespace Swift {
             virtual ~PubSubEventItemsSerializer() override;
 
             virtual std::string serializePayload(std::shared_ptr<PubSubEventItems>) const override;
+            virtual void writePayloadGeneric(std::shared_ptr<PubSubEventItems>, XMLWriter&) const override;
 
         private:
             PayloadSerializerCollection* serializers;
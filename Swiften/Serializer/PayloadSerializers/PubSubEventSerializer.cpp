@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2016 Isode Limited.
+ * Copyright (c) 2013-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -14,8 +14,7 @@
 #include <Swiften/Serializer/PayloadSerializers/PubSubEventItemsSerializer.h>
 #include <Swiften/Serializer/PayloadSerializers/PubSubEventPurgeSerializer.h>
 #include <Swiften/Serializer/PayloadSerializers/PubSubEventSubscriptionSerializer.h>
-#include <Swiften/Serializer/XML/XMLElement.h>
-#include <Swiften/Serializer/XML/XMLRawTextNode.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 using namespace Swift;
 
@@ -32,17 +31,19 @@ PubSubEventSerializer::~PubSubEventSerializer() {
 }
 
 std::string PubSubEventSerializer::serializePayload(std::shared_ptr<PubSubEvent> payload) const {
+    return serializeWithWriter(payload);
+}
+
+void PubSubEventSerializer::writePayloadGeneric(std::shared_ptr<PubSubEvent> payload, XMLWriter& writer) const {
     if (!payload) {
-        return "";
+        return;
     }
-    XMLElement element("event", "http://jabber.org/protocol/pubsub#event");
+    writer.startElement("event", "http://jabber.org/protocol/pubsub#event");
     std::shared_ptr<PubSubEventPayload> p = payload->getPayload();
     for (const auto& serializer : pubsubSerializers) {
         if (serializer->canSerialize(p)) {
-            element.addNode(std::make_shared<XMLRawTextNode>(serializer->serialize(p)));
+            serializer->writePayload(p, writer);
         }
     }
-    return element.serialize();
+    writer.endElement();
 }
-
-
@@ -22,6 +22,7 @@ namespace Swift {
             virtual ~PubSubEventSerializer() override;
 
             virtual std::string serializePayload(std::shared_ptr<PubSubEvent>) const override;
+            virtual void writePayloadGeneric(std::shared_ptr<PubSubEvent>, XMLWriter&) const override;
 
         private:
             std::vector< std::shared_ptr<PayloadSerializer> > pubsubSerializers;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2016 Isode Limited.
+ * Copyright (c) 2013-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -9,8 +9,7 @@
 #include <memory>
 
 #include <Swiften/Serializer/PayloadSerializerCollection.h>
-#include <Swiften/Serializer/XML/XMLElement.h>
-#include <Swiften/Serializer/XML/XMLRawTextNode.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 using namespace Swift;
 
@@ -21,17 +20,19 @@ PubSubItemSerializer::~PubSubItemSerializer() {
 }
 
 std::string PubSubItemSerializer::serializePayload(std::shared_ptr<PubSubItem> payload) const {
+    return serializeWithWriter(payload);
+}
+
+void PubSubItemSerializer::writePayloadGeneric(std::shared_ptr<PubSubItem> payload, XMLWriter& writer) const {
     if (!payload) {
-        return "";
-    }
-    XMLElement element("item", "http://jabber.org/protocol/pubsub");
-    for (const auto& item : payload->getData()) {
-        element.addNode(std::make_shared<XMLRawTextNode>(serializers->getPayloadSerializer(item)->serialize(item)));
+        return;
     }
+    writer.startElement("item", "http://jabber.org/protocol/pubsub");
     if (!payload->getID().empty()) {
-        element.setAttribute("id", payload->getID());
+        writer.setAttribute("id", payload->getID());
     }
-    return element.serialize();
+    for (const auto& item : payload->getData()) {
+        serializers->getPayloadSerializer(item)->writePayload(item, writer);
+    }
+    writer.endElement();
 }
-
-
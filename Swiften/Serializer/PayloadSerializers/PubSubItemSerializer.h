@@ -21,6 +21,7 @@ namespace Swift {
             virtual ~PubSubItemSerializer() override;
 
             virtual std::string serializePayload(std::shared_ptr<PubSubItem>) const override;
+            virtual void writePayloadGeneric(std::shared_ptr<PubSubItem>, XMLWriter&) const override;
 
         private:
             PayloadSerializerCollection* serializers;
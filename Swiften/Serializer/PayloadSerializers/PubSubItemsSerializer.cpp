@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2016 Isode Limited.
+ * Copyright (c) 2013-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -13,8 +13,7 @@
 #include <Swiften/Base/Log.h>
 #include <Swiften/Serializer/PayloadSerializerCollection.h>
 #include <Swiften/Serializer/PayloadSerializers/PubSubItemSerializer.h>
-#include <Swiften/Serializer/XML/XMLElement.h>
-#include <Swiften/Serializer/XML/XMLRawTextNode.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 using namespace Swift;
 
@@ -25,24 +24,27 @@ PubSubItemsSerializer::~PubSubItemsSerializer() {
 }
 
 std::string PubSubItemsSerializer::serializePayload(std::shared_ptr<PubSubItems> payload) const {
+    return serializeWithWriter(payload);
+}
+
+void PubSubItemsSerializer::writePayloadGeneric(std::shared_ptr<PubSubItems> payload, XMLWriter& writer) const {
     if (!payload) {
-        return "";
+        return;
     }
-    XMLElement element("items", "http://jabber.org/protocol/pubsub");
+    writer.startElement("items", "http://jabber.org/protocol/pubsub");
     if (payload->getNode().empty()) {
         SWIFT_LOG(warning) << "Serializing PubSubItems with empty node attribute";
     }
-    element.setAttribute("node", payload->getNode());
-    for (const auto& item : payload->getItems()) {
-        element.addNode(std::make_shared<XMLRawTextNode>(PubSubItemSerializer(serializers).serialize(item)));
-    }
+    writer.setAttribute("node", payload->getNode());
     if (payload->getMaximumItems()) {
-        element.setAttribute("max_items", boost::lexical_cast<std::string>(*payload->getMaximumItems()));
+        writer.setAttribute("max_items", boost::lexical_cast<std::string>(*payload->getMaximumItems()));
     }
     if (payload->getSubscriptionID()) {
-        element.setAttribute("subid", *payload->getSubscriptionID());
+        writer.setAttribute("subid", *payload->getSubscriptionID());
     }
-    return element.serialize();
+    PubSubItemSerializer itemSerializer(serializers);
+    for (const auto& item : payload->getItems()) {
+        itemSerializer.writePayload(item, writer);
+    }
+    writer.endElement();
 }
-
-
@@ -21,6 +21,7 @@ namespace Swift {
             virtual ~PubSubItemsSerializer() override;
 
             virtual std::string serializePayload(std::shared_ptr<PubSubItems>) const override;
+            virtual void writePayloadGeneric(std::shared_ptr<PubSubItems>, XMLWriter&) const override;
 
         private:
             PayloadSerializerCollection* serializers;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2016 Isode Limited.
+ * Copyright (c) 2013-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -10,8 +10,7 @@
 
 #include <Swiften/Serializer/PayloadSerializerCollection.h>
 #include <Swiften/Serializer/PayloadSerializers/PubSubItemSerializer.h>
-#include <Swiften/Serializer/XML/XMLElement.h>
-#include <Swiften/Serializer/XML/XMLRawTextNode.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 using namespace Swift;
 
@@ -22,15 +21,18 @@ PubSubPublishSerializer::~PubSubPublishSerializer() {
 }
 
 std::string PubSubPublishSerializer::serializePayload(std::shared_ptr<PubSubPublish> payload) const {
+    return serializeWithWriter(payload);
+}
+
+void PubSubPublishSerializer::writePayloadGeneric(std::shared_ptr<PubSubPublish> payload, XMLWriter& writer) const {
     if (!payload) {
-        return "";
+        return;
     }
-    XMLElement element("publish", "http://jabber.org/protocol/pubsub");
-    element.setAttribute("node", payload->getNode());
+    writer.startElement("publish", "http://jabber.org/protocol/pubsub");
+    writer.setAttribute("node", payload->getNode());
+    PubSubItemSerializer itemSerializer(serializers);
     for (const auto& item : payload->getItems()) {
-        element.addNode(std::make_shared<XMLRawTextNode>(PubSubItemSerializer(serializers).serialize(item)));
+        itemSerializer.writePayload(item, writer);
     }
-    return element.serialize();
+    writer.endElement();
 }
-
-
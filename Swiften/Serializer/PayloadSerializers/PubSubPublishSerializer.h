@@ -21,6 +21,7 @@ namespace Swift {
             virtual ~PubSubPublishSerializer() override;
 
             virtual std::string serializePayload(std::shared_ptr<PubSubPublish>) const override;
+            virtual void writePayloadGeneric(std::shared_ptr<PubSubPublish>, XMLWriter&) const override;
 
         private:
             PayloadSerializerCollection* serializers;
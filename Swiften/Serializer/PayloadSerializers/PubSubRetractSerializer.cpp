@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2016 Isode Limited.
+ * Copyright (c) 2013-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -10,8 +10,7 @@
 
 #include <Swiften/Serializer/PayloadSerializerCollection.h>
 #include <Swiften/Serializer/PayloadSerializers/PubSubItemSerializer.h>
-#include <Swiften/Serializer/XML/XMLElement.h>
-#include <Swiften/Serializer/XML/XMLRawTextNode.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 using namespace Swift;
 
@@ -22,18 +21,21 @@ PubSubRetractSerializer::~PubSubRetractSerializer() {
 }
 
 std::string PubSubRetractSerializer::serializePayload(std::shared_ptr<PubSubRetract> payload) const {
+    return serializeWithWriter(payload);
+}
+
+void PubSubRetractSerializer::writePayloadGeneric(std::shared_ptr<PubSubRetract> payload, XMLWriter& writer) const {
     if (!payload) {
-        return "";
-    }
-    XMLElement element("retract", "http://jabber.org/protocol/pubsub");
-    element.setAttribute("node", payload->getNode());
-    for (const auto& item : payload->getItems()) {
-        element.addNode(std::make_shared<XMLRawTextNode>(PubSubItemSerializer(serializers).serialize(item)));
+        return;
     }
+    writer.startElement("retract", "http://jabber.org/protocol/pubsub");
+    writer.setAttribute("node", payload->getNode());
     if (payload->isNotify().is_initialized()) {
-        element.setAttribute("notify", payload->isNotify().get() ? "true" : "false");
+        writer.setAttribute("notify", payload->isNotify().get() ? "true" : "false");
     }
-    return element.serialize();
+    PubSubItemSerializer itemSerializer(serializers);
+    for (const auto& item : payload->getItems()) {
+        itemSerializer.writePayload(item, writer);
+    }
+    writer.endElement();
 }
-
-
@@ -21,6 +21,7 @@ namespace Swift {
             virtual ~PubSubRetractSerializer() override;
 
             virtual std::string serializePayload(std::shared_ptr<PubSubRetract>) const override;
+            virtual void writePayloadGeneric(std::shared_ptr<PubSubRetract>, XMLWriter&) const override;
 
         private:
             PayloadSerializerCollection* serializers;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2016 Isode Limited.
+ * Copyright (c) 2013-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -21,8 +21,7 @@
 #include <Swiften/Serializer/PayloadSerializers/PubSubSubscriptionSerializer.h>
 #include <Swiften/Serializer/PayloadSerializers/PubSubSubscriptionsSerializer.h>
 #include <Swiften/Serializer/PayloadSerializers/PubSubUnsubscribeSerializer.h>
-#include <Swiften/Serializer/XML/XMLElement.h>
-#include <Swiften/Serializer/XML/XMLRawTextNode.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 using namespace Swift;
 
@@ -44,23 +43,25 @@ PubSubSerializer::~PubSubSerializer() {
 }
 
 std::string PubSubSerializer::serializePayload(std::shared_ptr<PubSub> payload) const {
+    return serializeWithWriter(payload);
+}
+
+void PubSubSerializer::writePayloadGeneric(std::shared_ptr<PubSub> payload, XMLWriter& writer) const {
     if (!payload) {
-        return "";
+        return;
     }
-    XMLElement element("pubsub", "http://jabber.org/protocol/pubsub");
+    writer.startElement("pubsub", "http://jabber.org/protocol/pubsub");
     std::shared_ptr<PubSubPayload> p = payload->getPayload();
     for (const auto& serializer : pubsubSerializers) {
         if (serializer->canSerialize(p)) {
-            element.addNode(std::make_shared<XMLRawTextNode>(serializer->serialize(p)));
+            serializer->writePayload(p, writer);
             if (std::shared_ptr<PubSubCreate> create = std::dynamic_pointer_cast<PubSubCreate>(p)) {
-                element.addNode(std::make_shared<XMLRawTextNode>(std::make_shared<PubSubConfigureSerializer>(serializers)->serialize(create->getConfigure())));
+                PubSubConfigureSerializer(serializers).writePayload(create->getConfigure(), writer);
             }
             if (std::shared_ptr<PubSubSubscribe> subscribe = std::dynamic_pointer_cast<PubSubSubscribe>(p)) {
-                element.addNode(std::make_shared<XMLRawTextNode>(std::make_shared<PubSubConfigureSerializer>(serializers)->serialize(subscribe->getOptions())));
+                PubSubConfigureSerializer(serializers).writePayload(subscribe->getOptions(), writer);
             }
         }
     }
-    return element.serialize();
+    writer.endElement();
 }
-
-
@@ -21,6 +21,7 @@ namespace Swift {
             virtual ~PubSubSerializer() override;
 
             virtual std::string serializePayload(std::shared_ptr<PubSub>) const override;
+            virtual void writePayloadGeneric(std::shared_ptr<PubSub>, XMLWriter&) const override;
 
         private:
             std::vector< std::shared_ptr<PayloadSerializer> > pubsubSerializers;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -11,8 +11,7 @@
 #include <Swiften/Base/API.h>
 #include <Swiften/Elements/Status.h>
 #include <Swiften/Serializer/GenericPayloadSerializer.h>
-#include <Swiften/Serializer/XML/XMLElement.h>
-#include <Swiften/Serializer/XML/XMLTextNode.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 namespace Swift {
     class SWIFTEN_API StatusSerializer : public GenericPayloadSerializer<Status> {
@@ -20,9 +19,11 @@ namespace Swift {
             StatusSerializer() : GenericPayloadSerializer<Status>() {}
 
             virtual std::string serializePayload(std::shared_ptr<Status> status)  const {
-                XMLElement element("status");
-                element.addNode(std::make_shared<XMLTextNode>(status->getText()));
-                return element.serialize();
+                return serializeWithWriter(status);
+            }
+
+            virtual void writePayloadGeneric(std::shared_ptr<Status> status, XMLWriter& writer) const {
+                writer.addTextElement("status", status->getText());
             }
     };
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -9,6 +9,7 @@
 #include <Swiften/Base/API.h>
 #include <Swiften/Elements/StatusShow.h>
 #include <Swiften/Serializer/GenericPayloadSerializer.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 namespace Swift {
     class SWIFTEN_API StatusShowSerializer : public GenericPayloadSerializer<StatusShow> {
@@ -16,21 +17,17 @@ namespace Swift {
             StatusShowSerializer() : GenericPayloadSerializer<StatusShow>() {}
 
             virtual std::string serializePayload(std::shared_ptr<StatusShow> statusShow)  const {
-                if (statusShow->getType () == StatusShow::Online || statusShow->getType() == StatusShow::None) {
-                    return "";
-                }
-                else {
-                    std::string result("<show>");
-                    switch (statusShow->getType()) {
-                        case StatusShow::Away: result += "away"; break;
-                        case StatusShow::XA: result += "xa"; break;
-                        case StatusShow::FFC: result += "chat"; break;
-                        case StatusShow::DND: result += "dnd"; break;
-                        case StatusShow::Online: assert(false); break;
-                        case StatusShow::None: assert(false); break;
-                    }
-                    result += "</show>";
-                    return result;
+                return serializeWithWriter(statusShow);
+            }
+
+            virtual void writePayloadGeneric(std::shared_ptr<StatusShow> statusShow, XMLWriter& writer) const {
+                switch (statusShow->getType()) {
+                    case StatusShow::Away: writer.addTextElement("show", "away"); break;
+                    case StatusShow::XA: writer.addTextElement("show", "xa"); break;
+                    case StatusShow::FFC: writer.addTextElement("show", "chat"); break;
+                    case StatusShow::DND: writer.addTextElement("show", "dnd"); break;
+                    case StatusShow::Online: break;
+                    case StatusShow::None: break;
                 }
             }
     };
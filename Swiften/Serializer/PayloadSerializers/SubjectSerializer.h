@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -9,7 +9,7 @@
 #include <Swiften/Base/API.h>
 #include <Swiften/Elements/Subject.h>
 #include <Swiften/Serializer/GenericPayloadSerializer.h>
-#include <Swiften/Serializer/XML/XMLTextNode.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 namespace Swift {
     class SWIFTEN_API SubjectSerializer : public GenericPayloadSerializer<Subject> {
@@ -17,8 +17,11 @@ namespace Swift {
             SubjectSerializer() : GenericPayloadSerializer<Subject>() {}
 
             virtual std::string serializePayload(std::shared_ptr<Subject> subject)  const {
-                XMLTextNode textNode(subject->getText());
-                return "<subject>" + textNode.serialize() + "</subject>";
+                return serializeWithWriter(subject);
+            }
+
+            virtual void writePayloadGeneric(std::shared_ptr<Subject> subject, XMLWriter& writer) const {
+                writer.addTextElement("subject", subject->getText());
             }
     };
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -9,7 +9,7 @@
 #include <memory>
 
 #include <Swiften/Base/Log.h>
-#include <Swiften/Serializer/XML/XMLElement.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 namespace Swift {
 
@@ -20,7 +20,7 @@ PresenceSerializer::PresenceSerializer(PayloadSerializerCollection* payloadSeria
 
 void PresenceSerializer::setStanzaSpecificAttributesGeneric(
         std::shared_ptr<Presence> presence,
-        XMLElement& element) const {
+        XMLWriter& element) const {
     switch (presence->getType()) {
         case Presence::Unavailable: element.setAttribute("type","unavailable"); break;
         case Presence::Probe: element.setAttribute("type","probe"); break;
@@ -1,12 +1,11 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swiften/Serializer/StanzaSerializer.h>
 
-#include <sstream>
 #include <typeinfo>
 
 #include <Swiften/Base/String.h>
@@ -14,8 +13,7 @@
 #include <Swiften/Elements/Stanza.h>
 #include <Swiften/Serializer/PayloadSerializer.h>
 #include <Swiften/Serializer/PayloadSerializerCollection.h>
-#include <Swiften/Serializer/XML/XMLElement.h>
-#include <Swiften/Serializer/XML/XMLRawTextNode.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 namespace Swift {
 
@@ -34,34 +32,39 @@ SafeByteArray StanzaSerializer::serialize(std::shared_ptr<ToplevelElement> eleme
 SafeByteArray StanzaSerializer::serialize(std::shared_ptr<ToplevelElement> element, const std::string& xmlns) const {
     std::shared_ptr<Stanza> stanza(std::dynamic_pointer_cast<Stanza>(element));
 
-    XMLElement stanzaElement(tag_, explicitDefaultNS_ ? explicitDefaultNS_.get() : xmlns);
-    if (stanza->getFrom().isValid()) {
-        stanzaElement.setAttribute("from", stanza->getFrom());
-    }
-    if (stanza->getTo().isValid()) {
-        stanzaElement.setAttribute("to", stanza->getTo());
-    }
-    if (!stanza->getID().empty()) {
-        stanzaElement.setAttribute("id", stanza->getID());
-    }
-    setStanzaSpecificAttributes(stanza, stanzaElement);
-
-    std::string serializedPayloads;
+    std::string payloads;
+    XMLWriter payloadWriter(payloads);
     for (const auto& payload : stanza->getPayloads()) {
         PayloadSerializer* serializer = payloadSerializers_->getPayloadSerializer(payload);
         if (serializer) {
-            serializedPayloads += serializer->serialize(payload);
+            serializer->writePayload(payload, payloadWriter);
         }
         else {
             SWIFT_LOG(warning) << "Could not find serializer for " << typeid(*(payload.get())).name() << std::endl;
         }
     }
-    serializedPayloads = String::sanitizeXMPPString(serializedPayloads);
-    if (!serializedPayloads.empty()) {
-        stanzaElement.addNode(std::make_shared<XMLRawTextNode>(serializedPayloads));
+    String::sanitizeXMPPStringInPlace(payloads);
+
+    std::string result;
+    result.reserve(payloads.size() + 256);
+    XMLWriter writer(result);
+    writer.startElement(tag_, explicitDefaultNS_ ? explicitDefaultNS_.get() : xmlns);
+    if (stanza->getFrom().isValid()) {
+        writer.setAttribute("from", stanza->getFrom());
+    }
+    if (stanza->getTo().isValid()) {
+        writer.setAttribute("to", stanza->getTo());
+    }
+    if (!stanza->getID().empty()) {
+        writer.setAttribute("id", stanza->getID());
+    }
+    setStanzaSpecificAttributes(stanza, writer);
+    if (!payloads.empty()) {
+        writer.addRawText(payloads);
     }
+    writer.endElement();
 
-    return createSafeByteArray(stanzaElement.serialize());
+    return createSafeByteArray(result);
 }
 
 }
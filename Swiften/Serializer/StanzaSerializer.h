@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2016 Isode Limited.
+ * Copyright (c) 2013-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -16,7 +16,7 @@
 
 namespace Swift {
     class PayloadSerializerCollection;
-    class XMLElement;
+    class XMLWriter;
 
     class SWIFTEN_API StanzaSerializer : public ElementSerializer {
         public:
@@ -24,7 +24,7 @@ namespace Swift {
 
             virtual SafeByteArray serialize(std::shared_ptr<ToplevelElement> element) const;
             virtual SafeByteArray serialize(std::shared_ptr<ToplevelElement> element, const std::string& xmlns) const;
-            virtual void setStanzaSpecificAttributes(std::shared_ptr<ToplevelElement>, XMLElement&) const = 0;
+            virtual void setStanzaSpecificAttributes(std::shared_ptr<ToplevelElement>, XMLWriter&) const = 0;
 
         private:
             std::string tag_;
@@ -1,15 +1,21 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
+#include <QA/Checker/IO.h>
+
 #include <cppunit/extensions/HelperMacros.h>
 #include <cppunit/extensions/TestFactoryRegistry.h>
 
 #include <Swiften/Elements/AuthChallenge.h>
+#include <Swiften/Elements/Body.h>
+#include <Swiften/Elements/CompressRequest.h>
+#include <Swiften/Elements/Message.h>
 #include <Swiften/Elements/ProtocolHeader.h>
 #include <Swiften/Serializer/PayloadSerializerCollection.h>
+#include <Swiften/Serializer/PayloadSerializers/BodySerializer.h>
 #include <Swiften/Serializer/XMPPSerializer.h>
 
 using namespace Swift;
@@ -19,6 +25,9 @@ class XMPPSerializerTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testSerializeHeader_Client);
         CPPUNIT_TEST(testSerializeHeader_Component);
         CPPUNIT_TEST(testSerializeHeader_Server);
+        CPPUNIT_TEST(testSerializeElement_Stanza);
+        CPPUNIT_TEST(testSerializeElement_RemovedPayloadSerializer);
+        CPPUNIT_TEST(testSerializeElement_SerializerWithoutElementType);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -63,6 +72,36 @@ class XMPPSerializerTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(std::string("<?xml version=\"1.0\"?><stream:stream xmlns=\"jabber:server\" xmlns:stream=\"http://etherx.jabber.org/streams\" from=\"bla@foo.com\" to=\"foo.com\" id=\"myid\" version=\"0.99\">"), testling->serializeHeader(protocolHeader));
         }
 
+        void testSerializeElement_Stanza() {
+            BodySerializer bodySerializer;
+            payloadSerializerCollection->addSerializer(&bodySerializer);
+            std::shared_ptr<XMPPSerializer> testling(createSerializer(ClientStreamType));
+            std::shared_ptr<Message> message = std::make_shared<Message>();
+            message->setType(Message::Normal);
+            message->setTo(JID("foo@bar.com"));
+            message->addPayload(std::make_shared<Body>("Hello"));
+
+            CPPUNIT_ASSERT_EQUAL(createSafeByteArray("<message to=\"foo@bar.com\"><body>Hello</body></message>"), testling->serializeElement(message));
+        }
+
+        void testSerializeElement_RemovedPayloadSerializer() {
+            BodySerializer bodySerializer;
+            payloadSerializerCollection->addSerializer(&bodySerializer);
+            payloadSerializerCollection->removeSerializer(&bodySerializer);
+            std::shared_ptr<XMPPSerializer> testling(createSerializer(ClientStreamType));
+            std::shared_ptr<Message> message = std::make_shared<Message>();
+            message->setType(Message::Normal);
+            message->addPayload(std::make_shared<Body>("Hello"));
+
+            CPPUNIT_ASSERT_EQUAL(createSafeByteArray("<message/>"), testling->serializeElement(message));
+        }
+
+        void testSerializeElement_SerializerWithoutElementType() {
+            std::shared_ptr<XMPPSerializer> testling(createSerializer(ClientStreamType));
+
+            CPPUNIT_ASSERT_EQUAL(createSafeByteArray("<compress xmlns='http://jabber.org/protocol/compress'><method>zlib</method></compress>"), testling->serializeElement(std::make_shared<CompressRequest>("zlib")));
+        }
+
     private:
         XMPPSerializer* createSerializer(StreamType type) {
             return new XMPPSerializer(payloadSerializerCollection, type, false);
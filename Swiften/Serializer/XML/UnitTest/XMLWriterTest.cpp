@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <string>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Serializer/XML/XMLWriter.h>
+
+using namespace Swift;
+
+class XMLWriterTest : public CppUnit::TestFixture
+{
+        CPPUNIT_TEST_SUITE(XMLWriterTest);
+        CPPUNIT_TEST(testWrite);
+        CPPUNIT_TEST(testWrite_NoChildren);
+        CPPUNIT_TEST(testWrite_SpecialAttributeCharacters);
+        CPPUNIT_TEST(testWrite_AttributeSetTwice);
+        CPPUNIT_TEST(testWrite_RawText);
+        CPPUNIT_TEST(testWrite_AppendsToOutput);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void testWrite() {
+            std::string result;
+            XMLWriter testling(result);
+            testling.startElement("foo", "http://example.com");
+            testling.setAttribute("myatt", "myval");
+            testling.addTextElement("bar", "Blo");
+            testling.addTextElement("baz", "Bli&</stream>");
+            testling.endElement();
+
+            std::string expectedResult =
+                "<foo myatt=\"myval\" xmlns=\"http://example.com\">"
+                    "<bar>Blo</bar>"
+                    "<baz>Bli&amp;&lt;/stream&gt;</baz>"
+                "</foo>";
+            CPPUNIT_ASSERT_EQUAL(expectedResult, result);
+        }
+
+        void testWrite_NoChildren() {
+            std::string result;
+            XMLWriter testling(result);
+            testling.startElement("foo", "http://example.com");
+            testling.endElement();
+
+            CPPUNIT_ASSERT_EQUAL(std::string("<foo xmlns=\"http://example.com\"/>"), result);
+        }
+
+        void testWrite_SpecialAttributeCharacters() {
+            std::string result;
+            XMLWriter testling(result);
+            testling.startElement("foo");
+            testling.setAttribute("myatt", "<\"'&>");
+            testling.endElement();
+
+            CPPUNIT_ASSERT_EQUAL(std::string("<foo myatt=\"&lt;&quot;&apos;&amp;&gt;\"/>"), result);
+        }
+
+        void testWrite_AttributeSetTwice() {
+            std::string result;
+            XMLWriter testling(result);
+            testling.startElement("foo");
+            testling.setAttribute("b", "1");
+            testling.setAttribute("a", "2");
+            testling.setAttribute("b", "3");
+            testling.startElement("bar");
+            testling.setAttribute("c", "4");
+            testling.endElement();
+            testling.endElement();
+
+            CPPUNIT_ASSERT_EQUAL(std::string("<foo a=\"2\" b=\"3\"><bar c=\"4\"/></foo>"), result);
+        }
+
+        void testWrite_RawText() {
+            std::string result;
+            XMLWriter testling(result);
+            testling.startElement("foo");
+            testling.addRawText("<bar/>");
+            testling.addText("<");
+            testling.endElement();
+
+            CPPUNIT_ASSERT_EQUAL(std::string("<foo><bar/>&lt;</foo>"), result);
+        }
+
+        void testWrite_AppendsToOutput() {
+            std::string result("<stream>");
+            XMLWriter testling(result);
+            testling.addTextElement("foo", "");
+
+            CPPUNIT_ASSERT_EQUAL(std::string("<stream><foo></foo>"), result);
+        }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(XMLWriterTest);
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/Serializer/XML/XMLWriter.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace Swift {
+
+XMLWriter::XMLWriter(std::string& output) : output_(output), openElementCount_(0), attributeCount_(0), startTagOpen_(false) {
+}
+
+XMLWriter::~XMLWriter() {
+    assert(openElementCount_ == 0);
+}
+
+void XMLWriter::startElement(const std::string& tag, const std::string& xmlns) {
+    closeStartTag();
+    if (openElementCount_ == openElements_.size()) {
+        openElements_.push_back(tag);
+    }
+    else {
+        openElements_[openElementCount_].assign(tag);
+    }
+    ++openElementCount_;
+    startTagOpen_ = true;
+    if (!xmlns.empty()) {
+        setAttribute("xmlns", xmlns);
+    }
+}
+
+void XMLWriter::setAttribute(const std::string& attribute, const std::string& value) {
+    assert(startTagOpen_);
+    // Like XMLElement, setting an attribute twice keeps the last value
+    for (size_t i = 0; i < attributeCount_; ++i) {
+        if (attributes_[i].first == attribute) {
+            attributes_[i].second.assign(value);
+            return;
+        }
+    }
+    if (attributeCount_ == attributes_.size()) {
+        attributes_.push_back(std::make_pair(attribute, value));
+    }
+    else {
+        attributes_[attributeCount_].first.assign(attribute);
+        attributes_[attributeCount_].second.assign(value);
+    }
+    ++attributeCount_;
+}
+
+void XMLWriter::addText(const std::string& text) {
+    closeStartTag();
+    appendEscapedText(output_, text);
+}
+
+void XMLWriter::addRawText(const std::string& text) {
+    closeStartTag();
+    output_ += text;
+}
+
+void XMLWriter::endElement() {
+    assert(openElementCount_ > 0);
+    if (startTagOpen_) {
+        writeStartTag(true);
+    }
+    else {
+        output_ += "</";
+        output_ += openElements_[openElementCount_ - 1];
+        output_ += '>';
+    }
+    --openElementCount_;
+}
+
+void XMLWriter::addTextElement(const std::string& tag, const std::string& text) {
+    startElement(tag);
+    addText(text);
+    endElement();
+}
+
+void XMLWriter::closeStartTag() {
+    if (startTagOpen_) {
+        writeStartTag(false);
+    }
+}
+
+void XMLWriter::writeStartTag(bool emptyElement) {
+    output_ += '<';
+    output_ += openElements_[openElementCount_ - 1];
+    std::sort(attributes_.begin(), attributes_.begin() + static_cast<std::ptrdiff_t>(attributeCount_));
+    for (size_t i = 0; i < attributeCount_; ++i) {
+        output_ += ' ';
+        output_ += attributes_[i].first;
+        output_ += "=\"";
+        appendEscapedAttributeValue(output_, attributes_[i].second);
+        output_ += '"';
+    }
+    output_ += (emptyElement ? "/>" : ">");
+    attributeCount_ = 0;
+    startTagOpen_ = false;
+}
+
+void XMLWriter::appendEscapedText(std::string& output, const std::string& text) {
+    size_t start = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        const char* replacement;
+        switch (text[i]) {
+            case '&': replacement = "&amp;"; break;
+            case '<': replacement = "&lt;"; break;
+            case '>': replacement = "&gt;"; break;
+            default: continue;
+        }
+        output.append(text, start, i - start);
+        output += replacement;
+        start = i + 1;
+    }
+    output.append(text, start, std::string::npos);
+}
+
+void XMLWriter::appendEscapedAttributeValue(std::string& output, const std::string& value) {
+    size_t start = 0;
+    for (size_t i = 0; i < value.size(); ++i) {
+        const char* replacement;
+        switch (value[i]) {
+            case '&': replacement = "&amp;"; break;
+            case '<': replacement = "&lt;"; break;
+            case '>': replacement = "&gt;"; break;
+            case '\'': replacement = "&apos;"; break;
+            case '"': replacement = "&quot;"; break;
+            default: continue;
+        }
+        output.append(value, start, i - start);
+        output += replacement;
+        start = i + 1;
+    }
+    output.append(value, start, std::string::npos);
+}
+
+}
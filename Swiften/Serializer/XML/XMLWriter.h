@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <Swiften/Base/API.h>
+
+namespace Swift {
+    /**
+     * Serializes XML by appending it directly to an output buffer, without
+     * building a tree of XMLNode objects first.
+     *
+     * Attributes of an element are written in name order, so the output is
+     * the same as the equivalent XMLElement::serialize().
+     */
+    class SWIFTEN_API XMLWriter : public boost::noncopyable {
+        public:
+            XMLWriter(std::string& output);
+            ~XMLWriter();
+
+            void startElement(const std::string& tag, const std::string& xmlns = "");
+
+            /**
+             * Sets an attribute on the most recently started element. This
+             * has to be called before adding any content to the element.
+             */
+            void setAttribute(const std::string& attribute, const std::string& value);
+
+            void addText(const std::string& text);
+
+            /**
+             * Adds XML that is already serialized.
+             */
+            void addRawText(const std::string& text);
+
+            void endElement();
+
+            /**
+             * Adds an element containing only (escaped) text.
+             */
+            void addTextElement(const std::string& tag, const std::string& text);
+
+            static void appendEscapedText(std::string& output, const std::string& text);
+            static void appendEscapedAttributeValue(std::string& output, const std::string& value);
+
+        private:
+            void closeStartTag();
+            void writeStartTag(bool emptyElement);
+
+        private:
+            std::string& output_;
+            std::vector<std::string> openElements_;
+            size_t openElementCount_;
+            std::vector<std::pair<std::string, std::string> > attributes_;
+            size_t attributeCount_;
+            bool startTagOpen_;
+    };
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -63,6 +63,12 @@ XMPPSerializer::XMPPSerializer(PayloadSerializerCollection* payloadSerializers,
     serializers_.push_back(std::make_shared<StanzaAckSerializer>());
     serializers_.push_back(std::make_shared<StanzaAckRequestSerializer>());
     serializers_.push_back(std::make_shared<ComponentHandshakeSerializer>());
+
+    for (const auto& serializer : serializers_) {
+        if (boost::optional<std::type_index> type = serializer->getElementType()) {
+            typeIndex_.insert(std::make_pair(*type, serializer.get()));
+        }
+    }
 }
 
 std::string XMPPSerializer::serializeHeader(const ProtocolHeader& header) const {
@@ -84,6 +90,12 @@ std::string XMPPSerializer::serializeHeader(const ProtocolHeader& header) const
 }
 
 SafeByteArray XMPPSerializer::serializeElement(std::shared_ptr<ToplevelElement> element) const {
+    auto indexed = typeIndex_.find(std::type_index(typeid(*element)));
+    if (indexed != typeIndex_.end()) {
+        return indexed->second->serialize(element);
+    }
+
+    // Fall back to serializers that don't declare a single element type
     std::vector< std::shared_ptr<ElementSerializer> >::const_iterator i = std::find_if(serializers_.begin(), serializers_.end(), boost::bind(&ElementSerializer::canSerialize, _1, element));
     if (i != serializers_.end()) {
         return (*i)->serialize(element);
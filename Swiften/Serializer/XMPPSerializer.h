@@ -8,6 +8,8 @@
 
 #include <memory>
 #include <string>
+#include <typeindex>
+#include <unordered_map>
 #include <vector>
 
 #include <Swiften/Base/API.h>
@@ -33,5 +35,7 @@ namespace Swift {
         private:
             StreamType type_;
             std::vector< std::shared_ptr<ElementSerializer> > serializers_;
+            // Serializers by the exact element type they handle
+            std::unordered_map<std::type_index, ElementSerializer*> typeIndex_;
     };
 }
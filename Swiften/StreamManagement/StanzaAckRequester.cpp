@@ -1,44 +1,131 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swiften/StreamManagement/StanzaAckRequester.h>
 
+#include <boost/bind.hpp>
 #include <boost/numeric/conversion/cast.hpp>
 
 #include <Swiften/Base/Log.h>
 #include <Swiften/Elements/Message.h>
+#include <Swiften/Network/Timer.h>
+#include <Swiften/Network/TimerFactory.h>
 
 namespace Swift {
 
 static const unsigned int MAX_HANDLED_STANZA_COUNT = boost::numeric_cast<unsigned int>((1ULL<<32) - 1);
 
-StanzaAckRequester::StanzaAckRequester() : lastHandledStanzasCount(0) {
+StanzaAckRequester::StanzaAckRequester(TimerFactory* timerFactory) : timerFactory(timerFactory), ackRequestThreshold(0), maxUnackedStanzas(0), lastHandledStanzasCount(0), unackedStanzasCount(0), unrequestedStanzasCount(0), ackRequestTimerStarted(false), droppingStanzas(false) {
 
 }
 
+StanzaAckRequester::~StanzaAckRequester() {
+    if (ackRequestTimer) {
+        ackRequestTimer->stop();
+        ackRequestTimer->onTick.disconnect(boost::bind(&StanzaAckRequester::handleAckRequestTimerTick, this));
+    }
+}
+
+void StanzaAckRequester::setAckRequestThreshold(unsigned int stanzas) {
+    ackRequestThreshold = stanzas;
+}
+
+void StanzaAckRequester::setAckRequestDelay(int milliseconds) {
+    if (ackRequestTimer) {
+        ackRequestTimer->stop();
+        ackRequestTimer->onTick.disconnect(boost::bind(&StanzaAckRequester::handleAckRequestTimerTick, this));
+        ackRequestTimer.reset();
+        ackRequestTimerStarted = false;
+    }
+    if (milliseconds > 0 && timerFactory) {
+        ackRequestTimer = timerFactory->createTimer(milliseconds);
+        ackRequestTimer->onTick.connect(boost::bind(&StanzaAckRequester::handleAckRequestTimerTick, this));
+    }
+}
+
+void StanzaAckRequester::setMaxUnackedStanzas(size_t stanzas) {
+    maxUnackedStanzas = stanzas;
+}
+
 void StanzaAckRequester::handleStanzaSent(std::shared_ptr<Stanza> stanza) {
     unackedStanzas.push_back(stanza);
-    if (std::dynamic_pointer_cast<Message>(stanza)) {
-        onRequestAck();
+    unackedStanzasCount++;
+    if (maxUnackedStanzas > 0 && unackedStanzas.size() > maxUnackedStanzas) {
+        if (!droppingStanzas) {
+            SWIFT_LOG(warning) << "Too many unacked stanzas; dropping the oldest ones from the resend buffer" << std::endl;
+            droppingStanzas = true;
+        }
+        std::shared_ptr<Stanza> droppedStanza = unackedStanzas.front();
+        unackedStanzas.pop_front();
+        onStanzaDropped(droppedStanza);
+    }
+    unrequestedStanzasCount++;
+
+    if (ackRequestThreshold == 0 ? static_cast<bool>(std::dynamic_pointer_cast<Message>(stanza)) : unrequestedStanzasCount >= ackRequestThreshold) {
+        requestAck();
+    }
+    else if (ackRequestTimer && !ackRequestTimerStarted) {
+        ackRequestTimerStarted = true;
+        ackRequestTimer->start();
     }
 }
 
 void StanzaAckRequester::handleAckReceived(unsigned int handledStanzasCount) {
-    unsigned int i = lastHandledStanzasCount;
-    while (i != handledStanzasCount) {
-        if (unackedStanzas.empty()) {
-            SWIFT_LOG(warning) << "Server acked more stanzas than we sent" << std::endl;
-            break;
-        }
+    unsigned int newlyHandledStanzasCount = handledStanzasCount >= lastHandledStanzasCount ?
+            handledStanzasCount - lastHandledStanzasCount :
+            (MAX_HANDLED_STANZA_COUNT - lastHandledStanzasCount) + handledStanzasCount + 1;
+    if (newlyHandledStanzasCount > unackedStanzasCount) {
+        SWIFT_LOG(warning) << "Server acked more stanzas than we sent" << std::endl;
+        newlyHandledStanzasCount = unackedStanzasCount;
+    }
+
+    // Stanzas that were dropped from the resend buffer are the oldest ones,
+    // so they are the first to be acked.
+    size_t droppedStanzasCount = unackedStanzasCount - unackedStanzas.size();
+    unackedStanzasCount -= newlyHandledStanzasCount;
+    for (size_t i = droppedStanzasCount; i < newlyHandledStanzasCount; ++i) {
         std::shared_ptr<Stanza> ackedStanza = unackedStanzas.front();
         unackedStanzas.pop_front();
         onStanzaAcked(ackedStanza);
-        i = (i == MAX_HANDLED_STANZA_COUNT ? 0 : i + 1);
     }
     lastHandledStanzasCount = handledStanzasCount;
+    if (unackedStanzas.size() < maxUnackedStanzas) {
+        droppingStanzas = false;
+    }
+}
+
+std::vector<std::shared_ptr<Stanza> > StanzaAckRequester::handleSessionResumed(unsigned int handledStanzasCount) {
+    handleAckReceived(handledStanzasCount);
+    if (unackedStanzasCount > unackedStanzas.size()) {
+        SWIFT_LOG(warning) << "Not resending " << (unackedStanzasCount - unackedStanzas.size()) << " stanzas that were dropped from the resend buffer" << std::endl;
+    }
+    // Everything that is resent will be counted by the server again
+    unackedStanzasCount = boost::numeric_cast<unsigned int>(unackedStanzas.size());
+    unrequestedStanzasCount = 0;
+    return std::vector<std::shared_ptr<Stanza> >(unackedStanzas.begin(), unackedStanzas.end());
+}
+
+std::vector<std::shared_ptr<Stanza> > StanzaAckRequester::getUnackedStanzas() const {
+    return std::vector<std::shared_ptr<Stanza> >(unackedStanzas.begin(), unackedStanzas.end());
+}
+
+void StanzaAckRequester::requestAck() {
+    unrequestedStanzasCount = 0;
+    if (ackRequestTimerStarted) {
+        ackRequestTimerStarted = false;
+        ackRequestTimer->stop();
+    }
+    onRequestAck();
+}
+
+void StanzaAckRequester::handleAckRequestTimerTick() {
+    ackRequestTimerStarted = false;
+    if (unrequestedStanzasCount > 0) {
+        requestAck();
+    }
 }
 
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,6 +8,7 @@
 
 #include <deque>
 #include <memory>
+#include <vector>
 
 #include <boost/signals2.hpp>
 
@@ -15,21 +16,83 @@
 #include <Swiften/Elements/Stanza.h>
 
 namespace Swift {
+    class Timer;
+    class TimerFactory;
+
+    /**
+     * Keeps track of the stanzas sent on a stream with XEP-0198 stream
+     * management enabled, and decides when to request acks for them.
+     *
+     * By default, an ack is requested after every message. If a request
+     * threshold is set, an ack is requested once that many stanzas were sent
+     * since the last request instead. If a request delay is set (and a timer
+     * factory is available), an ack is also requested when stanzas have been
+     * waiting for that long without a request.
+     *
+     * The stanzas that were not acked yet are kept so that they can be resent
+     * when the session is resumed. When more than the maximum number of unacked
+     * stanzas are pending, the oldest ones are dropped from this buffer, and
+     * onStanzaDropped is emitted for them.
+     */
     class SWIFTEN_API StanzaAckRequester {
         public:
-            StanzaAckRequester();
+            StanzaAckRequester(TimerFactory* timerFactory = nullptr);
+            ~StanzaAckRequester();
+
+            /**
+             * Requests an ack every \p stanzas stanzas, instead of after every
+             * message. Passing 0 restores the default behaviour.
+             */
+            void setAckRequestThreshold(unsigned int stanzas);
+
+            /**
+             * Requests an ack when sent stanzas have been waiting for
+             * \p milliseconds without a request. Passing 0 disables this.
+             */
+            void setAckRequestDelay(int milliseconds);
+
+            /**
+             * Limits the number of unacked stanzas kept for resending.
+             * Passing 0 keeps all of them.
+             */
+            void setMaxUnackedStanzas(size_t stanzas);
 
             void handleStanzaSent(std::shared_ptr<Stanza> stanza);
             void handleAckReceived(unsigned int handledStanzasCount);
 
+            /**
+             * Handles the count of handled stanzas the server sent when the
+             * session was resumed, and returns the stanzas that need to be sent
+             * again.
+             */
+            std::vector<std::shared_ptr<Stanza> > handleSessionResumed(unsigned int handledStanzasCount);
+
+            /**
+             * Returns the stanzas in the resend buffer that were not acked.
+             */
+            std::vector<std::shared_ptr<Stanza> > getUnackedStanzas() const;
+
         public:
             boost::signals2::signal<void ()> onRequestAck;
             boost::signals2::signal<void (std::shared_ptr<Stanza>)> onStanzaAcked;
+            boost::signals2::signal<void (std::shared_ptr<Stanza>)> onStanzaDropped;
+
+        private:
+            void requestAck();
+            void handleAckRequestTimerTick();
 
         private:
             friend class StanzaAckRequesterTest;
+            TimerFactory* timerFactory;
+            unsigned int ackRequestThreshold;
+            size_t maxUnackedStanzas;
             unsigned int lastHandledStanzasCount;
+            unsigned int unackedStanzasCount;
+            unsigned int unrequestedStanzasCount;
             std::deque<std::shared_ptr<Stanza> > unackedStanzas;
+            std::shared_ptr<Timer> ackRequestTimer;
+            bool ackRequestTimerStarted;
+            bool droppingStanzas;
     };
 
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -21,6 +21,10 @@ namespace Swift {
             void handleStanzaReceived();
             void handleAckRequestReceived();
 
+            unsigned int getHandledStanzasCount() const {
+                return handledStanzasCount;
+            }
+
         public:
             boost::signals2::signal<void (unsigned int /* handledStanzaCount */)> onAck;
 
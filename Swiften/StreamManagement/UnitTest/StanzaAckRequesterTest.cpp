@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -13,6 +13,7 @@
 #include <Swiften/Elements/IQ.h>
 #include <Swiften/Elements/Message.h>
 #include <Swiften/Elements/Presence.h>
+#include <Swiften/Network/DummyTimerFactory.h>
 #include <Swiften/StreamManagement/StanzaAckRequester.h>
 
 using namespace Swift;
@@ -29,11 +30,17 @@ class StanzaAckRequesterTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testHandleAckReceived_AcksMultipleStanzas);
         CPPUNIT_TEST(testHandleAckReceived_MultipleAcks);
         CPPUNIT_TEST(testHandleAckReceived_WrapAround);
+        CPPUNIT_TEST(testHandleStanzaSent_ThresholdRequestsAck);
+        CPPUNIT_TEST(testHandleStanzaSent_DelayRequestsAck);
+        CPPUNIT_TEST(testHandleStanzaSent_MaxUnackedStanzas);
+        CPPUNIT_TEST(testHandleStanzaSent_NoMaxUnackedStanzas);
+        CPPUNIT_TEST(testHandleSessionResumed_ReturnsUnackedStanzas);
         CPPUNIT_TEST_SUITE_END();
 
     public:
         void setUp() {
             acksRequested = 0;
+            timerFactory = std::make_shared<DummyTimerFactory>();
         }
 
         void testHandleStanzaSent_MessageRequestsAck() {
@@ -122,6 +129,88 @@ class StanzaAckRequesterTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(std::string("m2"), ackedStanzas[1]->getID());
         }
 
+        void testHandleStanzaSent_ThresholdRequestsAck() {
+            std::shared_ptr<StanzaAckRequester> testling(createRequester());
+            testling->setAckRequestThreshold(3);
+
+            testling->handleStanzaSent(createMessage("m1"));
+            testling->handleStanzaSent(createIQ("iq1"));
+            CPPUNIT_ASSERT_EQUAL(0, acksRequested);
+
+            testling->handleStanzaSent(createPresence("p1"));
+            CPPUNIT_ASSERT_EQUAL(1, acksRequested);
+
+            testling->handleStanzaSent(createMessage("m2"));
+            CPPUNIT_ASSERT_EQUAL(1, acksRequested);
+        }
+
+        void testHandleStanzaSent_DelayRequestsAck() {
+            std::shared_ptr<StanzaAckRequester> testling(createRequester());
+            testling->setAckRequestThreshold(10);
+            testling->setAckRequestDelay(100);
+
+            testling->handleStanzaSent(createPresence("p1"));
+            timerFactory->setTime(50);
+            testling->handleStanzaSent(createPresence("p2"));
+            CPPUNIT_ASSERT_EQUAL(0, acksRequested);
+
+            timerFactory->setTime(100);
+            CPPUNIT_ASSERT_EQUAL(1, acksRequested);
+
+            timerFactory->setTime(300);
+            CPPUNIT_ASSERT_EQUAL(1, acksRequested);
+        }
+
+        void testHandleStanzaSent_MaxUnackedStanzas() {
+            std::shared_ptr<StanzaAckRequester> testling(createRequester());
+            testling->setMaxUnackedStanzas(2);
+            testling->handleStanzaSent(createMessage("m1"));
+            testling->handleStanzaSent(createMessage("m2"));
+            testling->handleStanzaSent(createMessage("m3"));
+
+            CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(testling->unackedStanzas.size()));
+            CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(droppedStanzas.size()));
+            CPPUNIT_ASSERT_EQUAL(std::string("m1"), droppedStanzas[0]->getID());
+
+            testling->handleAckReceived(2);
+
+            CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(ackedStanzas.size()));
+            CPPUNIT_ASSERT_EQUAL(std::string("m2"), ackedStanzas[0]->getID());
+
+            testling->handleAckReceived(3);
+
+            CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(ackedStanzas.size()));
+            CPPUNIT_ASSERT_EQUAL(std::string("m3"), ackedStanzas[1]->getID());
+        }
+
+        void testHandleStanzaSent_NoMaxUnackedStanzas() {
+            std::shared_ptr<StanzaAckRequester> testling(createRequester());
+            testling->handleStanzaSent(createMessage("m1"));
+            testling->handleStanzaSent(createMessage("m2"));
+            testling->handleStanzaSent(createMessage("m3"));
+
+            CPPUNIT_ASSERT_EQUAL(3, static_cast<int>(testling->getUnackedStanzas().size()));
+            CPPUNIT_ASSERT(droppedStanzas.empty());
+        }
+
+        void testHandleSessionResumed_ReturnsUnackedStanzas() {
+            std::shared_ptr<StanzaAckRequester> testling(createRequester());
+            testling->handleStanzaSent(createMessage("m1"));
+            testling->handleStanzaSent(createMessage("m2"));
+            testling->handleStanzaSent(createMessage("m3"));
+
+            std::vector<std::shared_ptr<Stanza> > unackedStanzas = testling->handleSessionResumed(1);
+
+            CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(ackedStanzas.size()));
+            CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(unackedStanzas.size()));
+            CPPUNIT_ASSERT_EQUAL(std::string("m2"), unackedStanzas[0]->getID());
+            CPPUNIT_ASSERT_EQUAL(std::string("m3"), unackedStanzas[1]->getID());
+
+            testling->handleAckReceived(3);
+
+            CPPUNIT_ASSERT_EQUAL(3, static_cast<int>(ackedStanzas.size()));
+        }
+
     private:
         Message::ref createMessage(const std::string& id) {
             Message::ref result(new Message());
@@ -142,9 +231,10 @@ class StanzaAckRequesterTest : public CppUnit::TestFixture {
         }
 
         StanzaAckRequester* createRequester() {
-            StanzaAckRequester* requester = new StanzaAckRequester();
+            StanzaAckRequester* requester = new StanzaAckRequester(timerFactory.get());
             requester->onRequestAck.connect(boost::bind(&StanzaAckRequesterTest::handleRequestAck, this));
             requester->onStanzaAcked.connect(boost::bind(&StanzaAckRequesterTest::handleStanzaAcked, this, _1));
+            requester->onStanzaDropped.connect(boost::bind(&StanzaAckRequesterTest::handleStanzaDropped, this, _1));
             return requester;
         }
 
@@ -156,9 +246,15 @@ class StanzaAckRequesterTest : public CppUnit::TestFixture {
             ackedStanzas.push_back(stanza);
         }
 
+        void handleStanzaDropped(std::shared_ptr<Stanza> stanza) {
+            droppedStanzas.push_back(stanza);
+        }
+
     private:
         int acksRequested = 0;
+        std::shared_ptr<DummyTimerFactory> timerFactory;
         std::vector< std::shared_ptr<Stanza> > ackedStanzas;
+        std::vector< std::shared_ptr<Stanza> > droppedStanzas;
 };
 
 }
@@ -19,10 +19,12 @@
 #include <Security/Security.h>
 #endif
 
+#include <Swiften/Base/Log.h>
 #include <Swiften/TLS/OpenSSL/OpenSSLContext.h>
 #include <Swiften/TLS/OpenSSL/OpenSSLCertificate.h>
 #include <Swiften/TLS/CertificateWithKey.h>
 #include <Swiften/TLS/PKCS12Certificate.h>
+#include <Swiften/TLS/TLSSessionCache.h>
 
 #pragma GCC diagnostic ignored "-Wold-style-cast"
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
@@ -39,11 +41,18 @@ static void freeX509Stack(STACK_OF(X509)* stack) {
     sk_X509_free(stack);
 }
 
-OpenSSLContext::OpenSSLContext() : state_(Start), context_(0), handle_(0), readBIO_(0), writeBIO_(0) {
+OpenSSLContext::OpenSSLContext(const TLSOptions& tlsOptions, std::shared_ptr<TLSSessionCache> sessionCache) : state_(Start), context_(0), handle_(0), readBIO_(0), writeBIO_(0), sessionCache_(sessionCache), sessionCacheKey_(tlsOptions.sessionCacheKey) {
     ensureLibraryInitialized();
     context_ = SSL_CTX_new(SSLv23_client_method());
     SSL_CTX_set_options(context_, SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3);
 
+    // Get notified of new sessions (including the ones from session tickets,
+    // which TLS 1.3 servers only send after the handshake) to cache them.
+    if (isSessionCacheEnabled()) {
+        SSL_CTX_set_session_cache_mode(context_, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        SSL_CTX_sess_set_new_cb(context_, &OpenSSLContext::handleNewSession);
+    }
+
     // TODO: implement CRL checking
     // TODO: download CRL (HTTP transport)
     // TODO: cache CRL downloads for configurable time period
@@ -132,6 +141,11 @@ void OpenSSLContext::connect() {
     writeBIO_ = BIO_new(BIO_s_mem());
     SSL_set_bio(handle_, readBIO_, writeBIO_);
 
+    if (isSessionCacheEnabled()) {
+        SSL_set_app_data(handle_, this);
+        resumeCachedSession();
+    }
+
     state_ = Connecting;
     doConnect();
 }
@@ -142,6 +156,9 @@ void OpenSSLContext::doConnect() {
     switch (error) {
         case SSL_ERROR_NONE: {
             state_ = Connected;
+            if (isSessionCacheEnabled()) {
+                SWIFT_LOG(debug) << "TLS session " << (SSL_session_reused(handle_) ? "resumed" : "not resumed") << " for " << sessionCacheKey_ << std::endl;
+            }
             //std::cout << x->name << std::endl;
             //const char* comp = SSL_get_current_compression(handle_);
             //std::cout << "Compression: " << SSL_COMP_get_name(comp) << std::endl;
@@ -153,10 +170,57 @@ void OpenSSLContext::doConnect() {
             break;
         default:
             state_ = Error;
+            if (isSessionCacheEnabled()) {
+                // Don't try to resume this session again
+                sessionCache_->removeSession(sessionCacheKey_);
+            }
             onError(std::make_shared<TLSError>());
     }
 }
 
+bool OpenSSLContext::isSessionCacheEnabled() const {
+    return sessionCache_ && !sessionCacheKey_.empty();
+}
+
+void OpenSSLContext::resumeCachedSession() {
+    boost::optional<SafeByteArray> sessionData = sessionCache_->getSession(sessionCacheKey_);
+    if (!sessionData || sessionData->empty()) {
+        return;
+    }
+    const unsigned char* data = vecptr(*sessionData);
+    SSL_SESSION* session = d2i_SSL_SESSION(nullptr, &data, sessionData->size());
+    if (!session) {
+        sessionCache_->removeSession(sessionCacheKey_);
+        return;
+    }
+    if (SSL_set_session(handle_, session) != 1) {
+        sessionCache_->removeSession(sessionCacheKey_);
+    }
+    SSL_SESSION_free(session);
+}
+
+void OpenSSLContext::storeSession(SSL_SESSION* session) {
+    int size = i2d_SSL_SESSION(session, nullptr);
+    if (size <= 0) {
+        return;
+    }
+    SafeByteArray sessionData;
+    sessionData.resize(size);
+    unsigned char* data = vecptr(sessionData);
+    if (i2d_SSL_SESSION(session, &data) == size) {
+        sessionCache_->storeSession(sessionCacheKey_, sessionData);
+    }
+}
+
+int OpenSSLContext::handleNewSession(SSL* ssl, SSL_SESSION* session) {
+    OpenSSLContext* context = static_cast<OpenSSLContext*>(SSL_get_app_data(ssl));
+    if (context) {
+        context->storeSession(session);
+    }
+    // We don't keep a reference to the session
+    return 0;
+}
+
 void OpenSSLContext::sendPendingDataToNetwork() {
     int size = BIO_pending(writeBIO_);
     if (size > 0) {
@@ -258,6 +322,13 @@ std::vector<Certificate::ref> OpenSSLContext::getPeerCertificateChain() const {
         Certificate::ref cert = std::make_shared<OpenSSLCertificate>(x509Cert);
         result.push_back(cert);
     }
+    if (result.empty()) {
+        // Sessions resumed from the session cache only have the peer
+        // certificate, not the rest of the chain
+        if (X509* peerCert = SSL_get_peer_certificate(handle_)) {
+            result.push_back(std::make_shared<OpenSSLCertificate>(std::shared_ptr<X509>(peerCert, X509_free)));
+        }
+    }
     return result;
 }
 
@@ -6,6 +6,9 @@
 
 #pragma once
 
+#include <memory>
+#include <string>
+
 #include <boost/noncopyable.hpp>
 #include <boost/signals2.hpp>
 
@@ -14,12 +17,14 @@
 #include <Swiften/Base/ByteArray.h>
 #include <Swiften/TLS/CertificateWithKey.h>
 #include <Swiften/TLS/TLSContext.h>
+#include <Swiften/TLS/TLSOptions.h>
 
 namespace Swift {
+    class TLSSessionCache;
 
     class OpenSSLContext : public TLSContext, boost::noncopyable {
         public:
-            OpenSSLContext();
+            OpenSSLContext(const TLSOptions& tlsOptions = TLSOptions(), std::shared_ptr<TLSSessionCache> sessionCache = std::shared_ptr<TLSSessionCache>());
             virtual ~OpenSSLContext();
 
             void connect();
@@ -37,6 +42,11 @@ namespace Swift {
             static void ensureLibraryInitialized();
 
             static CertificateVerificationError::Type getVerificationErrorTypeForResult(int);
+            static int handleNewSession(SSL*, SSL_SESSION*);
+
+            bool isSessionCacheEnabled() const;
+            void resumeCachedSession();
+            void storeSession(SSL_SESSION*);
 
             void doConnect();
             void sendPendingDataToNetwork();
@@ -50,5 +60,7 @@ namespace Swift {
             SSL* handle_;
             BIO* readBIO_;
             BIO* writeBIO_;
+            std::shared_ptr<TLSSessionCache> sessionCache_;
+            std::string sessionCacheKey_;
     };
 }
@@ -15,8 +15,12 @@ bool OpenSSLContextFactory::canCreate() const {
     return true;
 }
 
-TLSContext* OpenSSLContextFactory::createTLSContext(const TLSOptions&) {
-    return new OpenSSLContext();
+TLSContext* OpenSSLContextFactory::createTLSContext(const TLSOptions& tlsOptions) {
+    return new OpenSSLContext(tlsOptions, sessionCache_);
+}
+
+void OpenSSLContextFactory::setSessionCache(std::shared_ptr<TLSSessionCache> sessionCache) {
+    sessionCache_ = sessionCache;
 }
 
 void OpenSSLContextFactory::setCheckCertificateRevocation(bool check) {
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <cassert>
+#include <memory>
 
 #include <Swiften/TLS/TLSContextFactory.h>
 
@@ -19,5 +20,10 @@ namespace Swift {
             // Not supported
             virtual void setCheckCertificateRevocation(bool b);
             virtual void setDisconnectOnCardRemoval(bool b);
+
+            virtual void setSessionCache(std::shared_ptr<TLSSessionCache> sessionCache);
+
+        private:
+            std::shared_ptr<TLSSessionCache> sessionCache_;
     };
 }
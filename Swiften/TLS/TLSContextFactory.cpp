@@ -6,9 +6,14 @@
 
 #include <Swiften/TLS/TLSContextFactory.h>
 
+#include <Swiften/TLS/TLSSessionCache.h>
+
 namespace Swift {
 
 TLSContextFactory::~TLSContextFactory() {
 }
 
+void TLSContextFactory::setSessionCache(std::shared_ptr<TLSSessionCache>) {
+}
+
 }
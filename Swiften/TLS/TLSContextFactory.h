@@ -6,11 +6,14 @@
 
 #pragma once
 
+#include <memory>
+
 #include <Swiften/Base/API.h>
 #include <Swiften/TLS/TLSOptions.h>
 
 namespace Swift {
     class TLSContext;
+    class TLSSessionCache;
 
     class SWIFTEN_API TLSContextFactory {
         public:
@@ -21,5 +24,12 @@ namespace Swift {
             virtual TLSContext* createTLSContext(const TLSOptions& tlsOptions) = 0;
             virtual void setCheckCertificateRevocation(bool b) = 0;
             virtual void setDisconnectOnCardRemoval(bool b) = 0;
+
+            /**
+             * Sets the cache to store established TLS sessions in, and to
+             * resume sessions from. Backends that don't support session
+             * resumption ignore the cache.
+             */
+            virtual void setSessionCache(std::shared_ptr<TLSSessionCache> sessionCache);
     };
 }
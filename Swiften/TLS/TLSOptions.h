@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <string>
+
 namespace Swift {
 
     struct TLSOptions {
@@ -21,5 +23,13 @@ namespace Swift {
          */
         bool schannelTLS1_0Workaround;
 
+        /**
+         * Identifies the server the connection is made to, and the account
+         * it is made for, for looking up TLS sessions to resume in the
+         * session cache of the TLSContextFactory. Sessions are neither
+         * cached nor resumed when this is empty.
+         */
+        std::string sessionCacheKey;
+
     };
 }
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/TLS/TLSSessionCache.h>
+
+namespace Swift {
+
+TLSSessionCache::TLSSessionCache(size_t maxSessions) : maxSessions_(maxSessions) {
+}
+
+TLSSessionCache::~TLSSessionCache() {
+}
+
+void TLSSessionCache::storeSession(const std::string& key, const SafeByteArray& session) {
+    auto i = sessionsByKey_.find(key);
+    if (i != sessionsByKey_.end()) {
+        i->second->second = session;
+        sessions_.splice(sessions_.begin(), sessions_, i->second);
+        return;
+    }
+    sessions_.push_front(std::make_pair(key, session));
+    sessionsByKey_[key] = sessions_.begin();
+    while (sessions_.size() > maxSessions_) {
+        sessionsByKey_.erase(sessions_.back().first);
+        sessions_.pop_back();
+    }
+}
+
+boost::optional<SafeByteArray> TLSSessionCache::getSession(const std::string& key) {
+    auto i = sessionsByKey_.find(key);
+    if (i == sessionsByKey_.end()) {
+        return boost::optional<SafeByteArray>();
+    }
+    sessions_.splice(sessions_.begin(), sessions_, i->second);
+    return i->second->second;
+}
+
+void TLSSessionCache::removeSession(const std::string& key) {
+    auto i = sessionsByKey_.find(key);
+    if (i != sessionsByKey_.end()) {
+        sessions_.erase(i->second);
+        sessionsByKey_.erase(i);
+    }
+}
+
+}
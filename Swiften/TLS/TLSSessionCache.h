@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <boost/optional.hpp>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/Base/SafeByteArray.h>
+
+namespace Swift {
+    /**
+     * A bounded cache of serialized TLS sessions, keyed by server identity
+     * (see TLSOptions::sessionCacheKey).
+     *
+     * When set on a TLSContextFactory, new connections to a server try to
+     * resume the last session established with it, using either its session
+     * ID or its session ticket. This avoids a full handshake when
+     * reconnecting.
+     *
+     * The cached sessions only live in memory. To persist them, subclass
+     * this cache and override storeSession() and removeSession(), and
+     * restore the stored sessions with storeSession() on startup.
+     */
+    class SWIFTEN_API TLSSessionCache {
+        public:
+            TLSSessionCache(size_t maxSessions = 64);
+            virtual ~TLSSessionCache();
+
+            virtual void storeSession(const std::string& key, const SafeByteArray& session);
+            virtual boost::optional<SafeByteArray> getSession(const std::string& key);
+            virtual void removeSession(const std::string& key);
+
+            size_t getSize() const {
+                return sessions_.size();
+            }
+
+        private:
+            typedef std::list<std::pair<std::string, SafeByteArray> > SessionList;
+
+            size_t maxSessions_;
+            // Most recently used sessions first
+            SessionList sessions_;
+            std::unordered_map<std::string, SessionList::iterator> sessionsByKey_;
+    };
+}
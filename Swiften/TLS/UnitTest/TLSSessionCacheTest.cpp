@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/TLS/TLSSessionCache.h>
+
+using namespace Swift;
+
+class TLSSessionCacheTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(TLSSessionCacheTest);
+        CPPUNIT_TEST(testGetSession);
+        CPPUNIT_TEST(testGetSession_Unknown);
+        CPPUNIT_TEST(testStoreSession_ReplacesSession);
+        CPPUNIT_TEST(testStoreSession_EvictsLeastRecentlyUsed);
+        CPPUNIT_TEST(testRemoveSession);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void testGetSession() {
+            TLSSessionCache testling;
+            testling.storeSession("example.com", createSafeByteArray("session1"));
+
+            boost::optional<SafeByteArray> session = testling.getSession("example.com");
+            CPPUNIT_ASSERT(session);
+            CPPUNIT_ASSERT(createSafeByteArray("session1") == *session);
+        }
+
+        void testGetSession_Unknown() {
+            TLSSessionCache testling;
+            testling.storeSession("example.com", createSafeByteArray("session1"));
+
+            CPPUNIT_ASSERT(!testling.getSession("example.org"));
+        }
+
+        void testStoreSession_ReplacesSession() {
+            TLSSessionCache testling;
+            testling.storeSession("example.com", createSafeByteArray("session1"));
+            testling.storeSession("example.com", createSafeByteArray("session2"));
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), testling.getSize());
+            CPPUNIT_ASSERT(createSafeByteArray("session2") == *testling.getSession("example.com"));
+        }
+
+        void testStoreSession_EvictsLeastRecentlyUsed() {
+            TLSSessionCache testling(2);
+            testling.storeSession("a.example.com", createSafeByteArray("session1"));
+            testling.storeSession("b.example.com", createSafeByteArray("session2"));
+            testling.getSession("a.example.com");
+            testling.storeSession("c.example.com", createSafeByteArray("session3"));
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), testling.getSize());
+            CPPUNIT_ASSERT(testling.getSession("a.example.com"));
+            CPPUNIT_ASSERT(!testling.getSession("b.example.com"));
+            CPPUNIT_ASSERT(testling.getSession("c.example.com"));
+        }
+
+        void testRemoveSession() {
+            TLSSessionCache testling;
+            testling.storeSession("example.com", createSafeByteArray("session1"));
+            testling.removeSession("example.com");
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), testling.getSize());
+            CPPUNIT_ASSERT(!testling.getSession("example.com"));
+        }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TLSSessionCacheTest);